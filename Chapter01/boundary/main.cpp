@@ -7,6 +7,12 @@
 #include <benchmark/benchmark.h>
 #include <x86intrin.h>
 #include <omp.h>
+#include <map>
+#include <tuple>
+#include "aligned_buffer.h"
+#include "parallel_bench.h"
+#include "simd_math.h"
+#include "stream_kernels.h"
 
 /**
  * @file main.cpp
@@ -17,6 +23,10 @@
  * 2. OpenMP 并行填充数组
  * 3. 串行计算 sin(i)
  * 4. OpenMP 并行计算 sin(i)
+ * 5. 非临时存储 / rep stosb / memset 填充，以及对应的拷贝内核
+ * 6. SIMD 多项式 sin/cos（三档精度）与 std::sin 对比，并报告最大 ULP 误差
+ * 7. 填充 / 非临时填充 / 拷贝 / 非临时拷贝 / sin / SIMD sin 在不同并行后端
+ *    （OpenMP / TBB / par_unseq / 工作窃取线程池）与不同规模下的耗时
  */
 constexpr size_t n = 1<<26;
 
@@ -25,8 +35,25 @@ constexpr size_t n = 1<<26;
  *
  * 元素个数为 n，每个元素为 float（4 字节），总占用约 256 MB。
  * 采用全局变量可以避免在每次基准迭代中重复分配内存，减少额外干扰。
+ * 使用 membuf::Buffer：64B 对齐、不做值初始化，按 OpenMP 静态调度并行首次触碰。
  */
-std::vector<float> a(n);  // 256MB
+membuf::Buffer<float> a(n);  // 256MB
+
+/**
+ * @brief 拷贝基准的源缓冲区，与 a 同样大小，元素均为 2。
+ */
+membuf::Buffer<float> b = [] {
+    membuf::Buffer<float> v(n, {membuf::Pages::kDefault, membuf::FirstTouch::kNone});
+    v.Fill(2);
+    return v;
+}();  // 256MB
+
+constexpr size_t bytes = n * sizeof(float);
+
+/**
+ * @brief 并行内核的分块大小（元素数），每块 256KB，交给各线程独立调用内核。
+ */
+constexpr size_t chunk = 1 << 16;
 
 /**
  * @brief 串行写入基准：逐元素将数组写为 1。
@@ -40,6 +67,7 @@ void BM_fill(benchmark::State &bm) {
             a[i] = 1;
         }
     }
+    bm.SetBytesProcessed(bm.iterations() * bytes);
 }
 BENCHMARK(BM_fill);
 
@@ -56,9 +84,141 @@ void BM_parallel_fill(benchmark::State &bm) {
             a[i] = 1;
         }
     }
+    bm.SetBytesProcessed(bm.iterations() * bytes);
 }
 BENCHMARK(BM_parallel_fill);
 
+/**
+ * @brief 非临时存储填充基准，参数为指令集（1=SSE2, 2=AVX2, 3=AVX-512）。
+ * @param bm Google Benchmark 传入的状态对象。
+ *
+ * 普通写入每条缓存行都要先读入（RFO），写带宽里约一半被读流量占掉；
+ * 流式存储绕过缓存直接写内存，与 BM_fill 对比可看出这部分开销。
+ */
+void BM_stream_fill(benchmark::State &bm) {
+    auto isa = static_cast<stream_kernels::Isa>(bm.range(0));
+    if (!stream_kernels::IsaSupported(isa)) {
+        bm.SkipWithError("ISA not supported on this CPU");
+        return;
+    }
+    for (auto _: bm) {
+        stream_kernels::StreamFill(isa, a.data(), n, 1.0f);
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * bytes);
+    bm.SetLabel(stream_kernels::IsaName(isa));
+}
+BENCHMARK(BM_stream_fill)->DenseRange(1, 3);
+
+/**
+ * @brief 并行非临时存储填充基准，按 CPUID 自动选择指令集。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_parallel_stream_fill(benchmark::State &bm) {
+    for (auto _: bm) {
+#pragma omp parallel for
+        for (size_t i = 0; i < n; i += chunk) {
+            stream_kernels::StreamFill(a.data() + i, chunk, 1.0f);
+        }
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * bytes);
+    bm.SetLabel(stream_kernels::IsaName(stream_kernels::DetectIsa()));
+}
+BENCHMARK(BM_parallel_stream_fill);
+
+/**
+ * @brief memset 清零基准，作为库函数的参照（glibc 对大块会自行切换到非临时存储）。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_memset_fill(benchmark::State &bm) {
+    for (auto _: bm) {
+        std::memset(a.data(), 0, bytes);
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * bytes);
+}
+BENCHMARK(BM_memset_fill);
+
+/**
+ * @brief rep stosb 清零基准。
+ * @param bm Google Benchmark 传入的状态对象。
+ *
+ * 在支持 ERMS 的 CPU 上，微码会按整条缓存行写入，标签中注明是否支持 ERMS。
+ */
+void BM_rep_stosb_fill(benchmark::State &bm) {
+    for (auto _: bm) {
+        stream_kernels::RepStosb(a.data(), 0, bytes);
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * bytes);
+    bm.SetLabel(stream_kernels::HasErms() ? "erms" : "no erms");
+}
+BENCHMARK(BM_rep_stosb_fill);
+
+/**
+ * @brief 普通拷贝基准：逐元素 a[i] = b[i]。
+ * @param bm Google Benchmark 传入的状态对象。
+ *
+ * 拷贝类基准的字节数按写入量计，读流量不计入。
+ */
+void BM_copy(benchmark::State &bm) {
+    for (auto _: bm) {
+        for (size_t i = 0; i < n; i++) {
+            a[i] = b[i];
+        }
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * bytes);
+}
+BENCHMARK(BM_copy);
+
+/**
+ * @brief 非临时存储拷贝基准，参数含义同 BM_stream_fill。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_stream_copy(benchmark::State &bm) {
+    auto isa = static_cast<stream_kernels::Isa>(bm.range(0));
+    if (!stream_kernels::IsaSupported(isa)) {
+        bm.SkipWithError("ISA not supported on this CPU");
+        return;
+    }
+    for (auto _: bm) {
+        stream_kernels::StreamCopy(isa, a.data(), b.data(), n);
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * bytes);
+    bm.SetLabel(stream_kernels::IsaName(isa));
+}
+BENCHMARK(BM_stream_copy)->DenseRange(1, 3);
+
+/**
+ * @brief memcpy 拷贝基准。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_memcpy_copy(benchmark::State &bm) {
+    for (auto _: bm) {
+        std::memcpy(a.data(), b.data(), bytes);
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * bytes);
+}
+BENCHMARK(BM_memcpy_copy);
+
+/**
+ * @brief rep movsb 拷贝基准。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_rep_movsb_copy(benchmark::State &bm) {
+    for (auto _: bm) {
+        stream_kernels::RepMovsb(a.data(), b.data(), bytes);
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * bytes);
+    bm.SetLabel(stream_kernels::HasErms() ? "erms" : "no erms");
+}
+BENCHMARK(BM_rep_movsb_copy);
+
 /**
  * @brief 串行计算基准：逐元素执行 a[i] = sin(i)。
  * @param bm Google Benchmark 传入的状态对象。
@@ -90,6 +250,264 @@ void BM_parallel_sine(benchmark::State &bm) {
 }
 BENCHMARK(BM_parallel_sine);
 
+/**
+ * @brief SIMD sin/cos 基准的输入：x[i] = i，与 BM_sine 的取值范围一致。
+ */
+const membuf::Buffer<float> &sine_input() {
+    static const membuf::Buffer<float> x = [] {
+        membuf::Buffer<float> v(n, {membuf::Pages::kDefault, membuf::FirstTouch::kNone});
+#pragma omp parallel for
+        for (size_t i = 0; i < n; i++) {
+            v[i] = static_cast<float>(i);
+        }
+        return v;
+    }();
+    return x;
+}
+
+/**
+ * @brief 误差扫描输入：基准输入之外，再按位模式均匀抽取 [-kMaxArg, kMaxArg] 内的 float，
+ * 覆盖 [0, 1) 的小数与负数。
+ */
+const std::vector<float> &sine_sweep_input() {
+    static const std::vector<float> x = [] {
+        constexpr uint32_t samples = 1 << 22;
+        uint32_t max_bits;
+        std::memcpy(&max_bits, &simd_math::kMaxArg, sizeof(max_bits));
+        std::vector<float> v;
+        v.reserve(2 * samples);
+        for (uint32_t i = 0; i < samples; i++) {
+            uint32_t bits = static_cast<uint32_t>(uint64_t(max_bits) * i / samples);
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            v.push_back(f);
+            v.push_back(-f);
+        }
+        return v;
+    }();
+    return x;
+}
+
+/**
+ * @brief 计算并缓存某个内核在全部输入上的误差（Google Benchmark 会多次调用同一基准函数）。
+ */
+const simd_math::ErrorReport &sine_error(stream_kernels::Isa isa, simd_math::Accuracy acc,
+                                         bool is_cos) {
+    static std::map<std::tuple<int, int, bool>, simd_math::ErrorReport> cache;
+    auto key = std::make_tuple(static_cast<int>(isa), static_cast<int>(acc), is_cos);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        simd_math::ErrorReport rep;
+        simd_math::AccumulateError(isa, acc, is_cos, sine_input().data(), n, &rep);
+        const auto &sweep = sine_sweep_input();
+        simd_math::AccumulateError(isa, acc, is_cos, sweep.data(), sweep.size(), &rep);
+        it = cache.emplace(key, rep).first;
+    }
+    return it->second;
+}
+
+/**
+ * @brief 标准库基准：对同一份 float 输入逐元素调用 std::sin。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_std_sin(benchmark::State &bm) {
+    const float *x = sine_input().data();
+    for (auto _: bm) {
+        for (size_t i = 0; i < n; i++) {
+            a[i] = std::sin(x[i]);
+        }
+        benchmark::DoNotOptimize(a.data());
+    }
+    bm.SetItemsProcessed(bm.iterations() * n);
+}
+BENCHMARK(BM_std_sin);
+
+/**
+ * @brief SIMD sin/cos 公共流程：参数为 (指令集, 精度档)，计数器给出全输入范围的最大误差。
+ * @param bm Google Benchmark 传入的状态对象。
+ * @param is_cos true 测 cos，false 测 sin。
+ */
+void run_simd_sincos(benchmark::State &bm, bool is_cos) {
+    auto isa = static_cast<stream_kernels::Isa>(bm.range(0));
+    auto acc = static_cast<simd_math::Accuracy>(bm.range(1));
+    if (simd_math::SelectIsa(isa) != isa) {
+        bm.SkipWithError("ISA not supported on this CPU");
+        return;
+    }
+    const simd_math::ErrorReport &err = sine_error(isa, acc, is_cos);
+    const float *x = sine_input().data();
+    for (auto _: bm) {
+        simd_math::SinCos(isa, acc, x, is_cos ? nullptr : a.data(), is_cos ? a.data() : nullptr, n);
+        benchmark::DoNotOptimize(a.data());
+    }
+    bm.SetItemsProcessed(bm.iterations() * n);
+    bm.counters["max_ulp"] = err.max_ulp;
+    bm.counters["max_abs"] = err.max_abs;
+    bm.SetLabel(std::string(stream_kernels::IsaName(isa)) + " " + simd_math::AccuracyName(acc));
+}
+
+/**
+ * @brief SIMD sin 基准。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_simd_sin(benchmark::State &bm) {
+    run_simd_sincos(bm, false);
+}
+BENCHMARK(BM_simd_sin)->ArgsProduct({{2, 3}, {0, 1, 2}})->ArgNames({"isa", "acc"});
+
+/**
+ * @brief SIMD cos 基准。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_simd_cos(benchmark::State &bm) {
+    run_simd_sincos(bm, true);
+}
+BENCHMARK(BM_simd_cos)->ArgsProduct({{2, 3}, {0, 1, 2}})->ArgNames({"isa", "acc"});
+
+/**
+ * @brief 并行 SIMD sin 基准：OpenMP 分块后各线程调用自动分派的内核，参数为精度档。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_parallel_simd_sin(benchmark::State &bm) {
+    auto acc = static_cast<simd_math::Accuracy>(bm.range(0));
+    const float *x = sine_input().data();
+    for (auto _: bm) {
+#pragma omp parallel for
+        for (size_t i = 0; i < n; i += chunk) {
+            simd_math::Sin(x + i, a.data() + i, chunk, acc);
+        }
+        benchmark::DoNotOptimize(a.data());
+    }
+    bm.SetItemsProcessed(bm.iterations() * n);
+    bm.SetLabel(simd_math::AccuracyName(acc));
+}
+BENCHMARK(BM_parallel_simd_sin)->DenseRange(0, 2);
+
+/**
+ * @brief 并行后端对比：写入 a 的前 m 个元素，参数为 (后端, 元素个数)。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_backend_fill(benchmark::State &bm) {
+    const auto backend = static_cast<par::Backend>(bm.range(0));
+    const size_t m = static_cast<size_t>(bm.range(1));
+    float *p = a.data();
+    for (auto _: bm) {
+        par::ParallelFor(backend, m, [p](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                p[i] = 1;
+            }
+        });
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * m * sizeof(float));
+    bm.SetLabel(par::BackendName(backend));
+}
+BENCHMARK(BM_backend_fill)->Apply(par::BackendSizeArgs)->UseRealTime();
+
+/**
+ * @brief 并行后端对比：非临时存储填充 a 的前 m 个元素，每个区间调用一次自动分派的 StreamFill。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_backend_stream_fill(benchmark::State &bm) {
+    const auto backend = static_cast<par::Backend>(bm.range(0));
+    const size_t m = static_cast<size_t>(bm.range(1));
+    float *p = a.data();
+    for (auto _: bm) {
+        par::ParallelFor(backend, m, [p](size_t begin, size_t end) {
+            stream_kernels::StreamFill(p + begin, end - begin, 1.0f);
+        });
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * m * sizeof(float));
+    bm.SetLabel(par::BackendName(backend));
+}
+BENCHMARK(BM_backend_stream_fill)->Apply(par::BackendSizeArgs)->UseRealTime();
+
+/**
+ * @brief 并行后端对比：逐元素拷贝 a[i] = b[i]，字节数按写入量计，参数同 BM_backend_fill。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_backend_copy(benchmark::State &bm) {
+    const auto backend = static_cast<par::Backend>(bm.range(0));
+    const size_t m = static_cast<size_t>(bm.range(1));
+    float *p = a.data();
+    const float *q = b.data();
+    for (auto _: bm) {
+        par::ParallelFor(backend, m, [p, q](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                p[i] = q[i];
+            }
+        });
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * m * sizeof(float));
+    bm.SetLabel(par::BackendName(backend));
+}
+BENCHMARK(BM_backend_copy)->Apply(par::BackendSizeArgs)->UseRealTime();
+
+/**
+ * @brief 并行后端对比：非临时存储拷贝，每个区间调用一次自动分派的 StreamCopy，参数同 BM_backend_fill。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_backend_stream_copy(benchmark::State &bm) {
+    const auto backend = static_cast<par::Backend>(bm.range(0));
+    const size_t m = static_cast<size_t>(bm.range(1));
+    float *p = a.data();
+    const float *q = b.data();
+    for (auto _: bm) {
+        par::ParallelFor(backend, m, [p, q](size_t begin, size_t end) {
+            stream_kernels::StreamCopy(p + begin, q + begin, end - begin);
+        });
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * m * sizeof(float));
+    bm.SetLabel(par::BackendName(backend));
+}
+BENCHMARK(BM_backend_stream_copy)->Apply(par::BackendSizeArgs)->UseRealTime();
+
+/**
+ * @brief 并行后端对比：a[i] = sin(i)，参数同 BM_backend_fill。
+ * @param bm Google Benchmark 传入的状态对象。
+ */
+void BM_backend_sine(benchmark::State &bm) {
+    const auto backend = static_cast<par::Backend>(bm.range(0));
+    const size_t m = static_cast<size_t>(bm.range(1));
+    float *p = a.data();
+    for (auto _: bm) {
+        par::ParallelFor(backend, m, [p](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                p[i] = std::sin(i);
+            }
+        });
+        benchmark::ClobberMemory();
+    }
+    bm.SetItemsProcessed(bm.iterations() * m);
+    bm.SetLabel(par::BackendName(backend));
+}
+BENCHMARK(BM_backend_sine)->Apply(par::BackendSizeArgs)->UseRealTime();
+
+/**
+ * @brief 并行后端对比：每个区间调用一次自动分派的 SIMD sin（kUlp4 精度），参数同 BM_backend_fill。
+ * @param bm Google Benchmark 传入的状态对象。
+ *
+ * 区间由后端决定，不再按固定 chunk 切分，区间过小时 SIMD 内核的尾部处理占比会上升。
+ */
+void BM_backend_simd_sin(benchmark::State &bm) {
+    const auto backend = static_cast<par::Backend>(bm.range(0));
+    const size_t m = static_cast<size_t>(bm.range(1));
+    const float *x = sine_input().data();
+    float *p = a.data();
+    for (auto _: bm) {
+        par::ParallelFor(backend, m, [x, p](size_t begin, size_t end) {
+            simd_math::Sin(x + begin, p + begin, end - begin, simd_math::Accuracy::kUlp4);
+        });
+        benchmark::DoNotOptimize(p);
+    }
+    bm.SetItemsProcessed(bm.iterations() * m);
+    bm.SetLabel(par::BackendName(backend));
+}
+BENCHMARK(BM_backend_simd_sin)->Apply(par::BackendSizeArgs)->UseRealTime();
+
 /**
  * @brief Google Benchmark 程序入口宏。
  *
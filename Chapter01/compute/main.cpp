@@ -7,6 +7,13 @@
 #include <benchmark/benchmark.h>
 #include <x86intrin.h>
 #include <omp.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include "aligned_buffer.h"
+#include "fast_recip.h"
+#include "parallel_bench.h"
+#include "pipeline.h"
 
 /**
  * @file main.cpp
@@ -15,6 +22,10 @@
  * 测试内容：
  * 1. 串行执行 a[i] = func(a[i])
  * 2. OpenMP 并行执行 a[i] = func(a[i])
+ * 3. 用倒数近似 + Newton-Raphson / 合并除法改写 func，按工作集大小观察计算瓶颈到访存瓶颈的转折
+ * 4. 逐元素算子链：逐步扫描整个数组 vs 按 L2 分块融合执行
+ * 5. 同一 func 内核在不同并行后端（OpenMP / TBB / par_unseq / 工作窃取线程池）与不同规模下的耗时，
+ *    以及改写后的 func 变体、融合 / 未融合算子链在各后端下的耗时
  */
 constexpr size_t n = 1<<28;
 
@@ -22,8 +33,9 @@ constexpr size_t n = 1<<28;
  * @brief 被测试的全局数组，大小约 1 GB。
  *
  * 采用全局分配可避免在基准循环内重复申请/释放内存，减少非目标开销。
+ * 用 membuf::Buffer 代替 std::vector：跳过 1GB 的串行清零，由各线程按静态调度并行首次触碰。
  */
-std::vector<float> a(n);  // 1GB
+membuf::Buffer<float> a(n);  // 1GB
 
 /**
  * @brief 用于基准测试的计算函数。
@@ -69,6 +81,328 @@ void BM_parallel_func(benchmark::State &bm) {
 }
 BENCHMARK(BM_parallel_func);
 
+/**
+ * @brief 并行后端对比：参数为 (后端, 元素个数)，只处理 a 的前 m 个元素。
+ * @param bm Google Benchmark 状态对象。
+ *
+ * func 每个元素的计算量比 BM_backend_add 大得多，调度开销被摊薄的规模也更小。
+ */
+void BM_backend_func(benchmark::State &bm) {
+    const auto backend = static_cast<par::Backend>(bm.range(0));
+    const size_t m = static_cast<size_t>(bm.range(1));
+    float *p = a.data();
+    for (auto _: bm) {
+        par::ParallelFor(backend, m, [p](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                p[i] = func(p[i]);
+            }
+        });
+        // 保留结果可见性，避免被激进优化影响测试结论。
+        benchmark::ClobberMemory();
+    }
+    bm.SetItemsProcessed(bm.iterations() * m);
+    bm.SetLabel(par::BackendName(backend));
+}
+BENCHMARK(BM_backend_func)->Apply(par::BackendSizeArgs)->UseRealTime();
+
+#ifdef __AVX512F__
+using vfloat = __m512;
+constexpr size_t vlen = 16;
+static inline vfloat vload(const float *p) { return _mm512_loadu_ps(p); }
+static inline void vstore(float *p, vfloat v) { _mm512_storeu_ps(p, v); }
+static inline vfloat vset1(float x) { return _mm512_set1_ps(x); }
+static inline vfloat vadd(vfloat a, vfloat b) { return _mm512_add_ps(a, b); }
+static inline vfloat vsub(vfloat a, vfloat b) { return _mm512_sub_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b) { return _mm512_mul_ps(a, b); }
+static inline vfloat vdiv(vfloat a, vfloat b) { return _mm512_div_ps(a, b); }
+static inline vfloat vfmadd(vfloat a, vfloat b, vfloat c) { return _mm512_fmadd_ps(a, b, c); }
+static inline vfloat vfmsub(vfloat a, vfloat b, vfloat c) { return _mm512_fmsub_ps(a, b, c); }
+#else
+using vfloat = __m256;
+constexpr size_t vlen = 8;
+static inline vfloat vload(const float *p) { return _mm256_loadu_ps(p); }
+static inline void vstore(float *p, vfloat v) { _mm256_storeu_ps(p, v); }
+static inline vfloat vset1(float x) { return _mm256_set1_ps(x); }
+static inline vfloat vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat vsub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat vdiv(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+static inline vfloat vfmadd(vfloat a, vfloat b, vfloat c) { return _mm256_fmadd_ps(a, b, c); }
+static inline vfloat vfmsub(vfloat a, vfloat b, vfloat c) { return _mm256_fmsub_ps(a, b, c); }
+#endif
+
+/**
+ * @brief 倒数：Steps < 0 用真除法，否则用 rcp + Steps 次 Newton-Raphson。
+ */
+template <int Steps>
+static inline vfloat recip(vfloat b) {
+    if constexpr (Steps < 0) {
+        return vdiv(vset1(1.0f), b);
+    } else {
+        return fast_recip::Rcp<Steps>(b);
+    }
+}
+
+/**
+ * @brief func 的向量版本：两个倒数分别计算。
+ * @tparam Steps 倒数精度，含义同 recip。
+ */
+template <int Steps>
+void func_rcp(const float *x, float *y, size_t m) {
+    const vfloat one = vset1(1.0f), e = vset1(2.718f), pi = vset1(3.14f), c42 = vset1(42.0f);
+    size_t i = 0;
+    for (; i + vlen <= m; i += vlen) {
+        vfloat v = vload(x + i);
+        vfloat inv1 = recip<Steps>(vadd(v, one));
+        vfloat inv2 = recip<Steps>(vsub(e, v));
+        // x * x + x * 3.14 - 1 / (x + 1) = x * (x + 3.14) - inv1
+        vfloat t = vfmsub(v, vadd(v, pi), inv1);
+        vstore(y + i, vfmadd(v, t, vmul(c42, inv2)));
+    }
+    for (; i < m; i++) {
+        y[i] = func(x[i]);
+    }
+}
+
+/**
+ * @brief 合并除法：inv = 1 / ((x + 1) * (2.718 - x))，
+ * 于是 1 / (x + 1) = (2.718 - x) * inv，42 / (2.718 - x) = 42 * (x + 1) * inv，只需一次倒数。
+ * @tparam Steps 倒数精度，含义同 recip。
+ */
+template <int Steps>
+void func_fused(const float *x, float *y, size_t m) {
+    const vfloat one = vset1(1.0f), e = vset1(2.718f), pi = vset1(3.14f), c42 = vset1(42.0f);
+    size_t i = 0;
+    for (; i + vlen <= m; i += vlen) {
+        vfloat v = vload(x + i);
+        vfloat p = vadd(v, one);
+        vfloat q = vsub(e, v);
+        vfloat inv = recip<Steps>(vmul(p, q));
+        vfloat t = vfmsub(v, vadd(v, pi), vmul(q, inv));
+        vstore(y + i, vfmadd(v, t, vmul(vmul(c42, p), inv)));
+    }
+    for (; i < m; i++) {
+        y[i] = func(x[i]);
+    }
+}
+
+/**
+ * @brief 基准写法：逐元素调用 func（两次真除法），由编译器自动向量化。
+ */
+void func_div(const float *x, float *y, size_t m) {
+    for (size_t i = 0; i < m; i++) {
+        y[i] = func(x[i]);
+    }
+}
+
+/**
+ * @brief 各变体的名称与实现。
+ */
+struct func_variant {
+    const char *name;
+    void (*kernel)(const float *, float *, size_t);
+};
+
+const func_variant func_variants[] = {
+    {"div", func_div},
+    {"fused_div", func_fused<-1>},
+    {"rcp0", func_rcp<0>},
+    {"rcp1", func_rcp<1>},
+    {"rcp2", func_rcp<2>},
+    {"fused_rcp1", func_fused<1>},
+};
+
+/**
+ * @brief 各变体的输入：取值在 [-0.5, 2.5)，避开 x = -1 与 x = 2.718 两个极点。
+ * 与原地迭代的 BM_serial_func 不同，这里输入固定、写到 a，便于测误差。
+ */
+constexpr size_t max_variant_n = 1 << 27;
+
+const membuf::Buffer<float> &func_input() {
+    static const membuf::Buffer<float> x = [] {
+        membuf::Buffer<float> v(max_variant_n, {membuf::Pages::kDefault, membuf::FirstTouch::kNone});
+#pragma omp parallel for
+        for (size_t i = 0; i < max_variant_n; i++) {
+            v[i] = -0.5f + 3.0f * static_cast<float>(i % 65536) / 65536;
+        }
+        return v;
+    }();
+    return x;
+}
+
+/**
+ * @brief func 的 double 参考值（常数取与 float 版本相同的舍入值）。
+ */
+static double func_ref(double x) {
+    return x * (x * x + x * double(3.14f) - 1 / (x + 1)) + 42 / (double(2.718f) - x);
+}
+
+/**
+ * @brief 某变体在一个输入周期（65536 个取值）上的最大相对误差，结果缓存。
+ */
+double func_max_rel_err(int variant) {
+    static std::map<int, double> cache;
+    auto it = cache.find(variant);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    constexpr size_t m = 65536;
+    std::vector<float> y(m);
+    func_variants[variant].kernel(func_input().data(), y.data(), m);
+    double err = 0;
+    for (size_t i = 0; i < m; i++) {
+        double ref = func_ref(func_input()[i]);
+        err = std::max(err, std::fabs(y[i] - ref) / std::fabs(ref));
+    }
+    cache.emplace(variant, err);
+    return err;
+}
+
+/**
+ * @brief 变体基准：参数为 (变体, 元素个数)。
+ * @param bm Google Benchmark 状态对象。
+ *
+ * 元素数从 16KB 的 L1 工作集一直放大到 512MB：小工作集时吞吐由除法/倒数的计算决定，
+ * 工作集超出缓存后各变体收敛到同一条内存带宽线上，转折点即计算瓶颈变为访存瓶颈之处。
+ */
+void BM_func_variant(benchmark::State &bm) {
+    const int variant = static_cast<int>(bm.range(0));
+    const size_t m = static_cast<size_t>(bm.range(1));
+    const float *x = func_input().data();
+    for (auto _: bm) {
+        func_variants[variant].kernel(x, a.data(), m);
+        benchmark::DoNotOptimize(a.data());
+    }
+    bm.SetItemsProcessed(bm.iterations() * m);
+    bm.SetBytesProcessed(bm.iterations() * m * 2 * sizeof(float));
+    bm.counters["max_rel_err"] = func_max_rel_err(variant);
+    bm.SetLabel(func_variants[variant].name);
+}
+BENCHMARK(BM_func_variant)
+    ->ArgsProduct({benchmark::CreateDenseRange(0, 5, 1),
+                   {1 << 12, 1 << 15, 1 << 18, 1 << 21, 1 << 24, 1 << 27}})
+    ->ArgNames({"variant", "n"});
+
+/**
+ * @brief 变体 × 并行后端基准：参数为 (变体, 元素个数, 后端)。
+ * @param bm Google Benchmark 状态对象。
+ *
+ * 每个后端把区间切段后逐段调用同一个变体内核；只取缓存内与访存瓶颈两档规模，
+ * 观察改写后的 func 在各后端下是否仍保持串行时的相对快慢。
+ */
+void BM_backend_func_variant(benchmark::State &bm) {
+    const int variant = static_cast<int>(bm.range(0));
+    const size_t m = static_cast<size_t>(bm.range(1));
+    const auto backend = static_cast<par::Backend>(bm.range(2));
+    const float *x = func_input().data();
+    float *y = a.data();
+    const auto kernel = func_variants[variant].kernel;
+    for (auto _: bm) {
+        par::ParallelFor(backend, m, [x, y, kernel](size_t begin, size_t end) {
+            kernel(x + begin, y + begin, end - begin);
+        });
+        benchmark::DoNotOptimize(y);
+    }
+    bm.SetItemsProcessed(bm.iterations() * m);
+    bm.SetBytesProcessed(bm.iterations() * m * 2 * sizeof(float));
+    bm.SetLabel(std::string(func_variants[variant].name) + "/" + par::BackendName(backend));
+}
+BENCHMARK(BM_backend_func_variant)
+    ->ArgsProduct({benchmark::CreateDenseRange(0, 5, 1), {1 << 15, 1 << 27}, par::Backends()})
+    ->ArgNames({"variant", "n", "backend"})
+    ->UseRealTime();
+
+/**
+ * @brief 由 k 个相同的轻量算子 x = x * 0.999 + 0.5 组成的链，数值有界，便于重复执行。
+ */
+pipeline::Pipeline make_axpb_chain(int k) {
+    pipeline::Pipeline p;
+    for (int j = 0; j < k; j++) {
+        p.ThenMap([](float x) { return x * 0.999f + 0.5f; });
+    }
+    return p;
+}
+
+/**
+ * @brief 未融合算子链基准：参数为链长，每个算子完整扫描一遍 1GB 数组。
+ * @param bm Google Benchmark 状态对象。
+ */
+void BM_chain_unfused(benchmark::State &bm) {
+    const pipeline::Pipeline p = make_axpb_chain(static_cast<int>(bm.range(0)));
+    for (auto _: bm) {
+        p.RunUnfused(a.data(), n);
+        benchmark::DoNotOptimize(a.data());
+    }
+    bm.SetItemsProcessed(bm.iterations() * n * p.size());
+}
+BENCHMARK(BM_chain_unfused)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief 融合算子链基准：参数为链长，按 L2 分块，每块过完整条链再前进。
+ * @param bm Google Benchmark 状态对象。
+ *
+ * 数组只进出内存一次，链越长，相对未融合版本省下的访存越多，直到变为计算瓶颈。
+ */
+void BM_chain_fused(benchmark::State &bm) {
+    const pipeline::Pipeline p = make_axpb_chain(static_cast<int>(bm.range(0)));
+    for (auto _: bm) {
+        p.Run(a.data(), n);
+        benchmark::DoNotOptimize(a.data());
+    }
+    bm.SetItemsProcessed(bm.iterations() * n * p.size());
+    bm.counters["block_kb"] = pipeline::DefaultBlockElems() * sizeof(float) / 1024;
+}
+BENCHMARK(BM_chain_fused)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief 算子链 × 并行后端基准：参数为 (是否融合, 链长, 后端)。
+ * @param bm Google Benchmark 状态对象。
+ *
+ * 未融合时每个算子各做一次并行扫描（每次都有一轮调度与同步），
+ * 融合时以 L2 块为调度单位，每块在一个线程内过完整条链。
+ */
+void BM_chain_backend(benchmark::State &bm) {
+    const bool fused = bm.range(0) != 0;
+    const pipeline::Pipeline p = make_axpb_chain(static_cast<int>(bm.range(1)));
+    const auto backend = static_cast<par::Backend>(bm.range(2));
+    for (auto _: bm) {
+        if (fused) {
+            p.ParallelRun(backend, a.data(), n);
+        } else {
+            p.ParallelRunUnfused(backend, a.data(), n);
+        }
+        benchmark::DoNotOptimize(a.data());
+    }
+    bm.SetItemsProcessed(bm.iterations() * n * p.size());
+    bm.SetLabel(std::string(fused ? "fused" : "unfused") + "/" + par::BackendName(backend));
+}
+BENCHMARK(BM_chain_backend)
+    ->ArgsProduct({{0, 1}, {1, 4, 16}, par::Backends()})
+    ->ArgNames({"fused", "k", "backend"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/**
+ * @brief 先自增再 func 的两步链，参数为 0（未融合）或 1（融合）。
+ * @param bm Google Benchmark 状态对象。
+ */
+void BM_add_func_chain(benchmark::State &bm) {
+    pipeline::Pipeline p;
+    p.ThenMap([](float x) { return x + 1; }).ThenMap([](float x) { return func(x); });
+    const bool fused = bm.range(0) != 0;
+    for (auto _: bm) {
+        if (fused) {
+            p.Run(a.data(), n);
+        } else {
+            p.RunUnfused(a.data(), n);
+        }
+        benchmark::DoNotOptimize(a.data());
+    }
+    bm.SetItemsProcessed(bm.iterations() * n);
+    bm.SetLabel(fused ? "fused" : "unfused");
+}
+BENCHMARK(BM_add_func_chain)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
 /**
  * @brief Google Benchmark 入口。
  *
@@ -7,6 +7,8 @@
 #include <benchmark/benchmark.h>
 #include <x86intrin.h>
 #include <omp.h>
+#include "aligned_buffer.h"
+#include "parallel_bench.h"
 
 /**
  * @file main.cpp
@@ -15,6 +17,7 @@
  * 测试内容：
  * 1. 串行执行 a[i] = a[i] + 1
  * 2. OpenMP 并行执行 a[i] = a[i] + 1
+ * 3. 同一内核在不同并行后端（OpenMP / TBB / par_unseq / 工作窃取线程池）与不同规模下的耗时
  */
 constexpr size_t n = 1<<28;
 
@@ -22,8 +25,10 @@ constexpr size_t n = 1<<28;
  * @brief 被测试的全局数组，大小约 1 GB。
  *
  * 采用全局分配可避免在基准循环内重复申请/释放内存，减少非目标开销。
+ * membuf::Buffer 不做串行的值初始化，而是按与并行循环相同的静态调度首次触碰，
+ * 启动更快，并行版本中每个线程访问的页也落在自己的 NUMA 节点上。
  */
-std::vector<float> a(n);  // 1GB
+membuf::Buffer<float> a(n);  // 1GB
 
 /**
  * @brief 串行自增基准。
@@ -60,6 +65,30 @@ void BM_parallel_add(benchmark::State &bm) {
 }
 BENCHMARK(BM_parallel_add);
 
+/**
+ * @brief 并行后端对比：参数为 (后端, 元素个数)，只处理 a 的前 m 个元素。
+ * @param bm Google Benchmark 状态对象。
+ *
+ * 小规模下耗时主要是调度开销（唤醒线程、划分任务、等待结束），大规模下各后端都受带宽限制。
+ */
+void BM_backend_add(benchmark::State &bm) {
+    const auto backend = static_cast<par::Backend>(bm.range(0));
+    const size_t m = static_cast<size_t>(bm.range(1));
+    float *p = a.data();
+    for (auto _: bm) {
+        par::ParallelFor(backend, m, [p](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                p[i] = p[i] + 1;
+            }
+        });
+        // 保留结果可见性，避免被激进优化影响测试结论。
+        benchmark::ClobberMemory();
+    }
+    bm.SetBytesProcessed(bm.iterations() * m * 2 * sizeof(float));
+    bm.SetLabel(par::BackendName(backend));
+}
+BENCHMARK(BM_backend_add)->Apply(par::BackendSizeArgs)->UseRealTime();
+
 /**
  * @brief Google Benchmark 入口。
  *
@@ -4,111 +4,221 @@
 #include <cstring>
 #include <cstdlib>
 #include <array>
+#include <string>
+#include <algorithm>
 #include <benchmark/benchmark.h>
 #include <x86intrin.h>
 #include <omp.h>
+#include "aligned_buffer.h"
+#include "cache_topology.h"
+#include "parallel_backend.h"
 
 /**
  * @file main.cpp
- * @brief 不同数组规模下的顺序写入性能测试，用于观察缓存层级影响。
+ * @brief STREAM 风格的带宽测试套件，用于观察缓存层级对吞吐的影响。
+ *
+ * 测试内容：read / write / copy / scale / add / triad 六个内核，
+ * 规模按 sysfs 检测到的缓存拓扑生成：每级缓存取其一半容量（可完全放下），
+ * 再加一个远大于末级缓存的内存规模；每个规模分别用串行与各并行后端
+ * （OpenMP / TBB / par_unseq / 工作窃取线程池）执行，串行即原先的单线程，OpenMP 即原先的全部线程。
+ * 规模指一次迭代内所有数组的总字节数，因此不同内核的同一规模落在同一级缓存。
  */
-// L1: 32KB
-// L2: 256KB
-// L3: 12MB
 
 /**
- * @brief 最大测试规模（约 1GB 的 float 数组）。
- *
- * 采用全局数组避免在基准循环内反复分配内存，减少非目标开销。
+ * @brief 最大测试规模（所有数组合计 1GB）。
  */
-constexpr size_t n = 1<<28;
+constexpr size_t max_bytes = size_t(1) << 30;
 
 /**
- * @brief 全局数据缓冲区，容量为 n 个 float。
+ * @brief triad / scale 使用的标量。
  */
-std::vector<float> a(n);
+constexpr float scalar = 3.0f;
 
 /**
- * @brief 填充 1GB 数据：完全覆盖数组。
- * @param bm Google Benchmark 状态对象。
+ * @brief 内核描述：名称、访问的数组个数（决定每个数组的长度与字节数）。
  */
-void BM_fill1GB(benchmark::State &bm) {
-    for (auto _: bm) {
-        for (size_t i = 0; i < (1<<28); i++) {
-            a[i] = 1;
-        }
-    }
-}
-BENCHMARK(BM_fill1GB);
+struct stream_kernel {
+    const char *name;
+    int arrays;
+};
+
+const std::array<stream_kernel, 6> kernels = {{
+    {"read", 1},   // sum += a[i]
+    {"write", 1},  // a[i] = s
+    {"copy", 2},   // a[i] = b[i]
+    {"scale", 2},  // a[i] = s * b[i]
+    {"add", 3},    // a[i] = b[i] + c[i]
+    {"triad", 3},  // a[i] = b[i] + s * c[i]
+}};
 
 /**
- * @brief 填充 128MB 数据：覆盖部分数组。
- * @param bm Google Benchmark 状态对象。
+ * @brief 全局数据缓冲区：a 需容纳单数组内核的全部规模，b / c 只在多数组内核中使用。
+ *
+ * 首次使用时分配，只跑部分基准时不会占用无关内存。
+ * 初值由 Fill 按 OpenMP 静态调度并行写入，多线程内核访问的页与首次触碰的线程一致。
  */
-void BM_fill128MB(benchmark::State &bm) {
-    for (auto _: bm) {
-        for (size_t i = 0; i < (1<<25); i++) {
-            a[i] = 1;
-        }
+struct stream_buffers {
+    membuf::Buffer<float> a, b, c;
+
+    stream_buffers()
+        : a(max_bytes / sizeof(float), untouched()),
+          b(max_bytes / 2 / sizeof(float), untouched()),
+          c(max_bytes / 3 / sizeof(float), untouched()) {
+        a.Fill(1.0f);
+        b.Fill(2.0f);
+        c.Fill(0.5f);
     }
+
+    static membuf::Options untouched() {
+        return {membuf::Pages::kDefault, membuf::FirstTouch::kNone};
+    }
+};
+
+stream_buffers &buffers() {
+    static stream_buffers buf;
+    return buf;
 }
-BENCHMARK(BM_fill128MB);
 
 /**
- * @brief 填充 16MB 数据：接近或略大于 L3 的规模。
- * @param bm Google Benchmark 状态对象。
+ * @brief 执行一次内核。
+ * @param k 内核下标。
+ * @param m 每个数组的元素个数。
+ * @param backend 并行后端。
  */
-void BM_fill16MB(benchmark::State &bm) {
-    for (auto _: bm) {
-        for (size_t i = 0; i < (1<<22); i++) {
-            a[i] = 1;
-        }
+void run_kernel(int k, size_t m, par::Backend backend) {
+    stream_buffers &buf = buffers();
+    float *a = buf.a.data();
+    const float *b = buf.b.data();
+    const float *c = buf.c.data();
+    switch (k) {
+    case 0: {
+        const float sum = par::ParallelReduce(
+            backend, m, 0.0f,
+            [a](size_t begin, size_t end, float acc) {
+                for (size_t i = begin; i < end; i++) {
+                    acc += a[i];
+                }
+                return acc;
+            },
+            [](float x, float y) { return x + y; });
+        benchmark::DoNotOptimize(sum);
+        break;
+    }
+    case 1:
+        par::ParallelFor(backend, m, [a](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                a[i] = scalar;
+            }
+        });
+        break;
+    case 2:
+        par::ParallelFor(backend, m, [a, b](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                a[i] = b[i];
+            }
+        });
+        break;
+    case 3:
+        par::ParallelFor(backend, m, [a, b](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                a[i] = scalar * b[i];
+            }
+        });
+        break;
+    case 4:
+        par::ParallelFor(backend, m, [a, b, c](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                a[i] = b[i] + c[i];
+            }
+        });
+        break;
+    default:
+        par::ParallelFor(backend, m, [a, b, c](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                a[i] = b[i] + scalar * c[i];
+            }
+        });
+        break;
     }
+    // 防止编译器将写入优化掉，保证基准有效性。
+    benchmark::ClobberMemory();
 }
-BENCHMARK(BM_fill16MB);
 
 /**
- * @brief 填充 1MB 数据：显著小于 L3，但大于 L2 的规模。
+ * @brief 带宽基准：参数为 (总字节数, 后端)，计数器 bytes_per_second 为所有数组读写字节之和。
  * @param bm Google Benchmark 状态对象。
+ * @param k 内核下标。
+ * @param where 该规模所在的存储层级，作为标签输出。
  */
-void BM_fill1MB(benchmark::State &bm) {
+void BM_stream(benchmark::State &bm, int k, const std::string &where) {
+    const size_t bytes = static_cast<size_t>(bm.range(0));
+    const auto backend = static_cast<par::Backend>(bm.range(1));
+    const size_t m = bytes / kernels[k].arrays / sizeof(float);
+    // 先跑一遍：完成缓冲区的分配与首次触碰，并把小规模数据预热进缓存。
+    run_kernel(k, m, backend);
     for (auto _: bm) {
-        for (size_t i = 0; i < (1<<18); i++) {
-            a[i] = 1;
-        }
+        run_kernel(k, m, backend);
     }
+    bm.SetBytesProcessed(bm.iterations() * m * kernels[k].arrays * sizeof(float));
+    bm.SetLabel(where + " " + par::BackendName(backend));
 }
-BENCHMARK(BM_fill1MB);
 
 /**
- * @brief 填充 128KB 数据：接近或小于 L2 的规模。
- * @param bm Google Benchmark 状态对象。
+ * @brief 一个测试规模及其所在层级。
  */
-void BM_fill128KB(benchmark::State &bm) {
-    for (auto _: bm) {
-        for (size_t i = 0; i < (1<<15); i++) {
-            a[i] = 1;
-        }
-    }
-}
-BENCHMARK(BM_fill128KB);
+struct size_point {
+    size_t bytes;
+    std::string where;
+};
 
 /**
- * @brief 填充 16KB 数据：接近或小于 L1 的规模。
- * @param bm Google Benchmark 状态对象。
+ * @brief 根据缓存拓扑生成测试规模：每级缓存的一半，以及 4 倍末级缓存（不超过 max_bytes）的内存规模。
+ *
+ * 检测失败时退回原先写死的 16KB ~ 1GB 六档。
  */
-void BM_fill16KB(benchmark::State &bm) {
-    for (auto _: bm) {
-        for (size_t i = 0; i < (1<<12); i++) {
-            a[i] = 1;
+std::vector<size_point> size_points() {
+    const auto caches = cache_topology::DataCaches();
+    std::vector<size_point> points;
+    if (caches.empty()) {
+        for (size_t b: {size_t(16) << 10, size_t(128) << 10, size_t(1) << 20, size_t(16) << 20,
+                        size_t(128) << 20, max_bytes}) {
+            points.push_back({b, "unknown"});
         }
+        return points;
+    }
+    for (const auto &c: caches) {
+        points.push_back({c.size_bytes / 2, "L" + std::to_string(c.level)});
     }
+    const size_t llc = caches.back().size_bytes;
+    points.push_back({std::min(llc * 4, max_bytes), "DRAM"});
+    return points;
 }
-BENCHMARK(BM_fill16KB);
 
 /**
- * @brief Google Benchmark 入口。
- *
- * 自动生成 main 并运行所有注册的基准测试。
+ * @brief 程序入口：规模在运行时才能确定，因此手动注册基准，并把缓存拓扑写入输出的上下文。
  */
-BENCHMARK_MAIN();
+int main(int argc, char **argv) {
+    for (const auto &c: cache_topology::DataCaches()) {
+        benchmark::AddCustomContext("L" + std::to_string(c.level) + " " + c.type,
+                                    std::to_string(c.size_bytes >> 10) + " KiB, shared by " +
+                                        std::to_string(c.shared_cpus) + " cpus");
+    }
+    const auto points = size_points();
+    for (int k = 0; k < static_cast<int>(kernels.size()); k++) {
+        for (const auto &p: points) {
+            const std::string name = std::string("BM_") + kernels[k].name;
+            auto *b = benchmark::RegisterBenchmark(name.c_str(), BM_stream, k, p.where);
+            for (int backend = 0; backend < par::kBackendCount; backend++) {
+                b->Args({static_cast<int64_t>(p.bytes), backend});
+            }
+            b->ArgNames({"bytes", "backend"})->UseRealTime();
+        }
+    }
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -3,158 +3,151 @@
 #include <cmath>
 #include <cstring>
 #include <cstdlib>
+#include <cstdint>
 #include <array>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
 #include <benchmark/benchmark.h>
 #include <x86intrin.h>
 #include <omp.h>
+#include "aligned_buffer.h"
 
 /**
  * @file main.cpp
- * @brief 测试不同步长（stride）下的并行写入性能。
+ * @brief 步长 / TLB 实验：测试不同步长、访问方式与页大小下的访存性能。
  *
- * 通过改变步长 i += k，观察缓存行与预取对吞吐的影响。
+ * 测试维度：
+ * 1. 访问方式：写、读、读改写（RMW）
+ * 2. 步长：4B ~ 512B（原先的 i += 1 ~ 128），以及超过页大小的 1KB ~ 64KB，
+ *    步长 >= 4KB 时每次访问都落在新页上，吞吐主要受 dTLB 未命中限制
+ * 3. 页大小：4KB 页与透明大页（madvise(MADV_HUGEPAGE)）
+ * 4. 页访问顺序：顺序 vs 随机打乱，打乱后硬件预取器无法跨页预取
+ *
+ * 计数器：bytes_per_second 为实际访问的有效字节，lines_per_second 为每秒触及的缓存行数。
  */
-// L1: 32KB
-// L2: 256KB
-// L3: 12MB
 
 /**
- * @brief 最大测试规模（约 1GB 的 float 数组）。
+ * @brief 测试规模（约 1GB 的 float 数组）。
  */
 constexpr size_t n = 1<<28;
+constexpr size_t bytes = n * sizeof(float);
+constexpr size_t page = 4096;
+constexpr size_t line = 64;
 
 /**
- * @brief 全局数组缓冲区，避免在基准循环内重复分配内存。
- */
-std::vector<float> a(n);  // 1GB
-
-/**
- * @brief 步长为 1 的并行写入基准（连续访问）。
- * @param bm Google Benchmark 状态对象。
- */
-void BM_skip1(benchmark::State &bm) {
-    for (auto _: bm) {
-#pragma omp parallel for
-        for (size_t i = 0; i < n; i += 1) {
-            a[i] = 1;
-        }
-        // 防止编译器将写入优化掉，保证基准有效性。
-        benchmark::DoNotOptimize(a);
-    }
-}
-BENCHMARK(BM_skip1);
-
-/**
- * @brief 步长为 2 的并行写入基准。
- * @param bm Google Benchmark 状态对象。
- */
-void BM_skip2(benchmark::State &bm) {
-    for (auto _: bm) {
-#pragma omp parallel for
-        for (size_t i = 0; i < n; i += 2) {
-            a[i] = 1;
-        }
-        // 保留结果可见性，避免被激进优化影响测试结论。
-        benchmark::DoNotOptimize(a);
-    }
-}
-BENCHMARK(BM_skip2);
-
-/**
- * @brief 步长为 4 的并行写入基准。
- * @param bm Google Benchmark 状态对象。
+ * @brief 1GB 缓冲区，用 madvise 指定 4KB 页或透明大页，构造时并行首次触碰。
+ *
+ * 同一时刻只保留一种页大小的缓冲区，避免两份 1GB 同时驻留。
  */
-void BM_skip4(benchmark::State &bm) {
-    for (auto _: bm) {
-#pragma omp parallel for
-        for (size_t i = 0; i < n; i += 4) {
-            a[i] = 1;
-        }
-        // 保留结果可见性，避免被激进优化影响测试结论。
-        benchmark::DoNotOptimize(a);
+membuf::Buffer<float> &buffer(bool huge) {
+    static membuf::Buffer<float> buf;
+    static int kind = -1;
+    if (kind != static_cast<int>(huge)) {
+        buf = membuf::Buffer<float>();
+        buf = membuf::Buffer<float>(n, {huge ? membuf::Pages::kHuge : membuf::Pages::kSmall});
+        kind = huge;
     }
+    return buf;
 }
-BENCHMARK(BM_skip4);
 
 /**
- * @brief 步长为 8 的并行写入基准。
- * @param bm Google Benchmark 状态对象。
+ * @brief 本次访问涉及的页列表：步长 >= 4KB 时每 stride / 4KB 页取一页，否则取全部页。
+ * @param stride 步长（字节）。
+ * @param shuffled 是否随机打乱页顺序。
  */
-void BM_skip8(benchmark::State &bm) {
-    for (auto _: bm) {
-#pragma omp parallel for
-        for (size_t i = 0; i < n; i += 8) {
-            a[i] = 1;
-        }
-        // 保留结果可见性，避免被激进优化影响测试结论。
-        benchmark::DoNotOptimize(a);
+std::vector<uint32_t> page_order(size_t stride, bool shuffled) {
+    const size_t step = std::max<size_t>(1, stride / page);
+    std::vector<uint32_t> pages(bytes / page / step);
+    for (size_t i = 0; i < pages.size(); i++) {
+        pages[i] = static_cast<uint32_t>(i * step);
     }
-}
-BENCHMARK(BM_skip8);
-
-/**
- * @brief 步长为 16 的并行写入基准。
- * @param bm Google Benchmark 状态对象。
- */
-void BM_skip16(benchmark::State &bm) {
-    for (auto _: bm) {
-#pragma omp parallel for
-        for (size_t i = 0; i < n; i += 16) {
-            a[i] = 1;
-        }
-        // 保留结果可见性，避免被激进优化影响测试结论。
-        benchmark::DoNotOptimize(a);
+    if (shuffled) {
+        std::shuffle(pages.begin(), pages.end(), std::mt19937_64(42));
     }
+    return pages;
 }
-BENCHMARK(BM_skip16);
 
 /**
- * @brief 步长为 32 的并行写入基准。
+ * @brief 步长基准：参数为 (访问方式, 步长字节数, 是否大页, 是否打乱页顺序)。
  * @param bm Google Benchmark 状态对象。
+ *
+ * 顺序与打乱两种情况执行完全相同的循环结构，只有页的先后不同，差值即硬件预取的贡献。
  */
-void BM_skip32(benchmark::State &bm) {
+void BM_stride(benchmark::State &bm) {
+    const int op = static_cast<int>(bm.range(0));
+    const size_t stride = static_cast<size_t>(bm.range(1));
+    const bool huge = bm.range(2) != 0;
+    const bool shuffled = bm.range(3) != 0;
+    float *a = buffer(huge).data();
+    const std::vector<uint32_t> pages = page_order(stride, shuffled);
+    const uint32_t *pg = pages.data();
+    const size_t count = pages.size();
+    // 每页内访问的元素：步长小于一页时按步长走完整页，否则只访问页首一个。
+    const size_t step = stride / sizeof(float);
+    const size_t per_page = stride < page ? page / stride : 1;
+    const size_t floats_per_page = page / sizeof(float);
     for (auto _: bm) {
+        if (op == 0) {
 #pragma omp parallel for
-        for (size_t i = 0; i < n; i += 32) {
-            a[i] = 1;
-        }
-        // 保留结果可见性，避免被激进优化影响测试结论。
-        benchmark::DoNotOptimize(a);
-    }
-}
-BENCHMARK(BM_skip32);
-
-/**
- * @brief 步长为 64 的并行写入基准。
- * @param bm Google Benchmark 状态对象。
- */
-void BM_skip64(benchmark::State &bm) {
-    for (auto _: bm) {
+            for (size_t p = 0; p < count; p++) {
+                float *q = a + pg[p] * floats_per_page;
+                for (size_t j = 0; j < per_page; j++) {
+                    q[j * step] = 1;
+                }
+            }
+        } else if (op == 1) {
+            float sum = 0;
+#pragma omp parallel for reduction(+: sum)
+            for (size_t p = 0; p < count; p++) {
+                const float *q = a + pg[p] * floats_per_page;
+                for (size_t j = 0; j < per_page; j++) {
+                    sum += q[j * step];
+                }
+            }
+            benchmark::DoNotOptimize(sum);
+        } else {
 #pragma omp parallel for
-        for (size_t i = 0; i < n; i += 64) {
-            a[i] = 1;
+            for (size_t p = 0; p < count; p++) {
+                float *q = a + pg[p] * floats_per_page;
+                for (size_t j = 0; j < per_page; j++) {
+                    q[j * step] += 1;
+                }
+            }
         }
         // 保留结果可见性，避免被激进优化影响测试结论。
-        benchmark::DoNotOptimize(a);
+        benchmark::ClobberMemory();
     }
+    const size_t accesses = count * per_page;
+    const size_t lines = stride >= line ? accesses : accesses * stride / line;
+    bm.SetItemsProcessed(bm.iterations() * accesses);
+    bm.SetBytesProcessed(bm.iterations() * accesses * sizeof(float));
+    bm.counters["lines_per_second"] = benchmark::Counter(
+        static_cast<double>(bm.iterations() * lines), benchmark::Counter::kIsRate);
+    bm.counters["anon_huge_mb"] = static_cast<double>(membuf::AnonHugePagesKb() >> 10);
+    static const char *ops[] = {"write", "read", "rmw"};
+    bm.SetLabel(std::string(ops[op]) + (huge ? " 2M" : " 4K") + (shuffled ? " random" : " seq"));
 }
-BENCHMARK(BM_skip64);
 
 /**
- * @brief 步长为 128 的并行写入基准。
- * @param bm Google Benchmark 状态对象。
+ * @brief 参数组合：步长 4B ~ 64KB（每档 ×2），三种访问方式，页大小与页顺序两两组合。
+ *
+ * 页大小放在最外层：buffer() 只缓存一种页大小，这样 1GB 数组总共只分配两次。
  */
-void BM_skip128(benchmark::State &bm) {
-    for (auto _: bm) {
-#pragma omp parallel for
-        for (size_t i = 0; i < n; i += 128) {
-            a[i] = 1;
+static void stride_args(benchmark::internal::Benchmark *b) {
+    for (int huge: {0, 1}) {
+        for (int op = 0; op < 3; op++) {
+            for (int64_t stride = 4; stride <= 65536; stride *= 2) {
+                for (int shuffled: {0, 1}) {
+                    b->Args({op, stride, huge, shuffled});
+                }
+            }
         }
-        // 保留结果可见性，避免被激进优化影响测试结论。
-        benchmark::DoNotOptimize(a);
     }
 }
-BENCHMARK(BM_skip128);
+BENCHMARK(BM_stride)->Apply(stride_args)->ArgNames({"op", "stride", "huge", "random"})
+    ->UseRealTime();
 
 /**
  * @brief Google Benchmark 入口。
@@ -0,0 +1,194 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <benchmark/benchmark.h>
+#include "aligned_buffer.h"
+
+/**
+ * @file main.cpp
+ * @brief 指针追逐（pointer chasing）访存延迟测试。
+ *
+ * 每个节点占一条缓存行，节点按随机的单环排列相连，每次加载的地址依赖上一次的结果，
+ * 硬件预取与乱序执行都无法重叠，测得的就是单次随机访存的延迟。
+ * 测试维度：
+ * 1. 工作集 4KB ~ 4GB（超过可用内存的规模跳过）
+ * 2. 4KB 页与 2MB 大页（hugetlb，不可用时退回透明大页 THP）
+ * 3. 是否有另一个线程在持续占用内存带宽
+ */
+
+/**
+ * @brief 链表节点，大小恰为一条缓存行，避免相邻节点共享缓存行。
+ */
+struct alignas(64) node {
+    node *next;
+};
+static_assert(sizeof(node) == 64, "node must fill one cache line");
+
+/**
+ * @brief 一次计时迭代内的加载次数。
+ */
+constexpr size_t loads_per_iter = size_t(1) << 20;
+
+/**
+ * @brief 指针追逐链：在 membuf::Buffer 上建立随机单环，大页时优先 MAP_HUGETLB，失败退回 THP。
+ *
+ * 先打乱节点顺序再首尾相连，得到覆盖全部节点的一个环（等价于 Sattolo 算法），
+ * 保证追逐过程不会落入小环而只访问部分工作集。
+ */
+struct chase_list {
+    size_t bytes;
+    bool huge;
+    membuf::Buffer<node> buf;
+    node *head = nullptr;
+
+    chase_list(size_t bytes_, bool huge_)
+        : bytes(bytes_), huge(huge_),
+          buf(bytes_ / sizeof(node), {huge_ ? membuf::Pages::kHugetlb : membuf::Pages::kSmall,
+                                      membuf::FirstTouch::kNone}) {
+        if (!buf.ok()) {
+            return;
+        }
+        const size_t count = buf.size();
+        node *nodes = buf.data();
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+        for (size_t i = 0; i < count; i++) {
+            nodes[order[i]].next = &nodes[order[(i + 1) % count]];
+        }
+        head = &nodes[order[0]];
+    }
+};
+
+/**
+ * @brief 当前链表缓存：基准按 (规模, 页大小) 顺序注册，同一链表被有无干扰两组复用，
+ * 只保留一份，避免多个 GB 级缓冲区同时驻留。
+ */
+chase_list *get_list(size_t bytes, bool huge) {
+    static std::unique_ptr<chase_list> current;
+    if (!current || current->bytes != bytes || current->huge != huge) {
+        current.reset();
+        current = std::make_unique<chase_list>(bytes, huge);
+    }
+    return current.get();
+}
+
+/**
+ * @brief 可用内存（/proc/meminfo 的 MemAvailable），读不到时返回 0 表示不限制。
+ */
+size_t mem_available() {
+    std::ifstream in("/proc/meminfo");
+    std::string key;
+    size_t kb;
+    std::string unit;
+    while (in >> key >> kb >> unit) {
+        if (key == "MemAvailable:") {
+            return kb << 10;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 带宽干扰线程：在独立的 256MB 缓冲区上循环做拷贝，持续占用内存带宽。
+ */
+class bandwidth_hog {
+public:
+    bandwidth_hog() : src_(n_), dst_(n_) {
+        src_.Fill(1.0f);
+        thread_ = std::thread([this] {
+            while (!stop_.load(std::memory_order_relaxed)) {
+                for (size_t i = 0; i < n_; i++) {
+                    dst_[i] = src_[i] * 1.0001f;
+                }
+                benchmark::DoNotOptimize(dst_.data());
+            }
+        });
+    }
+
+    ~bandwidth_hog() {
+        stop_.store(true);
+        thread_.join();
+    }
+
+private:
+    static constexpr size_t n_ = size_t(1) << 25;  // 每个数组 128MB
+    membuf::Buffer<float> src_, dst_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+/**
+ * @brief 指针追逐基准：参数为 (工作集字节数, 是否大页, 是否有带宽干扰)。
+ * @param bm Google Benchmark 状态对象。
+ *
+ * 计数器 latency 为每次加载的平均耗时（秒，输出带 n 后缀即纳秒）。
+ */
+void BM_pointer_chase(benchmark::State &bm) {
+    const size_t bytes = static_cast<size_t>(bm.range(0));
+    const bool huge = bm.range(1) != 0;
+    const bool hog = bm.range(2) != 0;
+    const size_t avail = mem_available();
+    if (avail != 0 && bytes + bytes / 16 > avail * 3 / 4) {
+        bm.SkipWithError("working set exceeds available memory");
+        return;
+    }
+    chase_list *list = get_list(bytes, huge);
+    if (!list->buf.ok()) {
+        bm.SkipWithError("mmap failed");
+        return;
+    }
+    std::unique_ptr<bandwidth_hog> h;
+    if (hog) {
+        h = std::make_unique<bandwidth_hog>();
+    }
+    node *p = list->head;
+    // 预热：走一遍完整的环（最多 loads_per_iter 步），把小工作集载入缓存、建立页表。
+    for (size_t i = 0; i < std::min(bytes / sizeof(node), loads_per_iter); i++) {
+        p = p->next;
+    }
+    for (auto _: bm) {
+        for (size_t i = 0; i < loads_per_iter; i++) {
+            p = p->next;
+        }
+        benchmark::DoNotOptimize(p);
+    }
+    bm.counters["latency"] = benchmark::Counter(
+        static_cast<double>(bm.iterations() * loads_per_iter),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    bm.counters["anon_huge_mb"] = static_cast<double>(membuf::AnonHugePagesKb() >> 10);
+    bm.SetLabel(std::string(list->buf.page_kind()) + (hog ? " +hog" : ""));
+}
+
+/**
+ * @brief 工作集 4KB, 16KB, ..., 4GB（每档 ×4），页大小与干扰两两组合。
+ */
+static void chase_args(benchmark::internal::Benchmark *b) {
+    for (int64_t bytes = int64_t(4) << 10; bytes <= int64_t(4) << 30; bytes *= 4) {
+        for (int huge: {0, 1}) {
+            for (int hog: {0, 1}) {
+                b->Args({bytes, huge, hog});
+            }
+        }
+    }
+}
+BENCHMARK(BM_pointer_chase)->Apply(chase_args)->ArgNames({"bytes", "huge", "hog"})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/**
+ * @brief Google Benchmark 入口。
+ *
+ * 自动生成 main 并运行所有注册的基准测试。
+ */
+BENCHMARK_MAIN();
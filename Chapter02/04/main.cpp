@@ -0,0 +1,244 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <array>
+#include <string>
+#include <algorithm>
+#include <sched.h>
+#include <benchmark/benchmark.h>
+#include <omp.h>
+#include "aligned_buffer.h"
+#include "numa_topology.h"
+
+/**
+ * @file main.cpp
+ * @brief NUMA 放置实验：同一组并行内核在不同内存放置策略下的带宽。
+ *
+ * 内核：fill（a[i] = 1）、add（a[i] = a[i] + 1）、func（a[i] = func(a[i])），
+ * 与 Chapter01 中的 BM_parallel_fill / BM_parallel_add / BM_parallel_func 相同。
+ * 放置策略：
+ * 1. local：并行首次触碰，页落在之后访问它的线程所在节点
+ * 2. interleave：按页在所有节点间轮转
+ * 3. single-node：全部绑定到第一个在线节点（等价于主线程串行初始化的效果）
+ * 计数器：node<k>_bw 为节点 k 上的线程实测的带宽（这些线程处理的字节 / 其中最慢线程的耗时，
+ * 每个线程在并行区内单独计时），node<k>_pages 为页落在节点 k 的比例，
+ * local_pct 为页与访问它的线程位于同一节点的比例（按采样页统计）。
+ * local 不调用 mbind；interleave / single-node 的 mbind 失败（内核不支持 NUMA、被 seccomp 拦截等）时
+ * 只跳过这两种放置策略的基准。
+ *
+ * 程序启动时若未设置 OMP_PROC_BIND / OMP_PLACES，会设为 spread / cores 后重新执行自身，
+ * 否则线程可能在节点间迁移，首次触碰的效果无从体现。
+ */
+
+/**
+ * @brief 测试规模（约 1GB 的 float 数组）。
+ */
+constexpr size_t n = 1<<28;
+
+/**
+ * @brief 用于基准测试的计算函数，与 Chapter01/compute 相同。
+ */
+static float func(float x) {
+    return x * (x * x + x * 3.14f - 1 / (x + 1)) + 42 / (2.718f - x);
+}
+
+/**
+ * @brief 内核描述：名称、每个元素读写的字节数。
+ */
+struct numa_kernel {
+    const char *name;
+    size_t bytes_per_elem;
+};
+
+const std::array<numa_kernel, 3> kernels = {{
+    {"fill", sizeof(float)},
+    {"add", 2 * sizeof(float)},
+    {"func", 2 * sizeof(float)},
+}};
+
+/**
+ * @brief 按放置策略分配的 1GB 缓冲区：先 mbind 再由全部线程并行首次触碰。
+ * @return mbind 失败时返回 nullptr（local 不调用 mbind，总是成功）。
+ *
+ * 同一时刻只保留一种放置的缓冲区，避免多份 1GB 同时驻留。
+ */
+membuf::Buffer<float> *buffer(numa::Placement placement) {
+    static membuf::Buffer<float> buf;
+    static int kind = -1;
+    static bool placed = false;
+    if (kind != static_cast<int>(placement)) {
+        buf = membuf::Buffer<float>();
+        buf = membuf::Buffer<float>(n, {membuf::Pages::kDefault, membuf::FirstTouch::kNone});
+        placed = numa::Place(buf.data(), n * sizeof(float), placement);
+        buf.Fill(1.0f);
+        kind = static_cast<int>(placement);
+    }
+    return placed ? &buf : nullptr;
+}
+
+/**
+ * @brief 一次执行中每个线程的耗时与所在节点。
+ */
+struct slice_times {
+    std::vector<double> seconds;
+    std::vector<int> nodes;
+};
+
+/**
+ * @brief 执行一次内核，调度与 Fill 一致（静态调度）；每个线程单独计时自己那一段，
+ * 并记录结束时所在的节点，结果写入 out。
+ */
+void run_kernel(int k, float *a, int threads, slice_times *out) {
+    out->seconds.assign(threads, 0.0);
+    out->nodes.assign(threads, numa::Nodes().front().id);
+#pragma omp parallel num_threads(threads)
+    {
+        const double t0 = omp_get_wtime();
+        switch (k) {
+        case 0:
+#pragma omp for schedule(static) nowait
+            for (size_t i = 0; i < n; i++) {
+                a[i] = 1;
+            }
+            break;
+        case 1:
+#pragma omp for schedule(static) nowait
+            for (size_t i = 0; i < n; i++) {
+                a[i] = a[i] + 1;
+            }
+            break;
+        default:
+#pragma omp for schedule(static) nowait
+            for (size_t i = 0; i < n; i++) {
+                a[i] = func(a[i]);
+            }
+            break;
+        }
+        const int t = omp_get_thread_num();
+        out->seconds[t] = omp_get_wtime() - t0;
+        out->nodes[t] = numa::NodeOfCpu(sched_getcpu());
+    }
+    // 防止编译器将写入优化掉，保证基准有效性。
+    benchmark::ClobberMemory();
+}
+
+/**
+ * @brief 静态调度下处理第 i 个元素的线程：前 n % threads 个线程各多分一个元素。
+ */
+int owner_thread(size_t i, int threads) {
+    const size_t q = n / threads;
+    const size_t r = n % threads;
+    return static_cast<int>(i < r * (q + 1) ? i / (q + 1) : r + (i - r * (q + 1)) / q);
+}
+
+/**
+ * @brief NUMA 放置基准：参数为 (放置策略, 线程数)。
+ * @param bm Google Benchmark 状态对象。
+ * @param k 内核下标。
+ */
+void BM_numa(benchmark::State &bm, int k) {
+    const auto placement = static_cast<numa::Placement>(bm.range(0));
+    const int threads = static_cast<int>(bm.range(1));
+    membuf::Buffer<float> *buf = buffer(placement);
+    if (!buf) {
+        bm.SkipWithError((std::string("mbind failed for placement ") +
+                          numa::PlacementName(placement)).c_str());
+        return;
+    }
+    float *a = buf->data();
+    const auto &nodes = numa::Nodes();
+    slice_times times;
+    run_kernel(k, a, threads, &times);
+    // 每个节点：累计这些线程处理的字节，以及每次执行中其中最慢线程的耗时。
+    std::vector<double> node_bytes(nodes.size()), node_seconds(nodes.size());
+    for (auto _: bm) {
+        run_kernel(k, a, threads, &times);
+        std::vector<double> slowest(nodes.size());
+        for (int t = 0; t < threads; t++) {
+            for (size_t j = 0; j < nodes.size(); j++) {
+                if (nodes[j].id == times.nodes[t]) {
+                    const size_t elems = n / threads + (static_cast<size_t>(t) < n % threads ? 1 : 0);
+                    node_bytes[j] += static_cast<double>(elems * kernels[k].bytes_per_elem);
+                    slowest[j] = std::max(slowest[j], times.seconds[t]);
+                }
+            }
+        }
+        for (size_t j = 0; j < nodes.size(); j++) {
+            node_seconds[j] += slowest[j];
+        }
+    }
+    const size_t bytes = n * kernels[k].bytes_per_elem;
+    bm.SetBytesProcessed(bm.iterations() * bytes);
+    for (size_t j = 0; j < nodes.size(); j++) {
+        bm.counters["node" + std::to_string(nodes[j].id) + "_bw"] = benchmark::Counter(
+            node_seconds[j] > 0 ? node_bytes[j] / node_seconds[j] : 0.0,
+            benchmark::Counter::kDefaults, benchmark::Counter::OneK::kIs1024);
+    }
+    const std::vector<int> &thread_nodes = times.nodes;
+
+    // 采样页的分布，以及与访问线程同节点的比例。
+    const std::vector<int> page_nodes = numa::PageNodes(a, n * sizeof(float));
+    std::vector<size_t> on_node(nodes.size());
+    size_t local = 0, known = 0;
+    for (size_t s = 0; s < page_nodes.size(); s++) {
+        if (page_nodes[s] < 0) {
+            continue;
+        }
+        known++;
+        for (size_t j = 0; j < nodes.size(); j++) {
+            if (nodes[j].id == page_nodes[s]) {
+                on_node[j]++;
+            }
+        }
+        const size_t i = s * n / page_nodes.size();
+        if (thread_nodes[owner_thread(i, threads)] == page_nodes[s]) {
+            local++;
+        }
+    }
+    for (size_t j = 0; j < nodes.size(); j++) {
+        bm.counters["node" + std::to_string(nodes[j].id) + "_pages"] =
+            known ? 100.0 * on_node[j] / known : 0.0;
+    }
+    bm.counters["local_pct"] = known ? 100.0 * local / known : 0.0;
+    bm.SetLabel(numa::PlacementName(placement));
+}
+
+/**
+ * @brief 程序入口：确保线程绑定后手动注册基准，并把节点拓扑与绑定方式写入输出的上下文。
+ */
+int main(int argc, char **argv) {
+    numa::RequireOmpPinning(argv);
+    for (const auto &node: numa::Nodes()) {
+        benchmark::AddCustomContext("node" + std::to_string(node.id),
+                                    std::to_string(node.cpus.size()) + " cpus");
+    }
+    const char *bind = std::getenv("OMP_PROC_BIND");
+    const char *places = std::getenv("OMP_PLACES");
+    benchmark::AddCustomContext("OMP_PROC_BIND", bind ? bind : "(unset)");
+    benchmark::AddCustomContext("OMP_PLACES", places ? places : "(unset)");
+
+    std::vector<int> threads = {1};
+    if (omp_get_max_threads() > 1) {
+        threads.push_back(omp_get_max_threads());
+    }
+    // 按放置策略在外层循环注册，同一缓冲区被各内核连续复用，只需分配三次。
+    for (int p = 0; p < 3; p++) {
+        for (int k = 0; k < static_cast<int>(kernels.size()); k++) {
+            const std::string name = std::string("BM_numa_") + kernels[k].name;
+            auto *b = benchmark::RegisterBenchmark(name.c_str(), BM_numa, k);
+            for (int t: threads) {
+                b->Args({p, t});
+            }
+            b->ArgNames({"placement", "threads"})->UseRealTime();
+        }
+    }
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
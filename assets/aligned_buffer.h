@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <type_traits>
+#include <utility>
+
+// 基准用的大数组：
+// - 直接 mmap 匿名内存，不做值初始化（内核保证缺页时清零），构造几乎不花时间；
+// - 64B 对齐，使用大页时 2MB 对齐；
+// - 可选 MAP_HUGETLB（失败时退回透明大页）或 madvise 指定 THP / 4KB 页；
+// - 可选首次触碰方式：并行触碰与 `#pragma omp parallel for` 的默认静态调度一致，
+//   每个线程先碰自己之后要处理的那一段，页就分配在该线程所在的 NUMA 节点上。
+
+namespace membuf {
+
+enum class Pages : int {
+    kDefault = 0,  // 不干预，按系统 THP 策略
+    kSmall,        // MADV_NOHUGEPAGE，强制 4KB 页
+    kHuge,         // MADV_HUGEPAGE，透明大页
+    kHugetlb,      // MAP_HUGETLB（需预留大页），失败时退回 kHuge
+};
+
+enum class FirstTouch : int {
+    kNone = 0,  // 不触碰，第一次访问时才缺页
+    kSerial,    // 构造时由当前线程触碰
+    kParallel,  // 构造时按 OpenMP 静态调度并行触碰
+};
+
+struct Options {
+    Pages pages = Pages::kDefault;
+    FirstTouch touch = FirstTouch::kParallel;
+    std::size_t align = 64;  // 大页时自动提升到 2MB
+};
+
+constexpr std::size_t kHugePageSize = std::size_t(2) << 20;
+
+// 进程中透明大页的总量（/proc/self/smaps_rollup 的 AnonHugePages），单位 KB。
+inline std::size_t AnonHugePagesKb() {
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string s;
+    while (std::getline(in, s)) {
+        if (s.rfind("AnonHugePages:", 0) == 0) {
+            return std::strtoull(s.c_str() + 14, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+template <typename T>
+class Buffer {
+    static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                  "Buffer holds raw memory and never runs constructors or destructors");
+
+public:
+    Buffer() = default;
+
+    explicit Buffer(std::size_t n, Options opt = {}) : size_(n) {
+        if (n == 0) {
+            return;
+        }
+        const bool huge = opt.pages == Pages::kHuge || opt.pages == Pages::kHugetlb;
+        std::size_t align = opt.align < alignof(T) ? alignof(T) : opt.align;
+        if (huge && align < kHugePageSize) {
+            align = kHugePageSize;
+        }
+        bytes_ = (n * sizeof(T) + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+
+        if (opt.pages == Pages::kHugetlb) {
+            void *p = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<T *>(p);
+                kind_ = "2M hugetlb";
+            }
+        }
+        if (!data_) {
+            // 多映射 align 字节，对齐后把首尾多余部分还给内核。
+            const std::size_t map_bytes = bytes_ + align;
+            void *raw = mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw == MAP_FAILED) {
+                size_ = bytes_ = 0;
+                failed_ = true;
+                return;
+            }
+            const auto begin = reinterpret_cast<std::uintptr_t>(raw);
+            const auto aligned = (begin + align - 1) & ~(std::uintptr_t(align) - 1);
+            if (aligned > begin) {
+                munmap(raw, aligned - begin);
+            }
+            const std::size_t tail = begin + map_bytes - (aligned + bytes_);
+            if (tail > 0) {
+                munmap(reinterpret_cast<void *>(aligned + bytes_), tail);
+            }
+            data_ = reinterpret_cast<T *>(aligned);
+            if (huge) {
+                madvise(data_, bytes_, MADV_HUGEPAGE);
+                kind_ = "2M thp";
+            } else if (opt.pages == Pages::kSmall) {
+                madvise(data_, bytes_, MADV_NOHUGEPAGE);
+                kind_ = "4K";
+            } else {
+                kind_ = "default";
+            }
+        }
+
+        if (opt.touch == FirstTouch::kParallel) {
+            Fill(T{});
+        } else if (opt.touch == FirstTouch::kSerial) {
+            for (std::size_t i = 0; i < size_; i++) {
+                data_[i] = T{};
+            }
+        }
+    }
+
+    ~Buffer() { Release(); }
+
+    Buffer(Buffer &&o) noexcept { *this = std::move(o); }
+
+    Buffer &operator=(Buffer &&o) noexcept {
+        if (this != &o) {
+            Release();
+            data_ = std::exchange(o.data_, nullptr);
+            size_ = std::exchange(o.size_, 0);
+            bytes_ = std::exchange(o.bytes_, 0);
+            kind_ = std::exchange(o.kind_, "");
+            failed_ = std::exchange(o.failed_, false);
+        }
+        return *this;
+    }
+
+    Buffer(const Buffer &) = delete;
+    Buffer &operator=(const Buffer &) = delete;
+
+    // 与 `#pragma omp parallel for` 相同的静态调度并行写入。
+    void Fill(const T &v) {
+        T *p = data_;
+        const std::size_t n = size_;
+#pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < n; i++) {
+            p[i] = v;
+        }
+    }
+
+    // 分配失败时为 false；只有请求 0 个元素的空缓冲区才会在 data() 为空时视为成功。
+    bool ok() const noexcept { return !failed_; }
+    std::size_t size() const noexcept { return size_; }
+    T *data() noexcept { return data_; }
+    const T *data() const noexcept { return data_; }
+    T *begin() noexcept { return data_; }
+    T *end() noexcept { return data_ + size_; }
+    const T *begin() const noexcept { return data_; }
+    const T *end() const noexcept { return data_ + size_; }
+    T &operator[](std::size_t i) noexcept { return data_[i]; }
+    const T &operator[](std::size_t i) const noexcept { return data_[i]; }
+
+    // 实际使用的页类型："default" / "4K" / "2M thp" / "2M hugetlb"。
+    const char *page_kind() const noexcept { return kind_; }
+
+private:
+    void Release() noexcept {
+        if (data_) {
+            munmap(data_, bytes_);
+        }
+        data_ = nullptr;
+        size_ = bytes_ = 0;
+        failed_ = false;
+    }
+
+    T *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t bytes_ = 0;
+    const char *kind_ = "";
+    bool failed_ = false;
+};
+
+}  // namespace membuf
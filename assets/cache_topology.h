@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// 读取 CPU 缓存拓扑：优先解析 /sys/devices/system/cpu/cpu0/cache/index*，
+// 取不到时退回 sysconf。只关心数据缓存（Data/Unified），指令缓存被过滤掉。
+
+namespace cache_topology {
+
+struct CacheLevel {
+    int level = 0;
+    std::string type;             // "Data" / "Unified"
+    std::size_t size_bytes = 0;
+    int shared_cpus = 1;          // 共享该缓存的逻辑 CPU 数
+};
+
+namespace detail {
+
+inline bool ReadLine(const std::string &path, std::string *out) {
+    std::ifstream in(path);
+    return static_cast<bool>(std::getline(in, *out));
+}
+
+// "48K" / "2048K" / "300M" -> 字节数。
+inline std::size_t ParseSize(const std::string &s) {
+    std::size_t pos = 0;
+    std::size_t v = 0;
+    while (pos < s.size() && s[pos] >= '0' && s[pos] <= '9') {
+        v = v * 10 + static_cast<std::size_t>(s[pos++] - '0');
+    }
+    if (pos < s.size()) {
+        switch (s[pos]) {
+        case 'K': v <<= 10; break;
+        case 'M': v <<= 20; break;
+        case 'G': v <<= 30; break;
+        default: break;
+        }
+    }
+    return v;
+}
+
+// "0-3,8-11" -> 8。
+inline int CountCpuList(const std::string &s) {
+    int count = 0;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        const std::size_t dash = part.find('-');
+        if (dash == std::string::npos) {
+            count += part.empty() ? 0 : 1;
+        } else {
+            count += std::stoi(part.substr(dash + 1)) - std::stoi(part.substr(0, dash)) + 1;
+        }
+    }
+    return count > 0 ? count : 1;
+}
+
+inline std::vector<CacheLevel> FromSysfs() {
+    std::vector<CacheLevel> out;
+    for (int i = 0;; i++) {
+        const std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(i) + "/";
+        std::string level, type, size, shared;
+        if (!ReadLine(dir + "level", &level) || !ReadLine(dir + "type", &type) ||
+            !ReadLine(dir + "size", &size)) {
+            break;
+        }
+        if (type == "Instruction") {
+            continue;
+        }
+        CacheLevel c;
+        c.level = std::stoi(level);
+        c.type = type;
+        c.size_bytes = ParseSize(size);
+        c.shared_cpus = ReadLine(dir + "shared_cpu_list", &shared) ? CountCpuList(shared) : 1;
+        if (c.size_bytes > 0) {
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+inline std::vector<CacheLevel> FromSysconf() {
+    std::vector<CacheLevel> out;
+    const int names[] = {_SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL2_CACHE_SIZE, _SC_LEVEL3_CACHE_SIZE};
+    for (int i = 0; i < 3; i++) {
+        const long size = sysconf(names[i]);
+        if (size > 0) {
+            CacheLevel c;
+            c.level = i + 1;
+            c.type = i == 0 ? "Data" : "Unified";
+            c.size_bytes = static_cast<std::size_t>(size);
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+}  // namespace detail
+
+// 按层级从小到大返回数据缓存；两种来源都失败时返回空。
+inline std::vector<CacheLevel> DataCaches() {
+    std::vector<CacheLevel> caches = detail::FromSysfs();
+    if (caches.empty()) {
+        caches = detail::FromSysconf();
+    }
+    std::sort(caches.begin(), caches.end(),
+              [](const CacheLevel &x, const CacheLevel &y) { return x.level < y.level; });
+    return caches;
+}
+
+}  // namespace cache_topology
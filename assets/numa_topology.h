@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+#include <omp.h>
+
+// NUMA 拓扑与内存放置：
+// - 节点与 CPU 对应关系读自 /sys/devices/system/node/node*/cpulist，取不到时视为单节点；
+// - mbind / move_pages 直接走系统调用，不依赖 libnuma；
+// - OpenMP 线程绑定只能在运行时初始化前通过 OMP_PROC_BIND / OMP_PLACES 指定，
+//   RequireOmpPinning 在环境变量未设置时补上并重新 exec 自身。
+
+namespace numa {
+
+struct Node {
+    int id = 0;
+    std::vector<int> cpus;
+};
+
+enum class Placement : int {
+    kLocal = 0,   // 默认策略：页落在首次触碰它的线程所在节点
+    kInterleave,  // MPOL_INTERLEAVE：按页在所有节点间轮转
+    kSingleNode,  // MPOL_BIND：全部放在一个节点上
+};
+
+inline const char *PlacementName(Placement p) {
+    switch (p) {
+    case Placement::kLocal: return "local";
+    case Placement::kInterleave: return "interleave";
+    case Placement::kSingleNode: return "single-node";
+    }
+    return "?";
+}
+
+namespace detail {
+
+// "0-3,8-11" -> {0, 1, 2, 3, 8, 9, 10, 11}。
+inline std::vector<int> ParseCpuList(const std::string &s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        if (part.empty()) {
+            continue;
+        }
+        const std::size_t dash = part.find('-');
+        const int lo = std::stoi(part.substr(0, dash));
+        const int hi = dash == std::string::npos ? lo : std::stoi(part.substr(dash + 1));
+        for (int c = lo; c <= hi; c++) {
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+inline std::vector<Node> FromSysfs() {
+    std::vector<Node> out;
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string list;
+    if (!std::getline(online, list)) {
+        return out;
+    }
+    for (int id: ParseCpuList(list)) {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+        std::string cpus;
+        Node node;
+        node.id = id;
+        if (std::getline(in, cpus)) {
+            node.cpus = ParseCpuList(cpus);
+        }
+        out.push_back(node);
+    }
+    return out;
+}
+
+constexpr int kMaskWords = 16;  // 最多 1024 个节点
+
+}  // namespace detail
+
+// 在线节点列表（可能包含没有 CPU 的纯内存节点）；sysfs 不可用时返回包含全部 CPU 的单节点。
+inline const std::vector<Node> &Nodes() {
+    static const std::vector<Node> nodes = [] {
+        std::vector<Node> n = detail::FromSysfs();
+        if (n.empty()) {
+            Node all;
+            const long cpus = sysconf(_SC_NPROCESSORS_CONF);
+            for (long c = 0; c < cpus; c++) {
+                all.cpus.push_back(static_cast<int>(c));
+            }
+            n.push_back(all);
+        }
+        return n;
+    }();
+    return nodes;
+}
+
+inline int NodeOfCpu(int cpu) {
+    for (const Node &n: Nodes()) {
+        for (int c: n.cpus) {
+            if (c == cpu) {
+                return n.id;
+            }
+        }
+    }
+    return Nodes().front().id;
+}
+
+// 为 [p, p + bytes) 设置放置策略，必须在首次触碰之前调用；p 需按页对齐。
+// kSingleNode 绑定到 node（小于 0 时取第一个在线节点，节点 0 不一定在线）；
+// kLocal 即新映射的默认策略，不调用 mbind，因此在 mbind 被禁用的容器里也总是成功。
+// 成功返回 true。
+inline bool Place(void *p, std::size_t bytes, Placement placement, int node = -1) {
+    if (placement == Placement::kLocal) {
+        return true;
+    }
+    if (node < 0) {
+        node = Nodes().front().id;
+    }
+    unsigned long mask[detail::kMaskWords] = {};
+    int mode = MPOL_BIND;
+    if (placement == Placement::kInterleave) {
+        mode = MPOL_INTERLEAVE;
+        for (const Node &n: Nodes()) {
+            mask[n.id / 64] |= 1UL << (n.id % 64);
+        }
+    } else {
+        mask[node / 64] |= 1UL << (node % 64);
+    }
+    return syscall(SYS_mbind, p, bytes, mode, mask, detail::kMaskWords * 64 + 1, 0) == 0;
+}
+
+// 用 move_pages 查询页所在节点：从 [p, p + bytes) 中均匀取至多 samples 页，
+// 返回每个样本页的节点号，尚未分配或查询失败的页记为 -1。
+inline std::vector<int> PageNodes(const void *p, std::size_t bytes, std::size_t samples = 4096) {
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t pages = bytes / page;
+    if (pages == 0 || samples == 0) {
+        return {};
+    }
+    if (samples > pages) {
+        samples = pages;
+    }
+    const auto base = reinterpret_cast<std::uintptr_t>(p) & ~(std::uintptr_t(page) - 1);
+    std::vector<void *> addrs(samples);
+    for (std::size_t i = 0; i < samples; i++) {
+        addrs[i] = reinterpret_cast<void *>(base + i * pages / samples * page);
+    }
+    std::vector<int> status(samples, -1);
+    if (syscall(SYS_move_pages, 0, samples, addrs.data(), nullptr, status.data(), 0) != 0) {
+        return std::vector<int>(samples, -1);
+    }
+    for (int &s: status) {
+        if (s < 0) {
+            s = -1;
+        }
+    }
+    return status;
+}
+
+// 当前 OpenMP 线程组中每个线程所在的节点（按 sched_getcpu 采样，线程未绑定时只是快照）。
+inline std::vector<int> ThreadNodes(int threads) {
+    std::vector<int> out(threads, Nodes().front().id);
+#pragma omp parallel num_threads(threads)
+    {
+        out[omp_get_thread_num()] = NodeOfCpu(sched_getcpu());
+    }
+    return out;
+}
+
+// 若 OMP_PROC_BIND 与 OMP_PLACES 都未设置，设为 spread / cores 后重新 exec 本程序，
+// 使线程固定在核上、首次触碰的页与之后访问它的线程处于同一节点。
+// 必须在任何 OpenMP 调用之前、main 开头调用；exec 失败时按原样继续运行。
+inline void RequireOmpPinning(char **argv) {
+    if (std::getenv("OMP_PROC_BIND") || std::getenv("OMP_PLACES")) {
+        return;
+    }
+    setenv("OMP_PROC_BIND", "spread", 0);
+    setenv("OMP_PLACES", "cores", 0);
+    execv("/proc/self/exe", argv);
+}
+
+}  // namespace numa
@@ -0,0 +1,378 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <execution>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <omp.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+// 与运行时无关的 parallel_for / parallel_reduce：
+// - 循环体按区间调用 body(begin, end)，内层循环仍可被编译器向量化；
+// - 后端：串行、OpenMP（静态调度，与 `#pragma omp parallel for` 的划分相同）、
+//   TBB（auto_partitioner）、C++17 std::execution::par_unseq（libstdc++ 下由 TBB 执行）、
+//   自带的工作窃取线程池；
+// - grain 为区间拆分的下限，传 0 时取 n / (线程数 * 8)，且不小于 kMinGrain。
+// 使用者需链接 OpenMP 与 TBB。
+
+namespace par {
+
+enum class Backend : int {
+    kSerial = 0,
+    kOpenMP,
+    kTBB,
+    kStdPar,
+    kPool,
+};
+
+constexpr int kBackendCount = 5;
+constexpr std::size_t kMinGrain = 1024;
+
+inline const char *BackendName(Backend b) {
+    switch (b) {
+    case Backend::kSerial: return "serial";
+    case Backend::kOpenMP: return "openmp";
+    case Backend::kTBB: return "tbb";
+    case Backend::kStdPar: return "par_unseq";
+    case Backend::kPool: return "pool";
+    }
+    return "?";
+}
+
+// 工作窃取线程池：每个线程一个双端队列，自己从尾部取、空闲时从别人头部偷。
+// 取到的区间大于 grain 时先把后一半放回自己的队列再处理前一半（惰性拆分），
+// 因此偷到的总是最大的那块。调用线程作为 0 号线程参与计算。
+// 同一时刻只允许一个线程调用 For，不支持嵌套。
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads) {
+        if (threads < 1) {
+            threads = 1;
+        }
+        for (int i = 0; i < threads; i++) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (int i = 1; i < threads; i++) {
+            threads_.emplace_back([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &t: threads_) {
+            t.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    int size() const { return static_cast<int>(queues_.size()); }
+
+    template <typename F>
+    void For(std::size_t n, std::size_t grain, F &body) {
+        Run(n, grain, [](void *ctx, std::size_t b, std::size_t e) { (*static_cast<F *>(ctx))(b, e); },
+            const_cast<void *>(static_cast<const void *>(&body)));
+    }
+
+private:
+    using Task = void (*)(void *, std::size_t, std::size_t);
+
+    struct Range {
+        std::size_t begin, end;
+    };
+
+    struct alignas(64) Queue {
+        std::mutex m;
+        std::deque<Range> q;
+    };
+
+    // 新任务到来前先自旋这么多轮（每轮让出一次 CPU），之后才睡眠，减少小任务的唤醒延迟。
+    static constexpr int kSpin = 1 << 10;
+
+    void Run(std::size_t n, std::size_t grain, Task fn, void *ctx) {
+        if (n == 0) {
+            return;
+        }
+        if (size() == 1 || n <= grain) {
+            fn(ctx, 0, n);
+            return;
+        }
+        fn_ = fn;
+        ctx_ = ctx;
+        grain_ = grain;
+        pending_.store(n);
+        const std::size_t t = queues_.size();
+        for (std::size_t w = 0; w < t; w++) {
+            const Range r{n * w / t, n * (w + 1) / t};
+            if (r.begin < r.end) {
+                std::lock_guard<std::mutex> lk(queues_[w]->m);
+                queues_[w]->q.push_back(r);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            epoch_.fetch_add(1);
+        }
+        cv_.notify_all();
+        Work(0);
+        // 等其他线程都离开 Work，ctx 才能随调用者的栈帧失效。
+        while (busy_.load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    void WorkerLoop(int id) {
+        unsigned long seen = 0;
+        for (;;) {
+            for (int i = 0; i < kSpin && epoch_.load() == seen; i++) {
+                std::this_thread::yield();
+            }
+            if (epoch_.load() == seen) {
+                std::unique_lock<std::mutex> lk(m_);
+                cv_.wait(lk, [&] { return stop_ || epoch_.load() != seen; });
+                if (stop_) {
+                    return;
+                }
+            }
+            seen = epoch_.load();
+            Work(id);
+        }
+    }
+
+    void Work(int id) {
+        busy_.fetch_add(1);
+        Range r;
+        while (pending_.load() != 0) {
+            if (!Pop(id, &r) && !Steal(id, &r)) {
+                std::this_thread::yield();
+                continue;
+            }
+            while (r.end - r.begin > grain_) {
+                const std::size_t mid = r.begin + (r.end - r.begin) / 2;
+                {
+                    std::lock_guard<std::mutex> lk(queues_[id]->m);
+                    queues_[id]->q.push_back({mid, r.end});
+                }
+                r.end = mid;
+            }
+            fn_(ctx_, r.begin, r.end);
+            pending_.fetch_sub(r.end - r.begin);
+        }
+        busy_.fetch_sub(1);
+    }
+
+    bool Pop(int id, Range *r) {
+        Queue &q = *queues_[id];
+        std::lock_guard<std::mutex> lk(q.m);
+        if (q.q.empty()) {
+            return false;
+        }
+        *r = q.q.back();
+        q.q.pop_back();
+        return true;
+    }
+
+    bool Steal(int id, Range *r) {
+        const int t = size();
+        for (int k = 1; k < t; k++) {
+            Queue &q = *queues_[(id + k) % t];
+            std::lock_guard<std::mutex> lk(q.m);
+            if (!q.q.empty()) {
+                *r = q.q.front();
+                q.q.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::atomic<unsigned long> epoch_{0};
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<int> busy_{0};
+    Task fn_ = nullptr;
+    void *ctx_ = nullptr;
+    std::size_t grain_ = 0;
+};
+
+// 进程内共享的线程池，线程数与 OpenMP 默认线程数一致，首次使用时创建。
+inline WorkStealingPool &Pool() {
+    static WorkStealingPool pool(omp_get_max_threads());
+    return pool;
+}
+
+namespace detail {
+
+// 给 std::for_each / std::transform_reduce 用的整数迭代器，避免为下标单独分配数组。
+class IndexIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::size_t *;
+    using reference = std::size_t;
+
+    IndexIterator() = default;
+    explicit IndexIterator(std::size_t i) : i_(i) {}
+
+    std::size_t operator*() const { return i_; }
+    std::size_t operator[](difference_type d) const { return i_ + d; }
+    IndexIterator &operator++() { ++i_; return *this; }
+    IndexIterator operator++(int) { IndexIterator t = *this; ++i_; return t; }
+    IndexIterator &operator--() { --i_; return *this; }
+    IndexIterator operator--(int) { IndexIterator t = *this; --i_; return t; }
+    IndexIterator &operator+=(difference_type d) { i_ += d; return *this; }
+    IndexIterator &operator-=(difference_type d) { i_ -= d; return *this; }
+    friend IndexIterator operator+(IndexIterator it, difference_type d) { return it += d; }
+    friend IndexIterator operator+(difference_type d, IndexIterator it) { return it += d; }
+    friend IndexIterator operator-(IndexIterator it, difference_type d) { return it -= d; }
+    friend difference_type operator-(IndexIterator a, IndexIterator b) {
+        return static_cast<difference_type>(a.i_) - static_cast<difference_type>(b.i_);
+    }
+    friend bool operator==(IndexIterator a, IndexIterator b) { return a.i_ == b.i_; }
+    friend bool operator!=(IndexIterator a, IndexIterator b) { return a.i_ != b.i_; }
+    friend bool operator<(IndexIterator a, IndexIterator b) { return a.i_ < b.i_; }
+    friend bool operator>(IndexIterator a, IndexIterator b) { return a.i_ > b.i_; }
+    friend bool operator<=(IndexIterator a, IndexIterator b) { return a.i_ <= b.i_; }
+    friend bool operator>=(IndexIterator a, IndexIterator b) { return a.i_ >= b.i_; }
+
+private:
+    std::size_t i_ = 0;
+};
+
+inline std::size_t Grain(std::size_t n, std::size_t grain) {
+    if (grain != 0) {
+        return grain;
+    }
+    const std::size_t g = n / (static_cast<std::size_t>(omp_get_max_threads()) * 8);
+    return g < kMinGrain ? kMinGrain : g;
+}
+
+// OpenMP 静态调度下第 t 个线程负责的区间：前 n % threads 个线程各多一个元素。
+inline void StaticRange(std::size_t n, int t, int threads, std::size_t *b, std::size_t *e) {
+    const std::size_t q = n / threads;
+    const std::size_t r = n % threads;
+    const std::size_t ut = static_cast<std::size_t>(t);
+    *b = ut * q + (ut < r ? ut : r);
+    *e = *b + q + (ut < r ? 1 : 0);
+}
+
+}  // namespace detail
+
+// 对 [0, n) 并行执行 body(begin, end)，各区间互不重叠且覆盖全部下标。
+template <typename F>
+void ParallelFor(Backend backend, std::size_t n, F &&body, std::size_t grain = 0) {
+    if (n == 0) {
+        return;
+    }
+    grain = detail::Grain(n, grain);
+    switch (backend) {
+    case Backend::kSerial:
+        body(std::size_t(0), n);
+        break;
+    case Backend::kOpenMP:
+#pragma omp parallel
+        {
+            std::size_t b, e;
+            detail::StaticRange(n, omp_get_thread_num(), omp_get_num_threads(), &b, &e);
+            if (b < e) {
+                body(b, e);
+            }
+        }
+        break;
+    case Backend::kTBB:
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, n, grain),
+                          [&](const tbb::blocked_range<std::size_t> &r) { body(r.begin(), r.end()); });
+        break;
+    case Backend::kStdPar: {
+        const std::size_t chunks = (n + grain - 1) / grain;
+        std::for_each(std::execution::par_unseq, detail::IndexIterator(0), detail::IndexIterator(chunks),
+                      [&](std::size_t c) { body(c * grain, std::min(n, (c + 1) * grain)); });
+        break;
+    }
+    case Backend::kPool:
+        Pool().For(n, grain, body);
+        break;
+    }
+}
+
+// 对 [0, n) 并行归约：body(begin, end, acc) 返回把区间累加进 acc 后的值，
+// combine 合并两个部分结果，identity 为单位元（各区间从它开始累加）。
+template <typename T, typename F, typename C>
+T ParallelReduce(Backend backend, std::size_t n, T identity, F &&body, C &&combine, std::size_t grain = 0) {
+    if (n == 0) {
+        return identity;
+    }
+    grain = detail::Grain(n, grain);
+    switch (backend) {
+    case Backend::kSerial:
+        return body(std::size_t(0), n, identity);
+    case Backend::kOpenMP: {
+        // 未参与的线程槽位保持单位元，合并时不影响结果。
+        std::vector<T> partial(omp_get_max_threads(), identity);
+#pragma omp parallel
+        {
+            const int t = omp_get_thread_num();
+            std::size_t b, e;
+            detail::StaticRange(n, t, omp_get_num_threads(), &b, &e);
+            if (b < e) {
+                partial[t] = body(b, e, identity);
+            }
+        }
+        T acc = identity;
+        for (const T &p: partial) {
+            acc = combine(acc, p);
+        }
+        return acc;
+    }
+    case Backend::kTBB:
+        return tbb::parallel_reduce(
+            tbb::blocked_range<std::size_t>(0, n, grain), identity,
+            [&](const tbb::blocked_range<std::size_t> &r, T acc) { return body(r.begin(), r.end(), acc); },
+            combine);
+    case Backend::kStdPar: {
+        const std::size_t chunks = (n + grain - 1) / grain;
+        return std::transform_reduce(std::execution::par_unseq, detail::IndexIterator(0),
+                                     detail::IndexIterator(chunks), identity, combine, [&](std::size_t c) {
+                                         return body(c * grain, std::min(n, (c + 1) * grain), identity);
+                                     });
+    }
+    case Backend::kPool: {
+        // 每块的部分结果写到各自的槽位，结束后按块顺序合并，结果与调度无关。
+        const std::size_t chunks = (n + grain - 1) / grain;
+        std::vector<T> partial(chunks, identity);
+        auto chunk_body = [&](std::size_t cb, std::size_t ce) {
+            for (std::size_t c = cb; c < ce; c++) {
+                partial[c] = body(c * grain, std::min(n, (c + 1) * grain), identity);
+            }
+        };
+        Pool().For(chunks, 1, chunk_body);
+        T acc = identity;
+        for (const T &p: partial) {
+            acc = combine(acc, p);
+        }
+        return acc;
+    }
+    }
+    return identity;
+}
+
+}  // namespace par
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "parallel_backend.h"
+
+// 并行后端对比基准共用的参数组合，配合 ->Apply(...) / ->ArgsProduct(...) 使用。
+
+namespace par {
+
+// 规模档位：1K ~ 64M 个元素（每档 ×16）。小规模下耗时主要是调度开销，大规模下受带宽或计算限制。
+constexpr std::int64_t kMinBenchElems = std::int64_t(1) << 10;
+constexpr std::int64_t kMaxBenchElems = std::int64_t(1) << 26;
+
+// (后端, 元素个数)：每个后端各测全部规模档位。
+inline void BackendSizeArgs(benchmark::internal::Benchmark *b) {
+    for (int backend = 0; backend < kBackendCount; backend++) {
+        for (std::int64_t m = kMinBenchElems; m <= kMaxBenchElems; m *= 16) {
+            b->Args({backend, m});
+        }
+    }
+    b->ArgNames({"backend", "n"});
+}
+
+// 全部后端的编号，供 ArgsProduct 作为其中一维。
+inline std::vector<std::int64_t> Backends() {
+    std::vector<std::int64_t> out;
+    for (int backend = 0; backend < kBackendCount; backend++) {
+        out.push_back(backend);
+    }
+    return out;
+}
+
+}  // namespace par
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include "parallel_backend.h"
+
+// 逐元素算子链的融合执行：
+// 逐个算子扫整个数组时，大数组每一步都要从内存读一遍、写一遍；
+// 按 L2 大小分块后，每块在缓存里依次经过全部算子再写回，整条链只访存一次（时间分块）。
+
+namespace pipeline {
+
+// 块算子：对 p[0..m) 原地变换。
+using BlockOp = std::function<void(float *, std::size_t)>;
+
+// 把逐元素函数包装成块算子，f 内联进循环后可被编译器向量化。
+template <typename F>
+BlockOp Map(F f) {
+    return [f](float *p, std::size_t m) {
+        for (std::size_t i = 0; i < m; i++) {
+            p[i] = f(p[i]);
+        }
+    };
+}
+
+// 默认块大小（元素数）：L2 的一半，另一半留给其它数据；取不到 L2 大小时按 256KB 算。
+inline std::size_t DefaultBlockElems() {
+    static const std::size_t elems = [] {
+        long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        std::size_t bytes = l2 > 0 ? static_cast<std::size_t>(l2) / 2 : 256 * 1024;
+        return bytes / sizeof(float);
+    }();
+    return elems;
+}
+
+class Pipeline {
+public:
+    Pipeline &Then(BlockOp op) {
+        ops_.push_back(std::move(op));
+        return *this;
+    }
+
+    template <typename F>
+    Pipeline &ThenMap(F f) {
+        return Then(Map(std::move(f)));
+    }
+
+    std::size_t size() const noexcept { return ops_.size(); }
+
+    // 未融合：每个算子扫一遍整个数组，作为对照。
+    void RunUnfused(float *a, std::size_t n) const {
+        for (const BlockOp &op : ops_) {
+            op(a, n);
+        }
+    }
+
+    // 融合：按块推进，每块依次经过全部算子。
+    void Run(float *a, std::size_t n, std::size_t block = DefaultBlockElems()) const {
+        for (std::size_t i = 0; i < n; i += block) {
+            RunBlock(a + i, n - i < block ? n - i : block);
+        }
+    }
+
+    // 融合 + OpenMP：块之间相互独立，直接分给各线程。
+    void ParallelRun(float *a, std::size_t n, std::size_t block = DefaultBlockElems()) const {
+        ParallelRun(par::Backend::kOpenMP, a, n, block);
+    }
+
+    // 融合 + 指定并行后端：以块为最小调度单位（grain = 1 块），块内依次经过全部算子。
+    void ParallelRun(par::Backend backend, float *a, std::size_t n,
+                     std::size_t block = DefaultBlockElems()) const {
+        const std::size_t blocks = (n + block - 1) / block;
+        par::ParallelFor(
+            backend, blocks,
+            [&](std::size_t b0, std::size_t b1) {
+                for (std::size_t b = b0; b < b1; b++) {
+                    const std::size_t i = b * block;
+                    RunBlock(a + i, n - i < block ? n - i : block);
+                }
+            },
+            1);
+    }
+
+    // 未融合 + 指定并行后端：每个算子各自并行扫一遍整个数组，作为 ParallelRun 的对照。
+    void ParallelRunUnfused(par::Backend backend, float *a, std::size_t n) const {
+        for (const BlockOp &op : ops_) {
+            par::ParallelFor(backend, n, [&](std::size_t begin, std::size_t end) {
+                op(a + begin, end - begin);
+            });
+        }
+    }
+
+private:
+    void RunBlock(float *p, std::size_t m) const {
+        for (const BlockOp &op : ops_) {
+            op(p, m);
+        }
+    }
+
+    std::vector<BlockOp> ops_;
+};
+
+}  // namespace pipeline
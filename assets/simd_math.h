@@ -0,0 +1,444 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+
+#include "stream_kernels.h"
+
+// 向量化 sin/cos：
+// - 区间约简：x = k * pi/2 + r，|r| <= pi/4。pi/2 拆成 hi + lo 两段（Cody-Waite），
+//   在 double 中用 FMA 计算，float 输入在 |x| <= kMaxArg 内约简误差可忽略；
+// - 多项式：[-pi/4, pi/4] 上的 Taylor 展开，三档精度对应不同阶数与计算精度；
+// - 超出 kMaxArg（含 inf/NaN）的向量整块退回 std::sin/std::cos。
+// 指令集沿用 stream_kernels 的 CPUID 检测，AVX2 路径额外要求 FMA。
+
+namespace simd_math {
+
+using stream_kernels::Isa;
+
+enum class Accuracy : int {
+    kUlp1 = 0,  // double 多项式，最大误差 ~1 ULP
+    kUlp4 = 1,  // float 多项式，最大误差 ~4 ULP
+    kFast = 2,  // 低阶 float 多项式，绝对误差 ~1e-4
+};
+
+inline const char *AccuracyName(Accuracy acc) {
+    switch (acc) {
+    case Accuracy::kUlp1: return "1ulp";
+    case Accuracy::kUlp4: return "4ulp";
+    default: return "1e-4";
+    }
+}
+
+// 约简的适用范围：k 需放得进 int32，且 k * lo 的残差远小于 float 精度。
+constexpr float kMaxArg = 1e9f;
+
+namespace detail {
+
+constexpr std::uint32_t kMaxArgBits = 0x4e6e6b28u;  // 即 1e9f 的位模式
+constexpr double kTwoOverPi = 0.63661977236758134308;
+constexpr double kPio2Hi = 1.5707963267948965580e+00;
+constexpr double kPio2Lo = 6.1232339957367658861e-17;
+
+// sin(r) = r + r^3 * (S0 + r^2 * (S1 + ...))，cos(r) = 1 + r^2 * (C0 + r^2 * (C1 + ...))
+template <Accuracy A>
+struct Poly;
+
+template <>
+struct Poly<Accuracy::kUlp1> {
+    using T = double;
+    static constexpr double kSin[] = {-1.0 / 6, 1.0 / 120, -1.0 / 5040, 1.0 / 362880,
+                                      -1.0 / 39916800};
+    static constexpr double kCos[] = {-1.0 / 2, 1.0 / 24, -1.0 / 720, 1.0 / 40320,
+                                      -1.0 / 3628800, 1.0 / 479001600};
+};
+
+template <>
+struct Poly<Accuracy::kUlp4> {
+    using T = float;
+    static constexpr float kSin[] = {-1.0f / 6, 1.0f / 120, -1.0f / 5040, 1.0f / 362880};
+    static constexpr float kCos[] = {-1.0f / 2, 1.0f / 24, -1.0f / 720, 1.0f / 40320,
+                                     -1.0f / 3628800};
+};
+
+template <>
+struct Poly<Accuracy::kFast> {
+    using T = float;
+    static constexpr float kSin[] = {-1.0f / 6, 1.0f / 120};
+    static constexpr float kCos[] = {-1.0f / 2, 1.0f / 24, -1.0f / 720};
+};
+
+template <typename T, std::size_t N>
+constexpr std::size_t Size(const T (&)[N]) {
+    return N;
+}
+
+inline bool OutOfRange(float x) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return (bits & 0x7fffffffu) > kMaxArgBits;
+}
+
+// 标量版本：与向量路径逐位一致，用于尾部元素与不支持 SIMD 的 CPU。
+template <Accuracy A>
+inline void SinCosScalar(float x, float *s, float *c) {
+    if (OutOfRange(x)) {
+        if (s) *s = static_cast<float>(std::sin(static_cast<double>(x)));
+        if (c) *c = static_cast<float>(std::cos(static_cast<double>(x)));
+        return;
+    }
+    using P = Poly<A>;
+    using T = typename P::T;
+    const double xd = x;
+    const double q = std::nearbyint(xd * kTwoOverPi);
+    double rd = std::fma(-q, kPio2Hi, xd);
+    rd = std::fma(-q, kPio2Lo, rd);
+    const int k = static_cast<int>(q);
+
+    const T r = static_cast<T>(rd);
+    const T z = r * r;
+    constexpr std::size_t ns = Size(P::kSin);
+    constexpr std::size_t nc = Size(P::kCos);
+    T ps = P::kSin[ns - 1];
+    for (std::size_t j = ns - 1; j-- > 0;) {
+        ps = std::fma(ps, z, P::kSin[j]);
+    }
+    ps = std::fma(ps * z, r, r);
+    T pc = P::kCos[nc - 1];
+    for (std::size_t j = nc - 1; j-- > 0;) {
+        pc = std::fma(pc, z, P::kCos[j]);
+    }
+    pc = std::fma(pc, z, T(1));
+
+    if (s) {
+        T v = (k & 1) ? pc : ps;
+        *s = static_cast<float>((k & 2) ? -v : v);
+    }
+    if (c) {
+        T v = (k & 1) ? ps : pc;
+        *c = static_cast<float>(((k + 1) & 2) ? -v : v);
+    }
+}
+
+template <Accuracy A>
+inline void SinCosScalar(const float *x, float *s, float *c, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        SinCosScalar<A>(x[i], s ? s + i : nullptr, c ? c + i : nullptr);
+    }
+}
+
+// ---- AVX-512 ----
+
+// 8 个 float 在 double 中约简，返回 r 与象限 k。
+__attribute__((target("avx512f")))
+inline __m512d ReduceAVX512(__m256 x, __m256i *k) {
+    const __m512d xd = _mm512_cvtps_pd(x);
+    const __m512d q = _mm512_roundscale_pd(_mm512_mul_pd(xd, _mm512_set1_pd(kTwoOverPi)),
+                                           _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d r = _mm512_fnmadd_pd(q, _mm512_set1_pd(kPio2Hi), xd);
+    r = _mm512_fnmadd_pd(q, _mm512_set1_pd(kPio2Lo), r);
+    *k = _mm512_cvtpd_epi32(q);
+    return r;
+}
+
+// 1 ULP 档：多项式与象限选择都在 double 中完成，每次处理 8 个。
+__attribute__((target("avx512f")))
+inline void SinCos8AVX512(const float *x, float *s, float *c) {
+    using P = Poly<Accuracy::kUlp1>;
+    __m256i k32;
+    const __m512d r = ReduceAVX512(_mm256_loadu_ps(x), &k32);
+    const __m512d z = _mm512_mul_pd(r, r);
+    constexpr std::size_t ns = Size(P::kSin);
+    constexpr std::size_t nc = Size(P::kCos);
+    __m512d ps = _mm512_set1_pd(P::kSin[ns - 1]);
+    for (std::size_t j = ns - 1; j-- > 0;) {
+        ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(P::kSin[j]));
+    }
+    ps = _mm512_fmadd_pd(_mm512_mul_pd(ps, z), r, r);
+    __m512d pc = _mm512_set1_pd(P::kCos[nc - 1]);
+    for (std::size_t j = nc - 1; j-- > 0;) {
+        pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(P::kCos[j]));
+    }
+    pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(1.0));
+
+    const __m512i k = _mm512_cvtepi32_epi64(k32);
+    const __m512i two = _mm512_set1_epi64(2);
+    const __mmask8 swap = _mm512_test_epi64_mask(k, _mm512_set1_epi64(1));
+    if (s) {
+        const __m512i sign = _mm512_slli_epi64(_mm512_and_si512(k, two), 62);
+        const __m512d v = _mm512_mask_blend_pd(swap, ps, pc);
+        _mm256_storeu_ps(s, _mm512_cvtpd_ps(
+                                _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(v), sign))));
+    }
+    if (c) {
+        const __m512i k1 = _mm512_add_epi64(k, _mm512_set1_epi64(1));
+        const __m512i sign = _mm512_slli_epi64(_mm512_and_si512(k1, two), 62);
+        const __m512d v = _mm512_mask_blend_pd(swap, pc, ps);
+        _mm256_storeu_ps(c, _mm512_cvtpd_ps(
+                                _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(v), sign))));
+    }
+}
+
+// float 档：两组 8 个分别约简，合并成 16 路 float 计算多项式。
+template <Accuracy A>
+__attribute__((target("avx512f")))
+inline void SinCos16AVX512(const float *x, float *s, float *c) {
+    using P = Poly<A>;
+    __m256i k0, k1;
+    const __m256 r0 = _mm512_cvtpd_ps(ReduceAVX512(_mm256_loadu_ps(x), &k0));
+    const __m256 r1 = _mm512_cvtpd_ps(ReduceAVX512(_mm256_loadu_ps(x + 8), &k1));
+    const __m512 r = _mm512_castpd_ps(_mm512_insertf64x4(
+        _mm512_castps_pd(_mm512_castps256_ps512(r0)), _mm256_castps_pd(r1), 1));
+    const __m512i k = _mm512_inserti64x4(_mm512_castsi256_si512(k0), k1, 1);
+
+    const __m512 z = _mm512_mul_ps(r, r);
+    constexpr std::size_t ns = Size(P::kSin);
+    constexpr std::size_t nc = Size(P::kCos);
+    __m512 ps = _mm512_set1_ps(P::kSin[ns - 1]);
+    for (std::size_t j = ns - 1; j-- > 0;) {
+        ps = _mm512_fmadd_ps(ps, z, _mm512_set1_ps(P::kSin[j]));
+    }
+    ps = _mm512_fmadd_ps(_mm512_mul_ps(ps, z), r, r);
+    __m512 pc = _mm512_set1_ps(P::kCos[nc - 1]);
+    for (std::size_t j = nc - 1; j-- > 0;) {
+        pc = _mm512_fmadd_ps(pc, z, _mm512_set1_ps(P::kCos[j]));
+    }
+    pc = _mm512_fmadd_ps(pc, z, _mm512_set1_ps(1.0f));
+
+    const __m512i two = _mm512_set1_epi32(2);
+    const __mmask16 swap = _mm512_test_epi32_mask(k, _mm512_set1_epi32(1));
+    if (s) {
+        const __m512i sign = _mm512_slli_epi32(_mm512_and_si512(k, two), 30);
+        const __m512 v = _mm512_mask_blend_ps(swap, ps, pc);
+        _mm512_storeu_ps(s, _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), sign)));
+    }
+    if (c) {
+        const __m512i k1p = _mm512_add_epi32(k, _mm512_set1_epi32(1));
+        const __m512i sign = _mm512_slli_epi32(_mm512_and_si512(k1p, two), 30);
+        const __m512 v = _mm512_mask_blend_ps(swap, pc, ps);
+        _mm512_storeu_ps(c, _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), sign)));
+    }
+}
+
+template <Accuracy A>
+__attribute__((target("avx512f")))
+inline void SinCosAVX512(const float *x, float *s, float *c, std::size_t n) {
+    const __m512i abs_mask = _mm512_set1_epi32(0x7fffffff);
+    const __m512i max_bits = _mm512_set1_epi32(static_cast<int>(kMaxArgBits));
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512i bits = _mm512_and_si512(_mm512_loadu_si512(x + i), abs_mask);
+        float *si = s ? s + i : nullptr;
+        float *ci = c ? c + i : nullptr;
+        if (_mm512_cmpgt_epi32_mask(bits, max_bits)) {
+            SinCosScalar<A>(x + i, si, ci, 16);
+        } else if constexpr (A == Accuracy::kUlp1) {
+            SinCos8AVX512(x + i, si, ci);
+            SinCos8AVX512(x + i + 8, si ? si + 8 : nullptr, ci ? ci + 8 : nullptr);
+        } else {
+            SinCos16AVX512<A>(x + i, si, ci);
+        }
+    }
+    SinCosScalar<A>(x + i, s ? s + i : nullptr, c ? c + i : nullptr, n - i);
+}
+
+// ---- AVX2 + FMA ----
+
+__attribute__((target("avx2,fma")))
+inline __m256d ReduceAVX2(__m128 x, __m128i *k) {
+    const __m256d xd = _mm256_cvtps_pd(x);
+    const __m256d q = _mm256_round_pd(_mm256_mul_pd(xd, _mm256_set1_pd(kTwoOverPi)),
+                                      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(q, _mm256_set1_pd(kPio2Hi), xd);
+    r = _mm256_fnmadd_pd(q, _mm256_set1_pd(kPio2Lo), r);
+    *k = _mm256_cvtpd_epi32(q);
+    return r;
+}
+
+__attribute__((target("avx2,fma")))
+inline void SinCos4AVX2(const float *x, float *s, float *c) {
+    using P = Poly<Accuracy::kUlp1>;
+    __m128i k32;
+    const __m256d r = ReduceAVX2(_mm_loadu_ps(x), &k32);
+    const __m256d z = _mm256_mul_pd(r, r);
+    constexpr std::size_t ns = Size(P::kSin);
+    constexpr std::size_t nc = Size(P::kCos);
+    __m256d ps = _mm256_set1_pd(P::kSin[ns - 1]);
+    for (std::size_t j = ns - 1; j-- > 0;) {
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(P::kSin[j]));
+    }
+    ps = _mm256_fmadd_pd(_mm256_mul_pd(ps, z), r, r);
+    __m256d pc = _mm256_set1_pd(P::kCos[nc - 1]);
+    for (std::size_t j = nc - 1; j-- > 0;) {
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(P::kCos[j]));
+    }
+    pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(1.0));
+
+    const __m256i k = _mm256_cvtepi32_epi64(k32);
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i two = _mm256_set1_epi64x(2);
+    const __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(k, one), one));
+    if (s) {
+        const __m256i sign = _mm256_slli_epi64(_mm256_and_si256(k, two), 62);
+        const __m256d v = _mm256_blendv_pd(ps, pc, swap);
+        _mm_storeu_ps(s, _mm256_cvtpd_ps(_mm256_xor_pd(v, _mm256_castsi256_pd(sign))));
+    }
+    if (c) {
+        const __m256i k1 = _mm256_add_epi64(k, one);
+        const __m256i sign = _mm256_slli_epi64(_mm256_and_si256(k1, two), 62);
+        const __m256d v = _mm256_blendv_pd(pc, ps, swap);
+        _mm_storeu_ps(c, _mm256_cvtpd_ps(_mm256_xor_pd(v, _mm256_castsi256_pd(sign))));
+    }
+}
+
+template <Accuracy A>
+__attribute__((target("avx2,fma")))
+inline void SinCos8AVX2(const float *x, float *s, float *c) {
+    using P = Poly<A>;
+    __m128i k0, k1;
+    const __m128 r0 = _mm256_cvtpd_ps(ReduceAVX2(_mm_loadu_ps(x), &k0));
+    const __m128 r1 = _mm256_cvtpd_ps(ReduceAVX2(_mm_loadu_ps(x + 4), &k1));
+    const __m256 r = _mm256_set_m128(r1, r0);
+    const __m256i k = _mm256_set_m128i(k1, k0);
+
+    const __m256 z = _mm256_mul_ps(r, r);
+    constexpr std::size_t ns = Size(P::kSin);
+    constexpr std::size_t nc = Size(P::kCos);
+    __m256 ps = _mm256_set1_ps(P::kSin[ns - 1]);
+    for (std::size_t j = ns - 1; j-- > 0;) {
+        ps = _mm256_fmadd_ps(ps, z, _mm256_set1_ps(P::kSin[j]));
+    }
+    ps = _mm256_fmadd_ps(_mm256_mul_ps(ps, z), r, r);
+    __m256 pc = _mm256_set1_ps(P::kCos[nc - 1]);
+    for (std::size_t j = nc - 1; j-- > 0;) {
+        pc = _mm256_fmadd_ps(pc, z, _mm256_set1_ps(P::kCos[j]));
+    }
+    pc = _mm256_fmadd_ps(pc, z, _mm256_set1_ps(1.0f));
+
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(k, one), one));
+    if (s) {
+        const __m256i sign = _mm256_slli_epi32(_mm256_and_si256(k, two), 30);
+        const __m256 v = _mm256_blendv_ps(ps, pc, swap);
+        _mm256_storeu_ps(s, _mm256_xor_ps(v, _mm256_castsi256_ps(sign)));
+    }
+    if (c) {
+        const __m256i k1p = _mm256_add_epi32(k, one);
+        const __m256i sign = _mm256_slli_epi32(_mm256_and_si256(k1p, two), 30);
+        const __m256 v = _mm256_blendv_ps(pc, ps, swap);
+        _mm256_storeu_ps(c, _mm256_xor_ps(v, _mm256_castsi256_ps(sign)));
+    }
+}
+
+template <Accuracy A>
+__attribute__((target("avx2,fma")))
+inline void SinCosAVX2(const float *x, float *s, float *c, std::size_t n) {
+    const __m256i abs_mask = _mm256_set1_epi32(0x7fffffff);
+    const __m256i max_bits = _mm256_set1_epi32(static_cast<int>(kMaxArgBits));
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i bits = _mm256_and_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i)), abs_mask);
+        float *si = s ? s + i : nullptr;
+        float *ci = c ? c + i : nullptr;
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(bits, max_bits))) {
+            SinCosScalar<A>(x + i, si, ci, 8);
+        } else if constexpr (A == Accuracy::kUlp1) {
+            SinCos4AVX2(x + i, si, ci);
+            SinCos4AVX2(x + i + 4, si ? si + 4 : nullptr, ci ? ci + 4 : nullptr);
+        } else {
+            SinCos8AVX2<A>(x + i, si, ci);
+        }
+    }
+    SinCosScalar<A>(x + i, s ? s + i : nullptr, c ? c + i : nullptr, n - i);
+}
+
+template <Accuracy A>
+inline void SinCosDispatch(Isa isa, const float *x, float *s, float *c, std::size_t n) {
+    switch (isa) {
+    case Isa::kAVX512: SinCosAVX512<A>(x, s, c, n); break;
+    case Isa::kAVX2: SinCosAVX2<A>(x, s, c, n); break;
+    default: SinCosScalar<A>(x, s, c, n);
+    }
+}
+
+}  // namespace detail
+
+// 把请求的指令集降到当前 CPU 实际可用的档位（AVX2 需同时支持 FMA）。
+inline Isa SelectIsa(Isa want) {
+    if (want == Isa::kAVX512 && stream_kernels::IsaSupported(Isa::kAVX512)) {
+        return Isa::kAVX512;
+    }
+    if (static_cast<int>(want) >= static_cast<int>(Isa::kAVX2) &&
+        stream_kernels::IsaSupported(Isa::kAVX2) && stream_kernels::HasFma()) {
+        return Isa::kAVX2;
+    }
+    return Isa::kScalar;
+}
+
+// 同时计算 sin 与 cos，s/c 任一可为 nullptr；x 与输出可以是同一块内存。
+inline void SinCos(Isa isa, Accuracy acc, const float *x, float *s, float *c, std::size_t n) {
+    isa = SelectIsa(isa);
+    switch (acc) {
+    case Accuracy::kUlp1: detail::SinCosDispatch<Accuracy::kUlp1>(isa, x, s, c, n); break;
+    case Accuracy::kUlp4: detail::SinCosDispatch<Accuracy::kUlp4>(isa, x, s, c, n); break;
+    default: detail::SinCosDispatch<Accuracy::kFast>(isa, x, s, c, n);
+    }
+}
+
+inline void SinCos(const float *x, float *s, float *c, std::size_t n,
+                   Accuracy acc = Accuracy::kUlp4) {
+    SinCos(stream_kernels::DetectIsa(), acc, x, s, c, n);
+}
+
+inline void Sin(const float *x, float *y, std::size_t n, Accuracy acc = Accuracy::kUlp4) {
+    SinCos(x, y, nullptr, n, acc);
+}
+
+inline void Cos(const float *x, float *y, std::size_t n, Accuracy acc = Accuracy::kUlp4) {
+    SinCos(x, nullptr, y, n, acc);
+}
+
+// 误差统计：以 double 精度的 std::sin/std::cos 为参考。
+struct ErrorReport {
+    double max_ulp = 0;
+    double max_abs = 0;
+    float worst_x = 0;  // 取得 max_ulp 的输入
+};
+
+// 误差以参考值舍入到 float 后的 ULP 为单位。
+inline double UlpError(float y, double ref) {
+    const float rf = std::fabs(static_cast<float>(ref));
+    const double ulp = static_cast<double>(std::nextafter(rf, INFINITY)) - rf;
+    return std::fabs(static_cast<double>(y) - ref) / ulp;
+}
+
+// 对 x[0..n) 逐个计算 sin（is_cos=false）或 cos 的误差并累计到 rep。
+inline void AccumulateError(Isa isa, Accuracy acc, bool is_cos, const float *x, std::size_t n,
+                            ErrorReport *rep) {
+    constexpr std::size_t kBlock = 4096;
+    float y[kBlock];
+    for (std::size_t i = 0; i < n; i += kBlock) {
+        const std::size_t m = n - i < kBlock ? n - i : kBlock;
+        SinCos(isa, acc, x + i, is_cos ? nullptr : y, is_cos ? y : nullptr, m);
+        for (std::size_t j = 0; j < m; ++j) {
+            const double xd = x[i + j];
+            const double ref = is_cos ? std::cos(xd) : std::sin(xd);
+            const double ulp = UlpError(y[j], ref);
+            if (ulp > rep->max_ulp) {
+                rep->max_ulp = ulp;
+                rep->worst_x = x[i + j];
+            }
+            const double abs_err = std::fabs(static_cast<double>(y[j]) - ref);
+            if (abs_err > rep->max_abs) {
+                rep->max_abs = abs_err;
+            }
+        }
+    }
+}
+
+}  // namespace simd_math
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cpuid.h>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// 大块内存填充/拷贝内核：
+// - Stream*：非临时存储（movntps），绕过缓存直接写内存，省掉写分配时的读取（RFO），
+//   结尾 sfence 保证对其他核可见；
+// - RepStosb/RepMovsb：依赖 CPU 的 ERMS 微码快路径；
+// 向量版本用 target 属性单独编译，运行时按 CPUID 选择 SSE2/AVX2/AVX-512，
+// 因此即使整体不开 -march=native 也能安全调用。
+
+namespace stream_kernels {
+
+enum class Isa : int {
+    kScalar = 0,
+    kSSE2 = 1,
+    kAVX2 = 2,
+    kAVX512 = 3,
+};
+
+inline const char *IsaName(Isa isa) {
+    switch (isa) {
+    case Isa::kSSE2: return "sse2";
+    case Isa::kAVX2: return "avx2";
+    case Isa::kAVX512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+namespace detail {
+
+inline std::uint64_t ReadXcr0() {
+    std::uint32_t lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<std::uint64_t>(hi) << 32) | lo;
+}
+
+struct CpuFeatures {
+    Isa isa = Isa::kScalar;
+    bool erms = false;  // Enhanced REP MOVSB/STOSB
+    bool fma = false;
+};
+
+inline CpuFeatures DetectCpuFeatures() {
+    CpuFeatures f;
+    unsigned a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d)) {
+        return f;
+    }
+    if (d & bit_SSE2) {
+        f.isa = Isa::kSSE2;
+    }
+    // AVX 系列除了 CPUID 位，还要确认操作系统在 XCR0 中开启了对应寄存器状态。
+    const bool osxsave = (c & bit_OSXSAVE) && (c & bit_AVX);
+    const std::uint64_t xcr0 = osxsave ? ReadXcr0() : 0;
+    const bool ymm_ok = (xcr0 & 0x6) == 0x6;
+    const bool zmm_ok = (xcr0 & 0xe6) == 0xe6;
+    f.fma = ymm_ok && (c & bit_FMA);
+    if (__get_cpuid_count(7, 0, &a, &b, &c, &d)) {
+        f.erms = (b & (1u << 9)) != 0;
+        if (ymm_ok && (b & bit_AVX2)) {
+            f.isa = Isa::kAVX2;
+        }
+        if (zmm_ok && (b & bit_AVX512F)) {
+            f.isa = Isa::kAVX512;
+        }
+    }
+    return f;
+}
+
+inline const CpuFeatures &Features() {
+    static const CpuFeatures f = DetectCpuFeatures();
+    return f;
+}
+
+// 先用标量写到 Align 字节对齐，返回已处理的元素个数。
+template <std::size_t Align>
+inline std::size_t ScalarHead(float *dst, std::size_t n, float v) {
+    std::size_t i = 0;
+    while (i < n && (reinterpret_cast<std::uintptr_t>(dst + i) & (Align - 1)) != 0) {
+        dst[i++] = v;
+    }
+    return i;
+}
+
+template <std::size_t Align>
+inline std::size_t ScalarHeadCopy(float *dst, const float *src, std::size_t n) {
+    std::size_t i = 0;
+    while (i < n && (reinterpret_cast<std::uintptr_t>(dst + i) & (Align - 1)) != 0) {
+        dst[i] = src[i];
+        ++i;
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+inline void StreamFillSSE2(float *dst, std::size_t n, float v) {
+    std::size_t i = ScalarHead<16>(dst, n, v);
+    const __m128 x = _mm_set1_ps(v);
+    for (; i + 16 <= n; i += 16) {
+        _mm_stream_ps(dst + i, x);
+        _mm_stream_ps(dst + i + 4, x);
+        _mm_stream_ps(dst + i + 8, x);
+        _mm_stream_ps(dst + i + 12, x);
+    }
+    for (; i + 4 <= n; i += 4) {
+        _mm_stream_ps(dst + i, x);
+    }
+    for (; i < n; ++i) {
+        dst[i] = v;
+    }
+    _mm_sfence();
+}
+
+__attribute__((target("avx2")))
+inline void StreamFillAVX2(float *dst, std::size_t n, float v) {
+    std::size_t i = ScalarHead<32>(dst, n, v);
+    const __m256 x = _mm256_set1_ps(v);
+    for (; i + 32 <= n; i += 32) {
+        _mm256_stream_ps(dst + i, x);
+        _mm256_stream_ps(dst + i + 8, x);
+        _mm256_stream_ps(dst + i + 16, x);
+        _mm256_stream_ps(dst + i + 24, x);
+    }
+    for (; i + 8 <= n; i += 8) {
+        _mm256_stream_ps(dst + i, x);
+    }
+    for (; i < n; ++i) {
+        dst[i] = v;
+    }
+    _mm_sfence();
+}
+
+__attribute__((target("avx512f")))
+inline void StreamFillAVX512(float *dst, std::size_t n, float v) {
+    std::size_t i = ScalarHead<64>(dst, n, v);
+    const __m512 x = _mm512_set1_ps(v);
+    for (; i + 64 <= n; i += 64) {
+        _mm512_stream_ps(dst + i, x);
+        _mm512_stream_ps(dst + i + 16, x);
+        _mm512_stream_ps(dst + i + 32, x);
+        _mm512_stream_ps(dst + i + 48, x);
+    }
+    for (; i + 16 <= n; i += 16) {
+        _mm512_stream_ps(dst + i, x);
+    }
+    for (; i < n; ++i) {
+        dst[i] = v;
+    }
+    _mm_sfence();
+}
+
+// 拷贝只要求 dst 对齐，src 用非对齐加载。
+__attribute__((target("sse2")))
+inline void StreamCopySSE2(float *dst, const float *src, std::size_t n) {
+    std::size_t i = ScalarHeadCopy<16>(dst, src, n);
+    for (; i + 16 <= n; i += 16) {
+        _mm_stream_ps(dst + i, _mm_loadu_ps(src + i));
+        _mm_stream_ps(dst + i + 4, _mm_loadu_ps(src + i + 4));
+        _mm_stream_ps(dst + i + 8, _mm_loadu_ps(src + i + 8));
+        _mm_stream_ps(dst + i + 12, _mm_loadu_ps(src + i + 12));
+    }
+    for (; i + 4 <= n; i += 4) {
+        _mm_stream_ps(dst + i, _mm_loadu_ps(src + i));
+    }
+    for (; i < n; ++i) {
+        dst[i] = src[i];
+    }
+    _mm_sfence();
+}
+
+__attribute__((target("avx2")))
+inline void StreamCopyAVX2(float *dst, const float *src, std::size_t n) {
+    std::size_t i = ScalarHeadCopy<32>(dst, src, n);
+    for (; i + 32 <= n; i += 32) {
+        _mm256_stream_ps(dst + i, _mm256_loadu_ps(src + i));
+        _mm256_stream_ps(dst + i + 8, _mm256_loadu_ps(src + i + 8));
+        _mm256_stream_ps(dst + i + 16, _mm256_loadu_ps(src + i + 16));
+        _mm256_stream_ps(dst + i + 24, _mm256_loadu_ps(src + i + 24));
+    }
+    for (; i + 8 <= n; i += 8) {
+        _mm256_stream_ps(dst + i, _mm256_loadu_ps(src + i));
+    }
+    for (; i < n; ++i) {
+        dst[i] = src[i];
+    }
+    _mm_sfence();
+}
+
+__attribute__((target("avx512f")))
+inline void StreamCopyAVX512(float *dst, const float *src, std::size_t n) {
+    std::size_t i = ScalarHeadCopy<64>(dst, src, n);
+    for (; i + 64 <= n; i += 64) {
+        _mm512_stream_ps(dst + i, _mm512_loadu_ps(src + i));
+        _mm512_stream_ps(dst + i + 16, _mm512_loadu_ps(src + i + 16));
+        _mm512_stream_ps(dst + i + 32, _mm512_loadu_ps(src + i + 32));
+        _mm512_stream_ps(dst + i + 48, _mm512_loadu_ps(src + i + 48));
+    }
+    for (; i + 16 <= n; i += 16) {
+        _mm512_stream_ps(dst + i, _mm512_loadu_ps(src + i));
+    }
+    for (; i < n; ++i) {
+        dst[i] = src[i];
+    }
+    _mm_sfence();
+}
+
+}  // namespace detail
+
+// 当前 CPU 支持的最高向量指令集。
+inline Isa DetectIsa() { return detail::Features().isa; }
+
+inline bool HasErms() { return detail::Features().erms; }
+
+inline bool HasFma() { return detail::Features().fma; }
+
+inline bool IsaSupported(Isa isa) {
+    return static_cast<int>(isa) <= static_cast<int>(DetectIsa());
+}
+
+// 指定指令集的非临时填充，调用方需保证 IsaSupported(isa)。
+inline void StreamFill(Isa isa, float *dst, std::size_t n, float v) {
+    switch (isa) {
+    case Isa::kAVX512: detail::StreamFillAVX512(dst, n, v); break;
+    case Isa::kAVX2: detail::StreamFillAVX2(dst, n, v); break;
+    case Isa::kSSE2: detail::StreamFillSSE2(dst, n, v); break;
+    default:
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] = v;
+        }
+    }
+}
+
+inline void StreamFill(float *dst, std::size_t n, float v) { StreamFill(DetectIsa(), dst, n, v); }
+
+inline void StreamCopy(Isa isa, float *dst, const float *src, std::size_t n) {
+    switch (isa) {
+    case Isa::kAVX512: detail::StreamCopyAVX512(dst, src, n); break;
+    case Isa::kAVX2: detail::StreamCopyAVX2(dst, src, n); break;
+    case Isa::kSSE2: detail::StreamCopySSE2(dst, src, n); break;
+    default:
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+inline void StreamCopy(float *dst, const float *src, std::size_t n) {
+    StreamCopy(DetectIsa(), dst, src, n);
+}
+
+// rep stosb 按字节填充；大块写入时 ERMS 微码内部会用整行写，同样能避开 RFO。
+inline void RepStosb(void *dst, unsigned char byte, std::size_t bytes) {
+    __asm__ volatile("rep stosb" : "+D"(dst), "+c"(bytes) : "a"(byte) : "memory");
+}
+
+inline void RepMovsb(void *dst, const void *src, std::size_t bytes) {
+    __asm__ volatile("rep movsb" : "+D"(dst), "+S"(src), "+c"(bytes) : : "memory");
+}
+
+}  // namespace stream_kernels
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "detail/aligned_allocator.h"
+#include "fd_token.h"
+
+namespace kvcache {
+
+// 缓存内容的列式快照（struct-of-arrays）：
+// 同一下标 i 的四列描述同一条存活记录，每列起始地址 64B 对齐，
+// 便于分析侧直接做向量化扫描。
+template <typename Key, typename Value>
+struct CacheColumns {
+    detail::AlignedVector<Key> keys;
+    detail::AlignedVector<Value> values;
+    detail::AlignedVector<FdToken::raw_type> handles;
+    detail::AlignedVector<std::uint8_t> types;
+
+    std::size_t size() const noexcept { return keys.size(); }
+
+    bool empty() const noexcept { return keys.empty(); }
+
+    void resize(std::size_t n) {
+        keys.resize(n);
+        values.resize(n);
+        handles.resize(n);
+        types.resize(n);
+    }
+};
+
+}  // namespace kvcache（KV 缓存命名空间）
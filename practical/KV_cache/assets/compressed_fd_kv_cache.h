@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "detail/lz_dict_codec.h"
+#include "fd_token.h"
+#include "sharded_fd_kv_cache.h"
+
+namespace kvcache {
+namespace detail {
+
+// 槽内实际存放的值：压缩字节 + 压缩时使用的字典。
+// 持有字典的 shared_ptr，重新训练字典后旧值仍可正确解压。
+struct CompressedBlob {
+    std::vector<std::uint8_t> bytes;
+    std::shared_ptr<const LzDictionary> dictionary;
+    std::uint32_t raw_size{0};
+    std::uint8_t compressed{0};
+};
+
+}  // namespace detail（内部实现）
+
+struct CompressionOptions {
+    // 小于该长度的值直接原样存储，压缩收益抵不上 CPU 开销。
+    std::size_t min_compress_size = 256;
+    std::size_t dictionary_capacity = detail::LzDictionary::kDefaultCapacity;
+};
+
+// 大值压缩模式：在 ShardedFdKVCache 之上按 shard 维护训练字典。
+// - 压缩在 shard 锁外完成，锁内只做槽位拷贝
+// - Read 在共享锁内直接解压到调用方缓冲区，不产生临时分配
+// - 句柄格式与 ShardedFdKVCache 完全一致
+template <typename Key,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class CompressedFdKVCache {
+public:
+    using key_type = Key;
+    using handle_type = FdToken::raw_type;
+    using cache_type = ShardedFdKVCache<Key, detail::CompressedBlob, Hash, KeyEqual>;
+
+    explicit CompressedFdKVCache(std::size_t shard_count = cache_type::DefaultShardCount(),
+                                 std::size_t reserve_hint = 0,
+                                 CompressionOptions options = CompressionOptions{})
+        : cache_(shard_count, reserve_hint),
+          options_(options),
+          dictionaries_(std::make_unique<DictionaryPtr[]>(cache_.shard_count())) {}
+
+    std::size_t size() const noexcept { return cache_.size(); }
+
+    bool empty() const noexcept { return cache_.empty(); }
+
+    std::size_t shard_count() const noexcept { return cache_.shard_count(); }
+
+    // 按 key 把样本路由到各自 shard，再为每个 shard 单独训练字典。
+    // 没有样本的 shard 保持原字典不变。
+    void TrainDictionaries(const std::vector<std::pair<Key, std::string_view>>& samples) {
+        std::vector<std::vector<std::string_view>> per_shard(cache_.shard_count());
+        for (const auto& [key, value] : samples) {
+            per_shard[cache_.ShardIndexForKey(key)].push_back(value);
+        }
+        for (std::size_t shard = 0; shard < per_shard.size(); ++shard) {
+            if (!per_shard[shard].empty()) {
+                TrainShardDictionary(shard, per_shard[shard]);
+            }
+        }
+    }
+
+    void TrainShardDictionary(std::size_t shard, const std::vector<std::string_view>& samples) {
+        if (shard >= cache_.shard_count()) {
+            return;
+        }
+        auto dictionary = std::make_shared<const detail::LzDictionary>(
+            detail::LzDictionary::Train(samples, options_.dictionary_capacity));
+        if (dictionary->empty()) {
+            return;
+        }
+        std::atomic_store(&dictionaries_[shard], DictionaryPtr(std::move(dictionary)));
+    }
+
+    // key 已存在时返回现有句柄且不覆盖值（与 ShardedFdKVCache::Insert 一致）。
+    handle_type Insert(std::uint8_t type, const Key& key, std::string_view value) {
+        return cache_.Insert(type, key, Encode(cache_.ShardIndexForKey(key), value));
+    }
+
+    handle_type InsertOrAssign(std::uint8_t type, const Key& key, std::string_view value) {
+        return cache_.InsertOrAssign(type, key, Encode(cache_.ShardIndexForKey(key), value));
+    }
+
+    bool Update(handle_type handle, std::string_view value) {
+        const std::uint32_t shard =
+            FdToken::Position(handle) >> cache_type::kLocalBits;
+        if (shard >= cache_.shard_count()) {
+            return false;
+        }
+        detail::CompressedBlob blob = Encode(shard, value);
+        return cache_.Write(handle, [&](detail::CompressedBlob& v) { v = std::move(blob); });
+    }
+
+    // 解压到调用方缓冲区。out_size 总是写入原始长度（若句柄有效），
+    // 因此 capacity 不足时调用方可据此扩容后重试。
+    bool Read(handle_type handle,
+              char* buffer,
+              std::size_t capacity,
+              std::size_t* out_size) const {
+        bool ok = false;
+        const bool found = cache_.Read(handle, [&](const detail::CompressedBlob& blob) {
+            if (out_size != nullptr) {
+                *out_size = blob.raw_size;
+            }
+            if (blob.raw_size > capacity) {
+                return;
+            }
+            auto* dst = reinterpret_cast<std::uint8_t*>(buffer);
+            if (blob.compressed != 0) {
+                ok = detail::LzDecompress(blob.dictionary.get(), blob.bytes.data(),
+                                          blob.bytes.size(), dst, blob.raw_size);
+            } else {
+                if (blob.raw_size != 0) {
+                    std::memcpy(dst, blob.bytes.data(), blob.raw_size);
+                }
+                ok = true;
+            }
+        });
+        return found && ok;
+    }
+
+    // 原始（解压后）长度。
+    bool ValueSize(handle_type handle, std::size_t* out_size) const {
+        return cache_.Read(handle, [&](const detail::CompressedBlob& blob) {
+            if (out_size != nullptr) {
+                *out_size = blob.raw_size;
+            }
+        });
+    }
+
+    // 槽内实际占用的负载字节数，用于统计压缩率。
+    bool StoredSize(handle_type handle, std::size_t* out_size) const {
+        return cache_.Read(handle, [&](const detail::CompressedBlob& blob) {
+            if (out_size != nullptr) {
+                *out_size = blob.bytes.size();
+            }
+        });
+    }
+
+    bool Erase(handle_type handle) { return cache_.Erase(handle); }
+
+    handle_type FindHandle(const Key& key) const { return cache_.FindHandle(key); }
+
+private:
+    using DictionaryPtr = std::shared_ptr<const detail::LzDictionary>;
+
+    cache_type cache_;
+    CompressionOptions options_;
+    // 每个 shard 一个字典；训练时整体替换指针，读写路径只做原子 load。
+    std::unique_ptr<DictionaryPtr[]> dictionaries_;
+
+    detail::CompressedBlob Encode(std::size_t shard, std::string_view value) const {
+        detail::CompressedBlob blob;
+        blob.raw_size = static_cast<std::uint32_t>(value.size());
+        const auto* src = reinterpret_cast<const std::uint8_t*>(value.data());
+        if (value.size() >= options_.min_compress_size) {
+            thread_local std::vector<std::uint8_t> scratch;
+            scratch.resize(detail::LzCompressBound(value.size()));
+            DictionaryPtr dictionary = std::atomic_load(&dictionaries_[shard]);
+            const std::size_t n =
+                detail::LzCompress(dictionary.get(), src, value.size(), scratch.data());
+            if (n < value.size()) {
+                blob.bytes.assign(scratch.data(), scratch.data() + n);
+                blob.dictionary = std::move(dictionary);
+                blob.compressed = 1;
+                return blob;
+            }
+        }
+        blob.bytes.assign(src, src + value.size());
+        return blob;
+    }
+};
+
+}  // namespace kvcache（KV 缓存命名空间）
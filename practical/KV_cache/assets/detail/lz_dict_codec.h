@@ -0,0 +1,352 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace kvcache {
+namespace detail {
+
+// 轻量 LZ 编解码器（LZ4 风格的 sequence 格式），支持外部预训练字典。
+// 块格式：
+//   [token | 扩展字面量长度 | 字面量 | offset:u16 | 扩展匹配长度] ...
+//   token 高 4 位为字面量长度，低 4 位为 (匹配长度 - 4)；
+//   最后一个 sequence 只含字面量，没有 offset。
+// offset 可以越过输出起点指向字典尾部，因此小值也能引用字典中的公共片段。
+constexpr std::size_t kLzMinMatch = 4;
+constexpr std::size_t kLzMaxOffset = 65535;
+constexpr std::uint32_t kLzHashBits = 12;
+constexpr std::size_t kLzHashSize = std::size_t{1} << kLzHashBits;
+
+inline std::uint32_t LzRead32(const std::uint8_t* p) noexcept {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint64_t LzRead64(const std::uint8_t* p) noexcept {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint32_t LzHash4(const std::uint8_t* p) noexcept {
+    return (LzRead32(p) * 2654435761u) >> (32 - kLzHashBits);
+}
+
+// 压缩输出的最坏长度上界（全是字面量时）。
+inline std::size_t LzCompressBound(std::size_t n) noexcept { return n + n / 255 + 16; }
+
+// 训练得到的字典：内容本身 + 预先建好的 4 字节哈希表。
+// 压缩时直接复制哈希表，避免每个值都重新扫描字典。
+class LzDictionary {
+public:
+    static constexpr std::size_t kDefaultCapacity = 16 * 1024;
+    // 字典与值共享 64KB 的 offset 窗口，字典最多占一半。
+    static constexpr std::size_t kMaxCapacity = 32 * 1024;
+
+    LzDictionary() = default;
+
+    explicit LzDictionary(std::vector<std::uint8_t> content) : content_(std::move(content)) {
+        if (content_.size() > kMaxCapacity) {
+            content_.erase(content_.begin(),
+                           content_.end() - static_cast<std::ptrdiff_t>(kMaxCapacity));
+        }
+        table_.assign(kLzHashSize, 0);
+        for (std::size_t i = 0; i + kLzMinMatch <= content_.size(); ++i) {
+            table_[LzHash4(content_.data() + i)] = static_cast<std::uint32_t>(i + 1);
+        }
+    }
+
+    // 从样本中训练字典（简化版 COVER 思路）：
+    // 1) 统计所有 8 字节 gram 的出现次数；
+    // 2) 把样本切成 64 字节片段，按“尚未被覆盖的 gram 频次之和”打分；
+    // 3) 惰性贪心选片段，直到填满 capacity；得分最高的片段放在字典尾部，
+    //    使最常用的内容离待压缩数据最近。
+    static LzDictionary Train(const std::vector<std::string_view>& samples,
+                              std::size_t capacity = kDefaultCapacity) {
+        constexpr std::size_t kGram = 8;
+        constexpr std::size_t kSegment = 64;
+        constexpr std::uint32_t kCountBits = 18;
+        constexpr std::size_t kMaxSampleBytes = std::size_t{4} << 20;
+
+        capacity = std::min(capacity, kMaxCapacity);
+        std::vector<std::uint32_t> counts(std::size_t{1} << kCountBits, 0);
+        const auto gram_hash = [](const char* p) noexcept {
+            const std::uint64_t v = LzRead64(reinterpret_cast<const std::uint8_t*>(p));
+            return static_cast<std::uint32_t>((v * 0x9e3779b97f4a7c15ull) >> (64 - kCountBits));
+        };
+
+        std::size_t budget = kMaxSampleBytes;
+        std::vector<std::string_view> used;
+        for (const std::string_view s : samples) {
+            if (s.size() < kSegment || budget == 0) {
+                continue;
+            }
+            const std::string_view part = s.substr(0, std::min(s.size(), budget));
+            budget -= part.size();
+            used.push_back(part);
+            for (std::size_t i = 0; i + kGram <= part.size(); ++i) {
+                ++counts[gram_hash(part.data() + i)];
+            }
+        }
+
+        struct Segment {
+            std::uint32_t sample;
+            std::uint32_t offset;
+        };
+        std::vector<Segment> segments;
+        for (std::size_t s = 0; s < used.size(); ++s) {
+            for (std::size_t off = 0; off + kSegment <= used[s].size(); off += kSegment / 2) {
+                segments.push_back(
+                    Segment{static_cast<std::uint32_t>(s), static_cast<std::uint32_t>(off)});
+            }
+        }
+
+        // 只出现一次的 gram 对压缩没有帮助，因此按 (count - 1) 计分。
+        const auto score = [&](const Segment& seg) {
+            const char* p = used[seg.sample].data() + seg.offset;
+            std::uint64_t total = 0;
+            for (std::size_t i = 0; i + kGram <= kSegment; ++i) {
+                const std::uint32_t c = counts[gram_hash(p + i)];
+                total += c > 1 ? c - 1 : 0;
+            }
+            return total;
+        };
+
+        std::priority_queue<std::pair<std::uint64_t, std::uint32_t>> queue;
+        for (std::size_t i = 0; i < segments.size(); ++i) {
+            queue.emplace(score(segments[i]), static_cast<std::uint32_t>(i));
+        }
+
+        std::vector<std::uint32_t> chosen;
+        std::size_t total = 0;
+        while (!queue.empty() && total + kSegment <= capacity) {
+            const auto [old_score, idx] = queue.top();
+            queue.pop();
+            const std::uint64_t fresh = score(segments[idx]);
+            if (fresh == 0) {
+                break;
+            }
+            if (fresh < old_score && !queue.empty() && fresh < queue.top().first) {
+                queue.emplace(fresh, idx);
+                continue;
+            }
+            chosen.push_back(idx);
+            total += kSegment;
+            const char* p = used[segments[idx].sample].data() + segments[idx].offset;
+            for (std::size_t i = 0; i + kGram <= kSegment; ++i) {
+                counts[gram_hash(p + i)] = 0;
+            }
+        }
+
+        std::vector<std::uint8_t> content;
+        content.reserve(total);
+        for (auto it = chosen.rbegin(); it != chosen.rend(); ++it) {
+            const char* p = used[segments[*it].sample].data() + segments[*it].offset;
+            content.insert(content.end(), p, p + kSegment);
+        }
+        return LzDictionary(std::move(content));
+    }
+
+    const std::uint8_t* data() const noexcept { return content_.data(); }
+
+    std::size_t size() const noexcept { return content_.size(); }
+
+    bool empty() const noexcept { return content_.empty(); }
+
+    const std::vector<std::uint32_t>& table() const noexcept { return table_; }
+
+private:
+    std::vector<std::uint8_t> content_;
+    // 哈希桶里存 position + 1，0 表示空桶。
+    std::vector<std::uint32_t> table_;
+};
+
+inline std::uint8_t* LzWriteLength(std::uint8_t* op, std::size_t len) noexcept {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = static_cast<std::uint8_t>(len);
+    return op;
+}
+
+// 压缩 src[0, n) 到 dst，dst 至少需要 LzCompressBound(n) 字节。
+// 返回压缩后长度；dictionary 可为 nullptr。
+inline std::size_t LzCompress(const LzDictionary* dictionary,
+                              const std::uint8_t* src,
+                              std::size_t n,
+                              std::uint8_t* dst) {
+    // 窗口 = 字典 ++ 源数据，匹配只需在一段连续内存上进行。
+    thread_local std::vector<std::uint8_t> window;
+    thread_local std::vector<std::uint32_t> table;
+
+    const std::size_t dict_size = dictionary != nullptr ? dictionary->size() : 0;
+    window.resize(dict_size + n);
+    if (dict_size != 0) {
+        std::memcpy(window.data(), dictionary->data(), dict_size);
+        table = dictionary->table();
+    } else {
+        table.assign(kLzHashSize, 0);
+    }
+    if (n != 0) {
+        std::memcpy(window.data() + dict_size, src, n);
+    }
+
+    const std::uint8_t* base = window.data();
+    const std::size_t end = dict_size + n;
+    std::size_t ip = dict_size;
+    std::size_t anchor = dict_size;
+    std::uint8_t* op = dst;
+
+    const auto emit = [&](std::size_t literal_len, std::size_t offset, std::size_t match_len) {
+        std::uint8_t* token = op++;
+        const std::size_t ml = match_len - kLzMinMatch;
+        *token = static_cast<std::uint8_t>((std::min<std::size_t>(literal_len, 15) << 4) |
+                                           std::min<std::size_t>(ml, 15));
+        if (literal_len >= 15) {
+            op = LzWriteLength(op, literal_len - 15);
+        }
+        std::memcpy(op, base + anchor, literal_len);
+        op += literal_len;
+        *op++ = static_cast<std::uint8_t>(offset & 0xff);
+        *op++ = static_cast<std::uint8_t>(offset >> 8);
+        if (ml >= 15) {
+            op = LzWriteLength(op, ml - 15);
+        }
+    };
+
+    while (ip + kLzMinMatch <= end) {
+        const std::uint32_t h = LzHash4(base + ip);
+        const std::uint32_t ref_plus_one = table[h];
+        table[h] = static_cast<std::uint32_t>(ip + 1);
+        if (ref_plus_one == 0 || ip - (ref_plus_one - 1) > kLzMaxOffset ||
+            LzRead32(base + ref_plus_one - 1) != LzRead32(base + ip)) {
+            // 长时间无匹配时逐步加大步长，避免在不可压缩数据上浪费 CPU。
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+
+        std::size_t ref = ref_plus_one - 1;
+        std::size_t len = kLzMinMatch;
+        while (ip + len < end && base[ref + len] == base[ip + len]) {
+            ++len;
+        }
+        while (ip > anchor && ref > 0 && base[ip - 1] == base[ref - 1]) {
+            --ip;
+            --ref;
+            ++len;
+        }
+
+        emit(ip - anchor, ip - ref, len);
+        const std::size_t match_end = ip + len;
+        // 稀疏回填匹配区间内的哈希，兼顾压缩率与速度。
+        for (std::size_t p = ip + 1; p + kLzMinMatch <= end && p < match_end; p += 4) {
+            table[LzHash4(base + p)] = static_cast<std::uint32_t>(p + 1);
+        }
+        ip = match_end;
+        anchor = ip;
+    }
+
+    const std::size_t literal_len = end - anchor;
+    std::uint8_t* token = op++;
+    *token = static_cast<std::uint8_t>(std::min<std::size_t>(literal_len, 15) << 4);
+    if (literal_len >= 15) {
+        op = LzWriteLength(op, literal_len - 15);
+    }
+    if (literal_len != 0) {
+        std::memcpy(op, base + anchor, literal_len);
+        op += literal_len;
+    }
+    return static_cast<std::size_t>(op - dst);
+}
+
+// 解压到调用方缓冲区 dst（恰好 raw_size 字节）。
+// 输入损坏、字典不匹配或输出越界时返回 false。
+inline bool LzDecompress(const LzDictionary* dictionary,
+                         const std::uint8_t* src,
+                         std::size_t n,
+                         std::uint8_t* dst,
+                         std::size_t raw_size) noexcept {
+    const auto read_length = [&](std::size_t& ip, std::size_t& len) noexcept {
+        std::uint8_t b = 255;
+        while (b == 255) {
+            if (ip >= n) {
+                return false;
+            }
+            b = src[ip++];
+            len += b;
+        }
+        return true;
+    };
+
+    std::size_t ip = 0;
+    std::size_t op = 0;
+    while (ip < n) {
+        const std::uint8_t token = src[ip++];
+        std::size_t literal_len = token >> 4;
+        if (literal_len == 15 && !read_length(ip, literal_len)) {
+            return false;
+        }
+        if (literal_len > n - ip || literal_len > raw_size - op) {
+            return false;
+        }
+        std::memcpy(dst + op, src + ip, literal_len);
+        ip += literal_len;
+        op += literal_len;
+        if (ip == n) {
+            break;
+        }
+
+        if (n - ip < 2) {
+            return false;
+        }
+        const std::size_t offset = static_cast<std::size_t>(src[ip]) |
+                                   (static_cast<std::size_t>(src[ip + 1]) << 8);
+        ip += 2;
+        std::size_t match_len = token & 15;
+        if (match_len == 15 && !read_length(ip, match_len)) {
+            return false;
+        }
+        match_len += kLzMinMatch;
+        if (offset == 0 || match_len > raw_size - op) {
+            return false;
+        }
+
+        if (offset > op) {
+            // 匹配起点落在字典里；可能跨越字典尾部继续进入输出区。
+            const std::size_t back = offset - op;
+            if (dictionary == nullptr || back > dictionary->size()) {
+                return false;
+            }
+            const std::size_t from_dict = std::min(match_len, back);
+            std::memcpy(dst + op, dictionary->data() + dictionary->size() - back, from_dict);
+            op += from_dict;
+            match_len -= from_dict;
+            if (match_len == 0) {
+                continue;
+            }
+        }
+
+        std::uint8_t* out = dst + op;
+        const std::uint8_t* match = out - offset;
+        if (offset >= match_len) {
+            std::memcpy(out, match, match_len);
+        } else {
+            for (std::size_t i = 0; i < match_len; ++i) {
+                out[i] = match[i];
+            }
+        }
+        op += match_len;
+    }
+    return op == raw_size;
+}
+
+}  // namespace detail（内部实现）
+}  // namespace kvcache（KV 缓存命名空间）
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "compressed_fd_kv_cache.h"
 #include "fd_kv_cache_single.h"
+#include "incremental_aggregate.h"
 #include "sharded_fd_kv_cache.h"
 
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace kvcache {
+
+// 按组增量维护的聚合状态（COUNT 与若干 SUM/AVG），配合带变更通知的写接口使用：
+// 每次写入只撤出旧行的贡献、加入新行的贡献，读聚合结果是 O(groups)。
+//
+// 度量值按 scale 转成 int64 定点数后累加：加减可交换且无舍入误差，
+// 任意顺序的插入/更新/删除之后，状态与对当前全部行重新聚合完全一致。
+// scale 取度量的有效小数位（例如已 ROUND 到 2 位的比值取 100）。
+//
+// 每组的计数器独占缓存行，不同 shard 的写入并发更新时只在同组上竞争。
+// 各计数器独立原子更新，并发写入期间读到的是逐组近似一致的值。
+class IncrementalAggregate {
+public:
+    IncrementalAggregate(std::size_t groups, std::size_t measures, double scale = 100.0)
+        : groups_(groups),
+          measures_(measures),
+          lines_per_group_((1 + 2 * measures + kCellsPerLine - 1) / kCellsPerLine),
+          scale_(scale),
+          lines_(std::make_unique<Line[]>(groups * lines_per_group_)) {
+        for (std::size_t i = 0; i < groups_ * lines_per_group_; ++i) {
+            for (std::atomic<std::int64_t>& cell : lines_[i].cells) {
+                cell.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::size_t groups() const noexcept { return groups_; }
+    std::size_t measures() const noexcept { return measures_; }
+
+    // sign = +1 加入一行、-1 撤出一行；values 中的 NaN 视为 NULL，不计入该度量。
+    void Apply(std::uint32_t group, const double* values, std::int64_t sign) noexcept {
+        Cell(group, 0).fetch_add(sign, std::memory_order_relaxed);
+        for (std::size_t m = 0; m < measures_; ++m) {
+            if (std::isnan(values[m])) {
+                continue;
+            }
+            Cell(group, 1 + 2 * m).fetch_add(sign, std::memory_order_relaxed);
+            Cell(group, 2 + 2 * m).fetch_add(sign * ToFixed(values[m]),
+                                             std::memory_order_relaxed);
+        }
+    }
+
+    std::int64_t count(std::uint32_t group) const noexcept {
+        return Cell(group, 0).load(std::memory_order_relaxed);
+    }
+
+    std::int64_t non_null(std::uint32_t group, std::size_t measure) const noexcept {
+        return Cell(group, 1 + 2 * measure).load(std::memory_order_relaxed);
+    }
+
+    double Sum(std::uint32_t group, std::size_t measure) const noexcept {
+        return static_cast<double>(Cell(group, 2 + 2 * measure).load(std::memory_order_relaxed)) /
+               scale_;
+    }
+
+    // 与 SQL AVG 一致：只对非 NULL 值取平均，全为 NULL 时结果为 NULL（NaN）。
+    double Avg(std::uint32_t group, std::size_t measure) const noexcept {
+        const std::int64_t n = non_null(group, measure);
+        return n == 0 ? std::numeric_limits<double>::quiet_NaN()
+                      : Sum(group, measure) / static_cast<double>(n);
+    }
+
+private:
+    static constexpr std::size_t kCellsPerLine = 8;
+
+    // 每组占若干整条缓存行：[count, non_null_0, sum_0, non_null_1, sum_1, ...]。
+    struct alignas(64) Line {
+        std::atomic<std::int64_t> cells[kCellsPerLine];
+    };
+
+    std::atomic<std::int64_t>& Cell(std::uint32_t group, std::size_t i) const noexcept {
+        return lines_[group * lines_per_group_ + i / kCellsPerLine].cells[i % kCellsPerLine];
+    }
+
+    std::int64_t ToFixed(double v) const noexcept { return std::llround(v * scale_); }
+
+    std::size_t groups_;
+    std::size_t measures_;
+    std::size_t lines_per_group_;
+    double scale_;
+    std::unique_ptr<Line[]> lines_;
+};
+
+}  // namespace kvcache（KV 缓存命名空间）
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -8,9 +9,11 @@
 #include <mutex>
 #include <shared_mutex>
 #include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "cache_columns.h"
 #include "detail/flat_index_map.h"
 #include "fd_token.h"
 
@@ -53,14 +56,36 @@ public:
 
     bool empty() const noexcept { return size() == 0; }
 
+    std::size_t shard_count() const noexcept { return shard_count_; }
+
+    // key 所属 shard 的下标；供上层维护按 shard 划分的辅助状态（如压缩字典）。
+    std::size_t ShardIndexForKey(const Key& key) const noexcept { return ShardForKey(key); }
+
     // 按 key 插入/更新，成功返回token。
     // 当目标 shard 容量满时返回 kNull。
     handle_type Insert(std::uint8_t type, const Key& key, const Value& value) {
-        return InsertImpl(type, key, value, false);
+        return InsertImpl(type, key, value, false, NoChangeObserver{});
     }
 
     handle_type InsertOrAssign(std::uint8_t type, const Key& key, const Value& value) {
-        return InsertImpl(type, key, value, true);
+        return InsertImpl(type, key, value, true, NoChangeObserver{});
+    }
+
+    // 带变更通知的写接口：on_change(old_value, new_value) 在 shard 独占锁内、
+    // 写入生效后立即调用；old 为 nullptr 表示新插入，new 为 nullptr 表示删除。
+    // 同一 key 的通知与写入同序，上层可据此按 delta 增量维护聚合等派生状态。
+    // 回调在锁内执行，应只做 O(1) 的轻量更新。
+    template <typename OnChange>
+    handle_type Insert(std::uint8_t type, const Key& key, const Value& value, OnChange&& on_change) {
+        return InsertImpl(type, key, value, false, on_change);
+    }
+
+    template <typename OnChange>
+    handle_type InsertOrAssign(std::uint8_t type,
+                               const Key& key,
+                               const Value& value,
+                               OnChange&& on_change) {
+        return InsertImpl(type, key, value, true, on_change);
     }
 
     // 便捷读接口：按 handle 读取到 out_value。
@@ -112,12 +137,24 @@ public:
         return Write(handle, [&](Value& v) { v = value; });
     }
 
+    template <typename OnChange>
+    bool Update(handle_type handle, const Value& value, OnChange&& on_change) {
+        return Write(handle, [&](Value& v) {
+            const Value old_value = std::move(v);
+            v = value;
+            on_change(&old_value, &v);
+        });
+    }
+
     bool Add(handle_type handle, const Value& delta) {
         return Write(handle, [&](Value& v) { v += delta; });
     }
 
     // 按 handle 删除并递增 generation，使旧 fd token 失效。
-    bool Erase(handle_type handle) {
+    bool Erase(handle_type handle) { return Erase(handle, NoChangeObserver{}); }
+
+    template <typename OnChange>
+    bool Erase(handle_type handle, OnChange&& on_change) {
         const auto [shard_id, local] = DecodePosition(handle);
         if (!ValidShardId(shard_id) || local >= per_shard_capacity_) {
             return false;
@@ -138,6 +175,9 @@ public:
         slot.generation = NextGeneration(slot.generation);
         shard.free_positions.push_back(local);
         size_.fetch_sub(1, std::memory_order_relaxed);
+        on_change(&slot.value, static_cast<const Value*>(nullptr));
+        // 立即释放旧值持有的资源（如压缩负载与字典引用），不等到槽位被复用。
+        slot.value = Value{};
         return true;
     }
 
@@ -155,6 +195,151 @@ public:
         return BuildHandle(slot.type, slot.generation, shard_id, local);
     }
 
+    // 在单个 shard 的共享锁内按槽位顺序遍历存活条目：fn(handle, key, value)。
+    // 供逐 shard 推进的全表扫描使用（每次只锁一个 shard），fn 应尽量轻量。
+    template <typename Fn>
+    void ForEachInShard(std::size_t shard_id, Fn&& fn) const {
+        if (shard_id >= shard_count_) {
+            return;
+        }
+        const Shard& shard = shards_[shard_id];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (std::uint32_t local = 0; local < shard.next_unused; ++local) {
+            const Slot& slot = shard.slots[local];
+            if (slot.occupied == 0) {
+                continue;
+            }
+            fn(BuildHandle(slot.type, slot.generation, static_cast<std::uint32_t>(shard_id), local),
+               slot.key, slot.value);
+        }
+    }
+
+    // 将全部存活条目导出为列式数组，返回导出的条数。
+    // 导出期间按 shard 顺序持有所有共享锁，得到一致快照；
+    // 各 shard 的槽位由 thread_count 个线程并行拷贝到各自的连续区间。
+    std::size_t ExportColumns(CacheColumns<Key, Value>* out,
+                              std::size_t thread_count = 0) const {
+        if (out == nullptr) {
+            return 0;
+        }
+
+        std::vector<std::shared_lock<std::shared_mutex>> locks;
+        locks.reserve(shard_count_);
+        std::vector<std::size_t> offsets(shard_count_ + 1, 0);
+        for (std::size_t i = 0; i < shard_count_; ++i) {
+            locks.emplace_back(shards_[i].mutex);
+            offsets[i + 1] = offsets[i] + shards_[i].key_to_local.size();
+        }
+        out->resize(offsets[shard_count_]);
+
+        RunWorkers(WorkerCount(thread_count, shard_count_),
+                   [&](std::size_t worker, std::size_t workers) {
+            for (std::size_t shard_id = worker; shard_id < shard_count_; shard_id += workers) {
+                const Shard& shard = shards_[shard_id];
+                std::size_t row = offsets[shard_id];
+                for (std::uint32_t local = 0; local < shard.next_unused; ++local) {
+                    const Slot& slot = shard.slots[local];
+                    if (slot.occupied == 0) {
+                        continue;
+                    }
+                    out->keys[row] = slot.key;
+                    out->values[row] = slot.value;
+                    out->handles[row] = BuildHandle(slot.type, slot.generation,
+                                                    static_cast<std::uint32_t>(shard_id), local);
+                    out->types[row] = slot.type;
+                    ++row;
+                }
+            }
+        });
+        return offsets[shard_count_];
+    }
+
+    // 从列数组批量写入（语义同逐行 InsertOrAssign），返回成功写入的条数。
+    // 先按 shard 对行号做并行计数排序，再由各线程按 shard 一次加锁批量插入。
+    // out_handles 可为 nullptr；否则按输入顺序写回句柄，失败行为 kNull。
+    std::size_t ImportColumns(const std::uint8_t* types,
+                              const Key* keys,
+                              const Value* values,
+                              std::size_t n,
+                              handle_type* out_handles = nullptr,
+                              std::size_t thread_count = 0) {
+        if (n == 0) {
+            return 0;
+        }
+
+        const std::size_t workers = WorkerCount(thread_count, n);
+        const std::size_t chunk = (n + workers - 1) / workers;
+        std::vector<std::uint32_t> shard_of(n);
+        std::vector<std::size_t> histogram(workers * shard_count_, 0);
+        RunWorkers(workers, [&](std::size_t worker, std::size_t) {
+            const std::size_t begin = std::min(n, worker * chunk);
+            const std::size_t end = std::min(n, begin + chunk);
+            std::size_t* local_histogram = &histogram[worker * shard_count_];
+            for (std::size_t i = begin; i < end; ++i) {
+                shard_of[i] = ShardForKey(keys[i]);
+                ++local_histogram[shard_of[i]];
+            }
+        });
+
+        // 列优先前缀和：shard 的行连续，且 shard 内保持输入顺序。
+        std::vector<std::size_t> shard_begin(shard_count_ + 1, 0);
+        std::size_t running = 0;
+        for (std::size_t s = 0; s < shard_count_; ++s) {
+            shard_begin[s] = running;
+            for (std::size_t w = 0; w < workers; ++w) {
+                const std::size_t count = histogram[w * shard_count_ + s];
+                histogram[w * shard_count_ + s] = running;
+                running += count;
+            }
+        }
+        shard_begin[shard_count_] = running;
+
+        std::vector<std::uint32_t> order(n);
+        RunWorkers(workers, [&](std::size_t worker, std::size_t) {
+            const std::size_t begin = std::min(n, worker * chunk);
+            const std::size_t end = std::min(n, begin + chunk);
+            std::size_t* cursor = &histogram[worker * shard_count_];
+            for (std::size_t i = begin; i < end; ++i) {
+                order[cursor[shard_of[i]]++] = static_cast<std::uint32_t>(i);
+            }
+        });
+
+        std::atomic<std::size_t> imported{0};
+        RunWorkers(WorkerCount(thread_count, shard_count_),
+                   [&](std::size_t worker, std::size_t stride) {
+            std::size_t ok = 0;
+            for (std::size_t shard_id = worker; shard_id < shard_count_; shard_id += stride) {
+                Shard& shard = shards_[shard_id];
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                for (std::size_t r = shard_begin[shard_id]; r < shard_begin[shard_id + 1]; ++r) {
+                    const std::uint32_t row = order[r];
+                    const handle_type handle =
+                        InsertLocked(shard, static_cast<std::uint32_t>(shard_id),
+                                     types[row], keys[row], values[row], true,
+                                     NoChangeObserver{});
+                    if (out_handles != nullptr) {
+                        out_handles[row] = handle;
+                    }
+                    ok += static_cast<std::size_t>(!FdToken::IsNull(handle));
+                }
+            }
+            imported.fetch_add(ok, std::memory_order_relaxed);
+        });
+        return imported.load(std::memory_order_relaxed);
+    }
+
+    std::size_t ImportColumns(const CacheColumns<Key, Value>& columns,
+                              std::vector<handle_type>* out_handles = nullptr,
+                              std::size_t thread_count = 0) {
+        if (out_handles != nullptr) {
+            out_handles->assign(columns.size(), FdToken::kNull);
+        }
+        return ImportColumns(columns.types.data(), columns.keys.data(), columns.values.data(),
+                             columns.size(),
+                             out_handles != nullptr ? out_handles->data() : nullptr,
+                             thread_count);
+    }
+
     static std::size_t DefaultShardCount() noexcept {
         const auto hc = std::thread::hardware_concurrency();
         return hc == 0 ? 4u : static_cast<std::size_t>(hc);
@@ -285,21 +470,49 @@ private:
         return FdToken::Make(type, generation, EncodePosition(shard_id, local));
     }
 
+    // 不带通知的写接口使用的空观察者；写路径据此跳过旧值的保存。
+    struct NoChangeObserver {
+        void operator()(const Value*, const Value*) const noexcept {}
+    };
+
+    template <typename OnChange>
+    static constexpr bool kObserved =
+        !std::is_same<std::decay_t<OnChange>, NoChangeObserver>::value;
+
     // Insert / InsertOrAssign 的共享实现。
+    template <typename OnChange>
     handle_type InsertImpl(std::uint8_t type,
                            const Key& key,
                            const Value& value,
-                           bool assign_if_exists) {
+                           bool assign_if_exists,
+                           OnChange&& on_change) {
         const std::uint32_t shard_id = ShardForKey(key);
         Shard& shard = shards_[shard_id];
         std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return InsertLocked(shard, shard_id, type, key, value, assign_if_exists, on_change);
+    }
 
+    // 调用方已持有 shard 独占锁；单条写入与批量导入共用。
+    template <typename OnChange>
+    handle_type InsertLocked(Shard& shard,
+                             std::uint32_t shard_id,
+                             std::uint8_t type,
+                             const Key& key,
+                             const Value& value,
+                             bool assign_if_exists,
+                             OnChange&& on_change) {
         std::uint32_t local = 0;
         if (shard.key_to_local.Find(key, &local)) {
             Slot& slot = shard.slots[local];
             if (assign_if_exists) {
-                slot.value = value;
                 slot.type = type;
+                if constexpr (kObserved<OnChange>) {
+                    const Value old_value = std::move(slot.value);
+                    slot.value = value;
+                    on_change(&old_value, &slot.value);
+                } else {
+                    slot.value = value;
+                }
             }
             return BuildHandle(slot.type, slot.generation, shard_id, local);
         }
@@ -320,8 +533,34 @@ private:
             return FdToken::kNull;
         }
         size_.fetch_add(1, std::memory_order_relaxed);
+        on_change(static_cast<const Value*>(nullptr), &slot.value);
         return BuildHandle(type, slot.generation, shard_id, local);
     }
+
+    // 批量接口的并行度：默认取硬件线程数，且不超过 limit。
+    static std::size_t WorkerCount(std::size_t thread_count, std::size_t limit) noexcept {
+        if (thread_count == 0) {
+            thread_count = DefaultShardCount();
+        }
+        if (thread_count > limit) {
+            thread_count = limit;
+        }
+        return thread_count == 0 ? 1 : thread_count;
+    }
+
+    // 启动 workers 个线程执行 fn(worker, workers)；worker 0 在调用线程上运行。
+    template <typename Fn>
+    static void RunWorkers(std::size_t workers, Fn&& fn) {
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (std::size_t w = 1; w < workers; ++w) {
+            threads.emplace_back([&fn, w, workers]() { fn(w, workers); });
+        }
+        fn(0, workers);
+        for (std::thread& t : threads) {
+            t.join();
+        }
+    }
 };
 
 }  // namespace kvcache（KV 缓存命名空间）
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+
+#include "detail/flat_index_map.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace kvcache {
+namespace detail {
+
+inline void SpinPause() noexcept {
+#if defined(__x86_64__) || defined(_M_X64)
+    _mm_pause();
+#endif
+}
+
+// 只追加的字符串区：按块分配，块一经分配地址不变，字符串视图在整个生命周期内有效。
+// 块内用原子 bump 指针分配，只有换块时才加锁，多个写线程可以并发 Allocate。
+class StringArena {
+public:
+    static constexpr std::size_t kBlockSize = 64 * 1024;
+
+    StringArena() = default;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    // 非并发：只在没有其他线程访问时移动。
+    StringArena(StringArena&& other) noexcept
+        : blocks_(std::move(other.blocks_)),
+          current_(other.current_.exchange(nullptr, std::memory_order_relaxed)),
+          bytes_(other.bytes_.exchange(0, std::memory_order_relaxed)) {}
+
+    StringArena& operator=(StringArena&& other) noexcept {
+        blocks_ = std::move(other.blocks_);
+        current_.store(other.current_.exchange(nullptr, std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+        bytes_.store(other.bytes_.exchange(0, std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+        return *this;
+    }
+
+    const char* Append(std::string_view s) {
+        char* p = Allocate(s.size());
+        if (!s.empty()) {
+            std::memcpy(p, s.data(), s.size());
+        }
+        return p;
+    }
+
+    // 已写入的字符串字节数（不含块尾浪费）。
+    std::size_t bytes() const noexcept { return bytes_.load(std::memory_order_relaxed); }
+
+    std::size_t reserved_bytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t total = 0;
+        for (const Block& b : blocks_) {
+            total += b.capacity;
+        }
+        return total;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        std::size_t capacity{0};
+        std::atomic<std::size_t> used{0};
+
+        explicit Block(std::size_t n) : data(new char[n]), capacity(n) {}
+    };
+
+    char* Allocate(std::size_t n) {
+        bytes_.fetch_add(n, std::memory_order_relaxed);
+        for (;;) {
+            Block* block = current_.load(std::memory_order_acquire);
+            if (block != nullptr) {
+                const std::size_t offset = block->used.fetch_add(n, std::memory_order_relaxed);
+                if (offset + n <= block->capacity) {
+                    return block->data.get() + offset;
+                }
+            }
+            // 当前块放不下：加锁换块。别的线程可能已经换过，重新检查即可。
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (current_.load(std::memory_order_relaxed) == block) {
+                blocks_.emplace_back(n > kBlockSize ? n : kBlockSize);
+                current_.store(&blocks_.back(), std::memory_order_release);
+            }
+        }
+    }
+
+    // deque 尾部追加不移动已有元素，current_ 指向的 Block 始终有效。
+    std::deque<Block> blocks_;
+    std::atomic<Block*> current_{nullptr};
+    std::atomic<std::size_t> bytes_{0};
+    mutable std::mutex mutex_;
+};
+
+}  // namespace detail（内部实现）
+
+// 并发字符串字典：字符串 -> 从 0 开始的 dense id（uint32）。
+// - 字符串只追加进 StringArena，id -> (指针, 长度) 存在定长数组里，Decode 是一次数组访问；
+// - 索引沿用 FlatIndexMap 的布局（固定容量、2 倍桶数、2 的幂、线性探测、不扩容），
+//   但只插入不删除，每个桶是一个 64 位原子字：高 32 位为哈希标签，低 32 位为 id+1；
+// - Find/Decode 无锁：读线程只做 acquire 读，从不等待；
+// - Encode 可多线程并发：先 CAS 占桶（标记为 busy），再分配 id、写入字符串，
+//   最后 release 发布。另一个线程插入同一字符串时会在 busy 桶上自旋到发布为止。
+// 容量在 Reserve 时确定，写满后 Encode 返回 kInvalidCode；Reserve 本身不是线程安全的，
+// 需在没有并发访问时调用（例如批量导入前按行数预留）。
+// 并发写入时 id 的分配顺序取决于线程交错，单线程写入时按首次出现顺序分配。
+template <typename Hash = std::hash<std::string_view>>
+class StringDictionary {
+public:
+    static constexpr std::uint32_t kInvalidCode = 0xffffffffu;
+
+    StringDictionary() = default;
+
+    explicit StringDictionary(std::size_t max_entries) { Reserve(max_entries); }
+
+    StringDictionary(const StringDictionary&) = delete;
+    StringDictionary& operator=(const StringDictionary&) = delete;
+
+    StringDictionary(StringDictionary&& other) noexcept { *this = std::move(other); }
+
+    // 非并发。
+    StringDictionary& operator=(StringDictionary&& other) noexcept {
+        arena_ = std::move(other.arena_);
+        strings_ = std::move(other.strings_);
+        slots_ = std::move(other.slots_);
+        capacity_ = std::exchange(other.capacity_, 0);
+        mask_ = std::exchange(other.mask_, 0);
+        size_.store(other.size_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        reserved_.store(other.reserved_.exchange(0, std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+        return *this;
+    }
+
+    // 把容量扩到至少 max_entries（只增不减）并重建索引。非并发。
+    void Reserve(std::size_t max_entries) {
+        if (max_entries <= capacity_) {
+            return;
+        }
+        if (max_entries >= kBusy) {
+            max_entries = kBusy - 1;
+        }
+        std::unique_ptr<StringRef[]> strings(new StringRef[max_entries]);
+        const std::size_t n = size();
+        for (std::size_t i = 0; i < n; ++i) {
+            strings[i] = strings_[i];
+        }
+        const std::size_t buckets = detail::NextPowerOfTwo(max_entries * 2);
+        std::unique_ptr<std::atomic<std::uint64_t>[]> slots(
+            new std::atomic<std::uint64_t>[buckets]);
+        for (std::size_t i = 0; i < buckets; ++i) {
+            slots[i].store(0, std::memory_order_relaxed);
+        }
+        strings_ = std::move(strings);
+        slots_ = std::move(slots);
+        capacity_ = max_entries;
+        mask_ = buckets - 1;
+        for (std::size_t id = 0; id < n; ++id) {
+            const std::string_view s = Decode(static_cast<std::uint32_t>(id));
+            const std::size_t h = hasher_(s);
+            std::size_t idx = h & mask_;
+            while (slots_[idx].load(std::memory_order_relaxed) != 0) {
+                idx = (idx + 1) & mask_;
+            }
+            slots_[idx].store(Pack(h, static_cast<std::uint32_t>(id)), std::memory_order_relaxed);
+        }
+    }
+
+    // 已分配的 id 数。并发写入时，刚分配的 id 可能还未发布。
+    std::size_t size() const noexcept { return size_.load(std::memory_order_acquire); }
+    std::size_t capacity() const noexcept { return capacity_; }
+    std::size_t string_bytes() const noexcept { return arena_.bytes(); }
+
+    // 返回 s 的 id，不存在则插入；容量已满时返回 kInvalidCode。线程安全。
+    std::uint32_t Encode(std::string_view s) { return Insert(s, true); }
+
+    // 同 Encode，但新字符串不拷进 arena，直接引用 s 指向的内存（如 mmap 的字典页），
+    // 调用方保证该内存比字典活得更久。
+    std::uint32_t EncodeView(std::string_view s) { return Insert(s, false); }
+
+    // 无锁查找；不存在（或正在被其他线程插入）时返回 kInvalidCode。
+    std::uint32_t Find(std::string_view s) const noexcept {
+        if (capacity_ == 0) {
+            return kInvalidCode;
+        }
+        const std::size_t h = hasher_(s);
+        const std::uint32_t tag = Tag(h);
+        for (std::size_t idx = h & mask_;; idx = (idx + 1) & mask_) {
+            const std::uint64_t slot = slots_[idx].load(std::memory_order_acquire);
+            if (slot == 0) {
+                return kInvalidCode;
+            }
+            const auto low = static_cast<std::uint32_t>(slot);
+            if (low != kBusy && static_cast<std::uint32_t>(slot >> 32) == tag &&
+                Decode(low - 1) == s) {
+                return low - 1;
+            }
+        }
+    }
+
+    // id 须来自 Encode/Find 的返回值（或单线程写入后小于 size()）。
+    std::string_view Decode(std::uint32_t id) const noexcept {
+        const StringRef& r = strings_[id];
+        return std::string_view(r.data, r.size);
+    }
+
+    // 批量编码一列；遇到容量不足时停止，返回成功编码的个数。线程安全。
+    std::size_t EncodeBatch(const std::string_view* in, std::size_t n, std::uint32_t* out) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = Encode(in[i]);
+            if (out[i] == kInvalidCode) {
+                return i;
+            }
+        }
+        return n;
+    }
+
+    // 批量查找；不存在的位置写 kInvalidCode。
+    void FindBatch(const std::string_view* in, std::size_t n, std::uint32_t* out) const noexcept {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = Find(in[i]);
+        }
+    }
+
+    void DecodeBatch(const std::uint32_t* ids, std::size_t n, std::string_view* out) const noexcept {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = Decode(ids[i]);
+        }
+    }
+
+private:
+    static constexpr std::uint32_t kBusy = 0xffffffffu;
+
+    struct StringRef {
+        const char* data{nullptr};
+        std::uint32_t size{0};
+    };
+
+    // 标签取哈希高 32 位：桶下标用的是低位，两者独立，标签不同即可跳过字符串比较。
+    static std::uint32_t Tag(std::size_t h) noexcept {
+        if constexpr (sizeof(std::size_t) >= 8) {
+            return static_cast<std::uint32_t>(static_cast<std::uint64_t>(h) >> 32);
+        } else {
+            return static_cast<std::uint32_t>(h * 0x9e3779b9u);
+        }
+    }
+
+    // copy = false 时字符串不进 arena。
+    std::uint32_t Insert(std::string_view s, bool copy) {
+        if (capacity_ == 0) {
+            return kInvalidCode;
+        }
+        const std::size_t h = hasher_(s);
+        const std::uint32_t tag = Tag(h);
+        std::size_t idx = h & mask_;
+        for (;;) {
+            std::uint64_t slot = slots_[idx].load(std::memory_order_acquire);
+            if (slot == 0) {
+                if (reserved_.fetch_add(1, std::memory_order_relaxed) >= capacity_) {
+                    reserved_.fetch_sub(1, std::memory_order_relaxed);
+                    return kInvalidCode;
+                }
+                const std::uint64_t busy = (static_cast<std::uint64_t>(tag) << 32) | kBusy;
+                if (slots_[idx].compare_exchange_strong(slot, busy, std::memory_order_acq_rel,
+                                                        std::memory_order_acquire)) {
+                    const auto id = static_cast<std::uint32_t>(
+                        size_.fetch_add(1, std::memory_order_relaxed));
+                    strings_[id] = StringRef{copy ? arena_.Append(s) : s.data(),
+                                             static_cast<std::uint32_t>(s.size())};
+                    slots_[idx].store(Pack(h, id), std::memory_order_release);
+                    return id;
+                }
+                // 桶被别的线程抢先占用：归还名额，按新值重新判断这个桶。
+                reserved_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            if (static_cast<std::uint32_t>(slot >> 32) == tag) {
+                while ((slot & 0xffffffffu) == kBusy) {
+                    detail::SpinPause();
+                    slot = slots_[idx].load(std::memory_order_acquire);
+                }
+                const auto id = static_cast<std::uint32_t>(slot) - 1;
+                if (Decode(id) == s) {
+                    return id;
+                }
+            }
+            idx = (idx + 1) & mask_;
+        }
+    }
+
+    // 发布后的桶值：低 32 位 id+1 取值 [1, kBusy)，因此非空桶永远不为 0。
+    static std::uint64_t Pack(std::size_t h, std::uint32_t id) noexcept {
+        return (static_cast<std::uint64_t>(Tag(h)) << 32) | (static_cast<std::uint64_t>(id) + 1);
+    }
+
+    detail::StringArena arena_;
+    std::unique_ptr<StringRef[]> strings_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> slots_;
+    std::size_t capacity_{0};
+    std::size_t mask_{0};
+    std::atomic<std::size_t> size_{0};
+    // 已占用（含 busy）的名额，保证占桶数不超过容量，id 因此总是 dense 的。
+    std::atomic<std::size_t> reserved_{0};
+    Hash hasher_{};
+};
+
+}  // namespace kvcache（KV 缓存命名空间）
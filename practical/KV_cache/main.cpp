@@ -1,17 +1,22 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <map>
 #include <mutex>
 #include <shared_mutex>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <benchmark/benchmark.h>
 
 #include "fd_kv_cache.h"
 #include "fd_token.h"
+#include "string_dictionary.h"
 
 namespace {
 
@@ -440,6 +445,347 @@ void BM_MT_Map_Update(benchmark::State& state) {
 }
 BENCHMARK(BM_MT_Map_Update)->ThreadRange(1, MaxBenchThreads())->Unit(benchmark::kMicrosecond);
 
+// 分析侧的现状：拿着全部句柄逐条 Get，结果写入列数组。
+void BM_FdKV_GetPerHandle(benchmark::State& state) {
+    ConcurrentDataset& data = GetConcurrentDataset();
+    std::vector<Value> values(data.handles.size());
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < data.handles.size(); ++i) {
+            data.fd_cache.Get(data.handles[i], &values[i]);
+        }
+        benchmark::DoNotOptimize(values.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * data.handles.size()));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.handles.size() *
+                                                      sizeof(Value)));
+}
+BENCHMARK(BM_FdKV_GetPerHandle)->Unit(benchmark::kMicrosecond);
+
+// 列式导出：参数为导出线程数。
+void BM_FdKV_ExportColumns(benchmark::State& state) {
+    ConcurrentDataset& data = GetConcurrentDataset();
+    const std::size_t threads = static_cast<std::size_t>(state.range(0));
+    kvcache::CacheColumns<Key, Value> columns;
+    std::size_t rows = 0;
+    for (auto _ : state) {
+        rows = data.fd_cache.ExportColumns(&columns, threads);
+        benchmark::DoNotOptimize(columns.values.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+    state.SetBytesProcessed(static_cast<std::int64_t>(
+        state.iterations() * rows * (sizeof(Key) + sizeof(Value) + sizeof(Handle) + 1)));
+}
+BENCHMARK(BM_FdKV_ExportColumns)
+    ->RangeMultiplier(2)
+    ->Range(1, MaxBenchThreads())
+    ->Unit(benchmark::kMicrosecond);
+
+// 列式导入：用导出的快照重建一个新缓存；参数为导入线程数。
+void BM_FdKV_ImportColumns(benchmark::State& state) {
+    ConcurrentDataset& data = GetConcurrentDataset();
+    const std::size_t threads = static_cast<std::size_t>(state.range(0));
+    kvcache::CacheColumns<Key, Value> columns;
+    data.fd_cache.ExportColumns(&columns);
+    std::vector<Handle> handles;
+    std::size_t rows = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        kvcache::ShardedFdKVCache<Key, Value> cache(ConcurrentShardCount(), kItemCount);
+        state.ResumeTiming();
+
+        rows = cache.ImportColumns(columns, &handles, threads);
+        benchmark::DoNotOptimize(handles.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+BENCHMARK(BM_FdKV_ImportColumns)
+    ->RangeMultiplier(2)
+    ->Range(1, MaxBenchThreads())
+    ->Unit(benchmark::kMicrosecond);
+
+constexpr std::size_t kCompressedItemCount = 1u << 12;
+constexpr std::size_t kDictionarySampleCount = 512;
+
+// 生成 2–8KB 的 JSON 风格值：固定字段名 + 重复结构的事件数组，
+// 数值部分随机，模拟账户快照类的大 value。
+std::string MakeJsonValue(std::uint64_t seed) {
+    static constexpr const char* kKinds[] = {"purchase", "payment", "cash_advance", "refund"};
+    static constexpr const char* kMerchants[] = {"grocery", "fuel", "travel", "online_retail",
+                                                 "restaurant", "utilities"};
+    static constexpr const char* kStatus[] = {"settled", "pending", "reversed"};
+
+    std::uint64_t x = seed * 6364136223846793005ull + 1442695040888963407ull;
+    const auto next = [&x]() {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+        return x >> 33;
+    };
+
+    const std::size_t target = 2048 + static_cast<std::size_t>(next() % 6144);
+    std::string out;
+    out.reserve(target + 256);
+    out += "{\"cust_id\":\"C" + std::to_string(10000 + seed % 90000) + "\"";
+    out += ",\"balance\":" + std::to_string(next() % 2000000 / 100.0);
+    out += ",\"balance_frequency\":" + std::to_string((next() % 1000) / 1000.0);
+    out += ",\"credit_limit\":" + std::to_string(1000 + next() % 29000);
+    out += ",\"tenure\":" + std::to_string(6 + next() % 7);
+    out += ",\"events\":[";
+    bool first = true;
+    while (out.size() < target) {
+        if (!first) {
+            out += ',';
+        }
+        first = false;
+        out += "{\"ts\":" + std::to_string(1700000000 + next() % 31536000);
+        out += ",\"kind\":\"";
+        out += kKinds[next() % 4];
+        out += "\",\"merchant\":\"";
+        out += kMerchants[next() % 6];
+        out += "\",\"amount\":" + std::to_string(next() % 100000 / 100.0);
+        out += ",\"currency\":\"USD\",\"status\":\"";
+        out += kStatus[next() % 3];
+        out += "\"}";
+    }
+    out += "]}";
+    return out;
+}
+
+// 同一批 key/value 分别写入：不压缩、压缩无字典、压缩 + 按 shard 训练字典。
+struct CompressedDataset {
+    std::vector<Key> keys;
+    std::vector<std::string> values;
+    std::size_t raw_bytes{0};
+    kvcache::ShardedFdKVCache<Key, std::string> plain;
+    kvcache::CompressedFdKVCache<Key> untrained;
+    kvcache::CompressedFdKVCache<Key> trained;
+    std::vector<Handle> plain_handles;
+    std::vector<Handle> untrained_handles;
+    std::vector<Handle> trained_handles;
+
+    CompressedDataset()
+        : plain(ConcurrentShardCount(), kCompressedItemCount),
+          untrained(ConcurrentShardCount(), kCompressedItemCount),
+          trained(ConcurrentShardCount(), kCompressedItemCount) {
+        for (std::size_t i = 0; i < kCompressedItemCount; ++i) {
+            keys.push_back(static_cast<Key>(i) * 11400714819323198485ull + 0x9e3779b97f4a7c15ull);
+            values.push_back(MakeJsonValue(i));
+            raw_bytes += values.back().size();
+        }
+        trained.TrainDictionaries(Samples());
+        for (std::size_t i = 0; i < kCompressedItemCount; ++i) {
+            plain_handles.push_back(plain.Insert(kNodeType, keys[i], values[i]));
+            untrained_handles.push_back(untrained.Insert(kNodeType, keys[i], values[i]));
+            trained_handles.push_back(trained.Insert(kNodeType, keys[i], values[i]));
+        }
+    }
+
+    // 每个 shard 取约 kDictionarySampleCount / shard_count 个样本训练字典。
+    std::vector<std::pair<Key, std::string_view>> Samples() const {
+        std::vector<std::pair<Key, std::string_view>> samples;
+        const std::size_t stride =
+            std::max<std::size_t>(1, kCompressedItemCount / kDictionarySampleCount);
+        for (std::size_t i = 0; i < kCompressedItemCount; i += stride) {
+            samples.emplace_back(keys[i], values[i]);
+        }
+        return samples;
+    }
+
+    static double Ratio(const kvcache::CompressedFdKVCache<Key>& cache,
+                        const std::vector<Handle>& handles,
+                        std::size_t raw_bytes) {
+        std::size_t stored = 0;
+        for (const Handle handle : handles) {
+            std::size_t n = 0;
+            cache.StoredSize(handle, &n);
+            stored += n;
+        }
+        return stored == 0 ? 0.0 : static_cast<double>(raw_bytes) / static_cast<double>(stored);
+    }
+};
+
+CompressedDataset& GetCompressedDataset() {
+    static CompressedDataset data;
+    return data;
+}
+
+// Arg(0): 无字典；Arg(1): 先按 shard 训练字典再写入（训练耗时不计入）。
+void BM_Compressed_Insert(benchmark::State& state) {
+    CompressedDataset& data = GetCompressedDataset();
+    const bool train = state.range(0) != 0;
+    double ratio = 0.0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        kvcache::CompressedFdKVCache<Key> cache(ConcurrentShardCount(), kCompressedItemCount);
+        if (train) {
+            cache.TrainDictionaries(data.Samples());
+        }
+        std::vector<Handle> handles;
+        handles.reserve(kCompressedItemCount);
+        state.ResumeTiming();
+
+        for (std::size_t i = 0; i < kCompressedItemCount; ++i) {
+            handles.push_back(cache.Insert(kNodeType, data.keys[i], data.values[i]));
+        }
+
+        state.PauseTiming();
+        ratio = CompressedDataset::Ratio(cache, handles, data.raw_bytes);
+        state.ResumeTiming();
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.raw_bytes));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kCompressedItemCount));
+    state.counters["ratio"] = ratio;
+}
+BENCHMARK(BM_Compressed_Insert)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+void BM_Plain_LargeValue_Read(benchmark::State& state) {
+    CompressedDataset& data = GetCompressedDataset();
+    std::vector<char> buffer(16 * 1024);
+    for (auto _ : state) {
+        std::size_t total = 0;
+        for (const Handle handle : data.plain_handles) {
+            data.plain.Read(handle, [&](const std::string& v) {
+                std::memcpy(buffer.data(), v.data(), v.size());
+                total += v.size();
+            });
+        }
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.raw_bytes));
+    state.counters["ratio"] = 1.0;
+}
+BENCHMARK(BM_Plain_LargeValue_Read)->Unit(benchmark::kMicrosecond);
+
+void BM_Compressed_Read(benchmark::State& state) {
+    CompressedDataset& data = GetCompressedDataset();
+    const bool trained = state.range(0) != 0;
+    const kvcache::CompressedFdKVCache<Key>& cache = trained ? data.trained : data.untrained;
+    const std::vector<Handle>& handles = trained ? data.trained_handles : data.untrained_handles;
+    std::vector<char> buffer(16 * 1024);
+
+    for (auto _ : state) {
+        std::size_t total = 0;
+        for (const Handle handle : handles) {
+            std::size_t n = 0;
+            cache.Read(handle, buffer.data(), buffer.size(), &n);
+            total += n;
+        }
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.raw_bytes));
+    state.counters["ratio"] = CompressedDataset::Ratio(cache, handles, data.raw_bytes);
+}
+BENCHMARK(BM_Compressed_Read)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// cust_id 风格的字符串 id（"C" + 数字），字典编码与 unordered_map<string, uint32> 对照。
+constexpr std::size_t kDictItemCount = 1u << 18;
+
+struct StringDictDataset {
+    std::vector<std::string> ids;
+    std::vector<std::string_view> views;
+    std::vector<std::size_t> probes;
+    kvcache::StringDictionary<> dict{kDictItemCount};
+    std::unordered_map<std::string, std::uint32_t> unordered;
+
+    StringDictDataset() {
+        ids.reserve(kDictItemCount);
+        for (std::size_t i = 0; i < kDictItemCount; ++i) {
+            ids.push_back("C" + std::to_string(10001 + i * 7));
+        }
+        views.assign(ids.begin(), ids.end());
+        unordered.reserve(kDictItemCount);
+        for (std::size_t i = 0; i < kDictItemCount; ++i) {
+            dict.Encode(ids[i]);
+            unordered.emplace(ids[i], static_cast<std::uint32_t>(i));
+        }
+        std::uint64_t x = 0x51ed270b27a1c3f5ull;
+        for (std::size_t i = 0; i < kConcurrentProbeCount; ++i) {
+            x = x * 6364136223846793005ull + 1ull;
+            probes.push_back(static_cast<std::size_t>((x >> 17) & (kDictItemCount - 1)));
+        }
+    }
+};
+
+StringDictDataset& GetStringDictDataset() {
+    static StringDictDataset data;
+    return data;
+}
+
+// 整列编码进一个新字典（全部是新键）。
+void BM_StringDict_EncodeColumn(benchmark::State& state) {
+    StringDictDataset& data = GetStringDictDataset();
+    std::vector<std::uint32_t> codes(kDictItemCount);
+    for (auto _ : state) {
+        kvcache::StringDictionary<> dict(kDictItemCount);
+        dict.EncodeBatch(data.views.data(), kDictItemCount, codes.data());
+        benchmark::DoNotOptimize(codes.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kDictItemCount));
+}
+BENCHMARK(BM_StringDict_EncodeColumn)->Unit(benchmark::kMillisecond);
+
+void BM_UnorderedMap_EncodeColumn(benchmark::State& state) {
+    StringDictDataset& data = GetStringDictDataset();
+    std::vector<std::uint32_t> codes(kDictItemCount);
+    for (auto _ : state) {
+        std::unordered_map<std::string, std::uint32_t> dict;
+        dict.reserve(kDictItemCount);
+        for (std::size_t i = 0; i < kDictItemCount; ++i) {
+            codes[i] = dict.emplace(data.ids[i], static_cast<std::uint32_t>(dict.size()))
+                           .first->second;
+        }
+        benchmark::DoNotOptimize(codes.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kDictItemCount));
+}
+BENCHMARK(BM_UnorderedMap_EncodeColumn)->Unit(benchmark::kMillisecond);
+
+// 多线程只读查找：字典无锁，unordered_map 走 shared_mutex。
+void BM_MT_StringDict_Find(benchmark::State& state) {
+    StringDictDataset& data = GetStringDictDataset();
+    const std::size_t thread_index = static_cast<std::size_t>(state.thread_index());
+    const std::size_t thread_count = static_cast<std::size_t>(state.threads());
+    std::size_t ops_per_iter = 0;
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        ops_per_iter = 0;
+        for (std::size_t i = thread_index; i < data.probes.size(); i += thread_count) {
+            sum += data.dict.Find(data.views[data.probes[i]]);
+            ++ops_per_iter;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ops_per_iter));
+}
+BENCHMARK(BM_MT_StringDict_Find)->ThreadRange(1, MaxBenchThreads())->Unit(benchmark::kMicrosecond);
+
+void BM_MT_UnorderedMap_FindString(benchmark::State& state) {
+    StringDictDataset& data = GetStringDictDataset();
+    static std::shared_mutex mutex;
+    const std::size_t thread_index = static_cast<std::size_t>(state.thread_index());
+    const std::size_t thread_count = static_cast<std::size_t>(state.threads());
+    std::size_t ops_per_iter = 0;
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        ops_per_iter = 0;
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (std::size_t i = thread_index; i < data.probes.size(); i += thread_count) {
+            sum += data.unordered.find(data.ids[data.probes[i]])->second;
+            ++ops_per_iter;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ops_per_iter));
+}
+BENCHMARK(BM_MT_UnorderedMap_FindString)
+    ->ThreadRange(1, MaxBenchThreads())
+    ->Unit(benchmark::kMicrosecond);
+
 }  // namespace
 
 BENCHMARK_MAIN();
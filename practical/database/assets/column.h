@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "detail/aligned_allocator.h"
+
+namespace columnar {
+
+// 列存中的 NULL 表示：
+// - REAL 列用 quiet NaN，和 SQL 一样参与比较时恒为 false
+// - INTEGER 列用 int64 最小值作为哨兵
+constexpr double kNullFloat64 = std::numeric_limits<double>::quiet_NaN();
+constexpr std::int64_t kNullInt64 = std::numeric_limits<std::int64_t>::min();
+
+inline bool IsNull(double v) noexcept { return std::isnan(v); }
+
+inline bool IsNull(std::int64_t v) noexcept { return v == kNullInt64; }
+
+// 字典编码列没有 NULL。
+inline bool IsNull(std::uint32_t) noexcept { return false; }
+
+// zone map 的块大小：每 4096 行记录一组 min/max，范围谓词据此整块跳过或整块命中。
+constexpr std::size_t kZoneRows = 4096;
+
+// zone map 的只读视图，不拥有内存：既可指向 Column 内部，也可指向外部文件映射。
+// 第 z 块覆盖行 [z * kZoneRows, min((z + 1) * kZoneRows, rows))。
+// min/max 只统计非 NULL 值；全 NULL 块的 min > max（空区间）。
+template <typename T>
+struct ZoneMapView {
+    const T* min{nullptr};
+    const T* max{nullptr};
+    const std::uint32_t* nulls{nullptr};
+    std::size_t zones{0};
+    std::size_t rows{0};
+};
+
+// 单列连续存储，起始地址 64B 对齐，可直接交给 SIMD 算子扫描。
+// 只支持追加，和加载/导入路径的写入模式一致；zone map 随追加增量维护。
+// 也可以经 Attach 直接指向外部只读内存（如 mmap 的列存文件），此时不拥有数据，
+// 不能再 Append，Clear 后恢复为普通列。
+template <typename T>
+class Column {
+public:
+    using value_type = T;
+
+    Column() = default;
+
+    // 指向外部的值数组与 zone map（zones.rows 即行数），不拷贝。外部内存须比列活得更久。
+    void Attach(const T* values, const ZoneMapView<T>& zones) {
+        Clear();
+        attached_ = values;
+        attached_zones_ = zones;
+    }
+
+    bool attached() const noexcept { return attached_ != nullptr; }
+
+    void Reserve(std::size_t n) {
+        values_.reserve(n);
+        const std::size_t zones = (n + kZoneRows - 1) / kZoneRows;
+        zone_min_.reserve(zones);
+        zone_max_.reserve(zones);
+        zone_nulls_.reserve(zones);
+    }
+
+    // 每行只多两次比较：块首行开新 zone，其余行就地更新当前 zone 的 min/max。
+    void Append(T v) {
+        if (values_.size() % kZoneRows == 0) {
+            zone_min_.push_back(std::numeric_limits<T>::has_infinity
+                                    ? std::numeric_limits<T>::infinity()
+                                    : std::numeric_limits<T>::max());
+            zone_max_.push_back(std::numeric_limits<T>::has_infinity
+                                    ? -std::numeric_limits<T>::infinity()
+                                    : std::numeric_limits<T>::lowest());
+            zone_nulls_.push_back(0);
+        }
+        values_.push_back(v);
+        if (IsNull(v)) {
+            ++zone_nulls_.back();
+            return;
+        }
+        zone_min_.back() = v < zone_min_.back() ? v : zone_min_.back();
+        zone_max_.back() = v > zone_max_.back() ? v : zone_max_.back();
+    }
+
+    void Clear() noexcept {
+        attached_ = nullptr;
+        attached_zones_ = ZoneMapView<T>{};
+        values_.clear();
+        zone_min_.clear();
+        zone_max_.clear();
+        zone_nulls_.clear();
+    }
+
+    std::size_t size() const noexcept {
+        return attached_ != nullptr ? attached_zones_.rows : values_.size();
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    const T* data() const noexcept { return attached_ != nullptr ? attached_ : values_.data(); }
+
+    // 经可写指针原地改值不会更新 zone map，只用于整列重写后不再做范围过滤的场景。
+    // 外部只读列没有可写数据，返回 nullptr。
+    T* data() noexcept { return attached_ != nullptr ? nullptr : values_.data(); }
+
+    const T& operator[](std::size_t i) const noexcept { return data()[i]; }
+
+    ZoneMapView<T> zone_map() const noexcept {
+        if (attached_ != nullptr) {
+            return attached_zones_;
+        }
+        return ZoneMapView<T>{zone_min_.data(), zone_max_.data(), zone_nulls_.data(),
+                              zone_min_.size(), values_.size()};
+    }
+
+private:
+    kvcache::detail::AlignedVector<T> values_;
+    std::vector<T> zone_min_;
+    std::vector<T> zone_max_;
+    std::vector<std::uint32_t> zone_nulls_;
+    const T* attached_{nullptr};
+    ZoneMapView<T> attached_zones_{};
+};
+
+using Float64Column = Column<double>;
+using Int64Column = Column<std::int64_t>;
+// 字典编码后的字符串列：存 dense id，原文在对应字典里。
+using DictColumn = Column<std::uint32_t>;
+
+}  // namespace columnar（列存命名空间）
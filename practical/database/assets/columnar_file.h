@@ -0,0 +1,397 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "column.h"
+#include "finace_tables.h"
+#include "mapped_file.h"
+#include "sqlite_util.h"
+
+namespace columnar {
+
+// 一次写入、mmap 只读打开的列存文件（.fcol）。布局（本机字节序，各段起点 64B 对齐）：
+//
+//   [FileHeader 64B][ColumnEntry x column_count]       schema 头
+//   [列 0 值数组][列 1 值数组]...                        每列一段连续数组
+//   [字典页：offsets uint64[count+1]][字符串字节]         cust_id 字典，按 dense id 排列
+//   [zone map footer：每列 min[zones] max[zones] nulls[zones]]
+//
+// 打开时只校验头部与各段边界，列直接 Attach 到映射内存，不逐行解析也不拷贝；
+// 字典串同样引用映射内存，只需按 id 顺序重建一次哈希索引。
+// 头部记录来源数据库的大小与修改时间（SourceStamp），调用方据此判断文件是否过期。
+constexpr char kColumnarMagic[8] = {'F', 'C', 'O', 'L', 'v', '1', '\0', '\0'};
+constexpr std::uint32_t kColumnarVersion = 2;
+constexpr std::uint32_t kColumnarByteOrder = 0x01020304u;
+constexpr std::size_t kColumnarAlign = 64;
+
+enum class ColumnType : std::uint32_t { kFloat64 = 1, kInt64 = 2, kDict = 3 };
+
+// 生成列存文件时来源文件的大小与修改时间（纳秒）。
+struct SourceStamp {
+    std::uint64_t size = 0;
+    std::int64_t mtime_ns = 0;
+
+    bool operator==(const SourceStamp& o) const noexcept {
+        return size == o.size && mtime_ns == o.mtime_ns;
+    }
+    bool operator!=(const SourceStamp& o) const noexcept { return !(*this == o); }
+};
+
+inline bool StatSourceStamp(const std::string& path, SourceStamp* out, std::string* error = nullptr) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return SetError(error, "stat " + path + ": " + std::strerror(errno));
+    }
+    out->size = static_cast<std::uint64_t>(st.st_size);
+    out->mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t column_count;
+    std::uint32_t zone_rows;
+    std::uint64_t dict_offset;
+    std::uint64_t footer_offset;
+    std::uint64_t file_size;
+    SourceStamp source;
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader must stay 64 bytes");
+
+struct ColumnEntry {
+    char table[32];
+    char column[40];
+    ColumnType type;
+    std::uint32_t reserved;
+    std::uint64_t rows;
+    std::uint64_t data_offset;
+    // 该列 zone map 在 footer 中的起点：min、max、nulls 三个数组各自 64B 对齐、依次排列。
+    std::uint64_t zone_offset;
+    std::uint64_t zones;
+};
+static_assert(sizeof(ColumnEntry) == 112, "ColumnEntry layout changed");
+
+struct DictionaryPage {
+    std::uint64_t count;
+    std::uint64_t bytes;
+};
+
+namespace detail {
+
+template <typename T>
+constexpr ColumnType ColumnTypeOf() {
+    if constexpr (std::is_same_v<T, double>) {
+        return ColumnType::kFloat64;
+    } else if constexpr (std::is_same_v<T, std::int64_t>) {
+        return ColumnType::kInt64;
+    } else {
+        static_assert(std::is_same_v<T, std::uint32_t>, "unsupported column type");
+        return ColumnType::kDict;
+    }
+}
+
+constexpr std::uint64_t AlignUp(std::uint64_t n, std::uint64_t align = kColumnarAlign) {
+    return (n + align - 1) / align * align;
+}
+
+// zone map 三个数组在 footer 中占的字节数（各自按 64B 补齐）。
+template <typename T>
+constexpr std::uint64_t ZoneBytes(std::uint64_t zones) {
+    return 2 * AlignUp(zones * sizeof(T)) + AlignUp(zones * sizeof(std::uint32_t));
+}
+
+// 顺序写文件并记录偏移，段间用 0 补齐到对齐边界。
+class AlignedFileWriter {
+public:
+    ~AlignedFileWriter() {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+        }
+    }
+
+    bool Open(const std::string& path, std::string* error) {
+        file_ = std::fopen(path.c_str(), "wb");
+        return file_ != nullptr ||
+               SetError(error, "open " + path + " for write: " + std::strerror(errno));
+    }
+
+    std::uint64_t offset() const noexcept { return offset_; }
+
+    bool Write(const void* data, std::size_t n) {
+        if (n != 0 && std::fwrite(data, 1, n, file_) != n) {
+            return false;
+        }
+        offset_ += n;
+        return true;
+    }
+
+    bool Pad(std::uint64_t align = kColumnarAlign) {
+        static const char kZeros[kColumnarAlign] = {};
+        const auto n = static_cast<std::size_t>(AlignUp(offset_, align) - offset_);
+        return Write(kZeros, n);
+    }
+
+    bool Seek(std::uint64_t offset) {
+        offset_ = offset;
+        return std::fseek(file_, static_cast<long>(offset), SEEK_SET) == 0;
+    }
+
+    bool Close() {
+        const bool ok = std::fclose(file_) == 0;
+        file_ = nullptr;
+        return ok;
+    }
+
+private:
+    std::FILE* file_{nullptr};
+    std::uint64_t offset_{0};
+};
+
+inline void CopyName(char* dst, std::size_t cap, const char* src) {
+    std::memset(dst, 0, cap);
+    std::strncpy(dst, src, cap - 1);
+}
+
+}  // namespace detail（内部实现）
+
+// 把五张表与 cust_id 字典写成列存文件，source 记入头部。先写到 path.tmp，成功后 rename，
+// 读者不会看到写了一半的文件。
+inline bool WriteColumnarFile(const std::string& path,
+                              const FinaceTables& tables,
+                              const SourceStamp& source,
+                              std::string* error = nullptr) {
+    std::vector<ColumnEntry> entries;
+    ForEachFinaceColumn(tables, [&](const char* table, const char* name, const auto& column) {
+        using T = typename std::decay_t<decltype(column)>::value_type;
+        ColumnEntry e{};
+        detail::CopyName(e.table, sizeof(e.table), table);
+        detail::CopyName(e.column, sizeof(e.column), name);
+        e.type = detail::ColumnTypeOf<T>();
+        e.rows = column.size();
+        e.zones = column.zone_map().zones;
+        entries.push_back(e);
+    });
+
+    const std::string tmp = path + ".tmp";
+    detail::AlignedFileWriter out;
+    if (!out.Open(tmp, error)) {
+        return false;
+    }
+    FileHeader header{};
+    std::memcpy(header.magic, kColumnarMagic, sizeof(header.magic));
+    header.version = kColumnarVersion;
+    header.byte_order = kColumnarByteOrder;
+    header.column_count = static_cast<std::uint32_t>(entries.size());
+    header.zone_rows = static_cast<std::uint32_t>(kZoneRows);
+    header.source = source;
+
+    // schema 头先占位，偏移确定后回填。
+    bool ok = out.Write(&header, sizeof(header)) &&
+              out.Write(entries.data(), entries.size() * sizeof(ColumnEntry)) && out.Pad();
+
+    std::size_t i = 0;
+    ForEachFinaceColumn(tables, [&](const char*, const char*, const auto& column) {
+        using T = typename std::decay_t<decltype(column)>::value_type;
+        entries[i].data_offset = out.offset();
+        ok = ok && out.Write(column.data(), column.size() * sizeof(T)) && out.Pad();
+        ++i;
+    });
+
+    const CustIdDictionary& dict = tables.cust_ids;
+    header.dict_offset = out.offset();
+    DictionaryPage page{dict.size(), 0};
+    std::vector<std::uint64_t> offsets(dict.size() + 1, 0);
+    for (std::size_t id = 0; id < dict.size(); ++id) {
+        offsets[id + 1] = offsets[id] + dict.Decode(static_cast<std::uint32_t>(id)).size();
+    }
+    page.bytes = offsets.back();
+    ok = ok && out.Write(&page, sizeof(page)) &&
+         out.Write(offsets.data(), offsets.size() * sizeof(std::uint64_t));
+    for (std::size_t id = 0; ok && id < dict.size(); ++id) {
+        const std::string_view s = dict.Decode(static_cast<std::uint32_t>(id));
+        ok = out.Write(s.data(), s.size());
+    }
+    ok = ok && out.Pad();
+
+    header.footer_offset = out.offset();
+    i = 0;
+    ForEachFinaceColumn(tables, [&](const char*, const char*, const auto& column) {
+        using T = typename std::decay_t<decltype(column)>::value_type;
+        const ZoneMapView<T> z = column.zone_map();
+        entries[i].zone_offset = out.offset();
+        ok = ok && out.Write(z.min, z.zones * sizeof(T)) && out.Pad() &&
+             out.Write(z.max, z.zones * sizeof(T)) && out.Pad() &&
+             out.Write(z.nulls, z.zones * sizeof(std::uint32_t)) && out.Pad();
+        ++i;
+    });
+    header.file_size = out.offset();
+
+    ok = ok && out.Seek(0) && out.Write(&header, sizeof(header)) &&
+         out.Write(entries.data(), entries.size() * sizeof(ColumnEntry));
+    ok = out.Close() && ok;
+    if (!ok) {
+        std::remove(tmp.c_str());
+        return SetError(error, "write " + tmp + ": " + std::strerror(errno));
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return SetError(error, "rename " + tmp + ": " + std::strerror(errno));
+    }
+    return true;
+}
+
+// mmap 打开的列存文件。tables() 中的列与字典串都直接引用映射内存，
+// 对象析构（或重新 Open）之后不能再使用之前取得的 tables。
+class ColumnarFile {
+public:
+    ColumnarFile() = default;
+    ColumnarFile(const ColumnarFile&) = delete;
+    ColumnarFile& operator=(const ColumnarFile&) = delete;
+
+    bool Open(const std::string& path, std::string* error = nullptr) {
+        tables_ = FinaceTables{};
+        if (!file_.Open(path, false, error)) {
+            return false;
+        }
+        if (!Attach()) {
+            tables_ = FinaceTables{};
+            file_.Reset();
+            return SetError(error, path + ": " + error_);
+        }
+        return true;
+    }
+
+    const FinaceTables& tables() const noexcept { return tables_; }
+    std::size_t file_size() const noexcept { return file_.size(); }
+    // 写文件时记录的来源数据库大小与修改时间。
+    const SourceStamp& source() const noexcept { return source_; }
+
+private:
+    bool Fail(const std::string& message) {
+        error_ = message;
+        return false;
+    }
+
+    bool InFile(std::uint64_t offset, std::uint64_t bytes) const {
+        return offset <= file_.size() && bytes <= file_.size() - offset;
+    }
+
+    // count 个 elem 字节的数组是否落在文件内；用除法比较，count * elem 溢出时也不会误判。
+    bool ArrayInFile(std::uint64_t offset, std::uint64_t count, std::uint64_t elem) const {
+        return offset <= file_.size() && count <= (file_.size() - offset) / elem;
+    }
+
+    bool Attach() {
+        const char* base = file_.data();
+        if (file_.size() < sizeof(FileHeader)) {
+            return Fail("too small for a columnar file");
+        }
+        FileHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, kColumnarMagic, sizeof(header.magic)) != 0) {
+            return Fail("bad magic");
+        }
+        if (header.version != kColumnarVersion || header.byte_order != kColumnarByteOrder ||
+            header.zone_rows != kZoneRows) {
+            return Fail("unsupported version, byte order or zone size");
+        }
+        if (header.file_size != file_.size()) {
+            return Fail("truncated file");
+        }
+        const auto* entries = reinterpret_cast<const ColumnEntry*>(base + sizeof(FileHeader));
+        if (!ArrayInFile(sizeof(FileHeader), header.column_count, sizeof(ColumnEntry))) {
+            return Fail("schema out of range");
+        }
+
+        std::size_t i = 0;
+        bool ok = true;
+        const char* prev_table = "";
+        std::uint64_t table_rows = 0;
+        ForEachFinaceColumn(tables_, [&](const char* table, const char* name, auto& column) {
+            using T = typename std::decay_t<decltype(column)>::value_type;
+            if (!ok) {
+                return;
+            }
+            if (i >= header.column_count) {
+                ok = Fail(std::string("missing column ") + table + "." + name);
+                return;
+            }
+            const ColumnEntry& e = entries[i++];
+            const std::uint64_t expect_zones = (e.rows + kZoneRows - 1) / kZoneRows;
+            if (std::strncmp(e.table, table, sizeof(e.table)) != 0 ||
+                std::strncmp(e.column, name, sizeof(e.column)) != 0 ||
+                e.type != detail::ColumnTypeOf<T>() || e.zones != expect_zones ||
+                e.data_offset % kColumnarAlign != 0 || e.zone_offset % kColumnarAlign != 0 ||
+                !ArrayInFile(e.data_offset, e.rows, sizeof(T)) ||
+                !InFile(e.zone_offset, detail::ZoneBytes<T>(e.zones))) {
+                ok = Fail(std::string("bad column entry ") + table + "." + name);
+                return;
+            }
+            if (std::strcmp(prev_table, table) != 0) {
+                prev_table = table;
+                table_rows = e.rows;
+            } else if (e.rows != table_rows) {
+                ok = Fail(std::string("column length differs within table ") + table);
+                return;
+            }
+            const char* zones = base + e.zone_offset;
+            const std::uint64_t array_bytes = detail::AlignUp(e.zones * sizeof(T));
+            ZoneMapView<T> view;
+            view.min = reinterpret_cast<const T*>(zones);
+            view.max = reinterpret_cast<const T*>(zones + array_bytes);
+            view.nulls = reinterpret_cast<const std::uint32_t*>(zones + 2 * array_bytes);
+            view.zones = e.zones;
+            view.rows = e.rows;
+            column.Attach(reinterpret_cast<const T*>(base + e.data_offset), view);
+        });
+        source_ = header.source;
+        return ok && AttachDictionary(header);
+    }
+
+    bool AttachDictionary(const FileHeader& header) {
+        const char* base = file_.data();
+        if (!InFile(header.dict_offset, sizeof(DictionaryPage))) {
+            return Fail("dictionary page out of range");
+        }
+        DictionaryPage page;
+        std::memcpy(&page, base + header.dict_offset, sizeof(page));
+        const std::uint64_t offsets_at = header.dict_offset + sizeof(DictionaryPage);
+        if (page.count >= CustIdDictionary::kInvalidCode ||
+            !ArrayInFile(offsets_at, page.count + 1, sizeof(std::uint64_t)) ||
+            !InFile(offsets_at + (page.count + 1) * sizeof(std::uint64_t), page.bytes)) {
+            return Fail("dictionary page out of range");
+        }
+        const auto* offsets = reinterpret_cast<const std::uint64_t*>(base + offsets_at);
+        const char* chars = base + offsets_at + (page.count + 1) * sizeof(std::uint64_t);
+        CustIdDictionary& dict = tables_.cust_ids;
+        dict.Reserve(page.count);
+        for (std::uint64_t id = 0; id < page.count; ++id) {
+            if (offsets[id] > offsets[id + 1] || offsets[id + 1] > page.bytes) {
+                return Fail("corrupt dictionary offsets");
+            }
+            const std::string_view s(chars + offsets[id], offsets[id + 1] - offsets[id]);
+            if (dict.EncodeView(s) != id) {
+                return Fail("duplicate dictionary entry");
+            }
+        }
+        return true;
+    }
+
+    MappedFile file_;
+    FinaceTables tables_;
+    SourceStamp source_;
+    std::string error_;
+};
+
+}  // namespace columnar（列存命名空间）
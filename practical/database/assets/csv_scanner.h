@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <omp.h>
+
+namespace columnar {
+
+// CSV 字段在原始缓冲区中的范围（不含分隔符）。
+// quoted 表示字段被双引号包围（范围已去掉首尾引号），
+// escaped 表示内部含有 "" 转义，需要调用方按需反转义。
+struct CsvField {
+    const char* begin{nullptr};
+    const char* end{nullptr};
+    bool quoted{false};
+    bool escaped{false};
+
+    std::size_t size() const noexcept { return static_cast<std::size_t>(end - begin); }
+    bool empty() const noexcept { return begin == end; }
+};
+
+// 一段按记录对齐的字节区间：begin 是某条记录的首字节，end 是下一段的 begin。
+struct CsvChunk {
+    std::size_t begin{0};
+    std::size_t end{0};
+};
+
+namespace detail {
+
+// 64 字节块内三类结构字符的位图，第 i 位对应块内第 i 个字节。
+struct CsvBlockMasks {
+    std::uint64_t quote{0};
+    std::uint64_t comma{0};
+    std::uint64_t newline{0};
+};
+
+inline CsvBlockMasks ScanCsvBlock(const char* p) noexcept {
+    CsvBlockMasks m;
+#if defined(__AVX2__)
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    const auto mask = [&](char c) {
+        const __m256i v = _mm256_set1_epi8(c);
+        const auto l = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v)));
+        const auto h = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v)));
+        return static_cast<std::uint64_t>(l) | (static_cast<std::uint64_t>(h) << 32);
+    };
+    m.quote = mask('"');
+    m.comma = mask(',');
+    m.newline = mask('\n');
+#else
+    for (int i = 0; i < 64; ++i) {
+        const std::uint64_t bit = std::uint64_t{1} << i;
+        m.quote |= p[i] == '"' ? bit : 0;
+        m.comma |= p[i] == ',' ? bit : 0;
+        m.newline |= p[i] == '\n' ? bit : 0;
+    }
+#endif
+    return m;
+}
+
+// 前缀异或：结果第 i 位 = quote[0..i] 的奇偶性，即该字节是否处在引号内部。
+// 与全 1 做无进位乘法（pclmulqdq）一条指令得到；没有 PCLMUL 时用对数步移位。
+inline std::uint64_t PrefixXor(std::uint64_t x) noexcept {
+#if defined(__PCLMUL__)
+    const __m128i product = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(x)),
+                                                 _mm_set1_epi8(static_cast<char>(0xff)), 0);
+    return static_cast<std::uint64_t>(_mm_cvtsi128_si64(product));
+#else
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+#endif
+}
+
+// 末尾不足 64 字节时拷到补齐的块里扫描，补齐字节不是结构字符。
+inline CsvBlockMasks ScanCsvTail(const char* p, std::size_t n) noexcept {
+    alignas(64) char block[64];
+    std::memset(block, ' ', sizeof(block));
+    std::memcpy(block, p, n);
+    return ScanCsvBlock(block);
+}
+
+}  // namespace detail（内部实现）
+
+// 扫描 data[begin, end) 中位于引号外的逗号与换行，按出现顺序调用
+// on_structural(pos, is_newline)；回调返回 false 时提前停止。
+// in_quote 是 begin 处的引号状态。返回值：扫描到的最后位置之后的引号状态。
+template <typename Fn>
+bool ScanCsvStructural(const char* data,
+                       std::size_t begin,
+                       std::size_t end,
+                       bool in_quote,
+                       Fn&& on_structural) {
+    std::uint64_t carry = in_quote ? ~std::uint64_t{0} : 0;
+    for (std::size_t base = begin; base < end; base += 64) {
+        const std::size_t n = std::min<std::size_t>(64, end - base);
+        const detail::CsvBlockMasks m =
+            n == 64 ? detail::ScanCsvBlock(data + base) : detail::ScanCsvTail(data + base, n);
+        const std::uint64_t inside = detail::PrefixXor(m.quote) ^ carry;
+        // 最高位为块末的引号状态，算术右移后广播为下一块的初始状态。
+        carry = static_cast<std::uint64_t>(static_cast<std::int64_t>(inside) >> 63);
+        std::uint64_t structural = (m.comma | m.newline) & ~inside;
+        while (structural != 0) {
+            const auto bit = static_cast<unsigned>(__builtin_ctzll(structural));
+            structural &= structural - 1;
+            if (!on_structural(base + bit, ((m.newline >> bit) & 1u) != 0)) {
+                return carry != 0;
+            }
+        }
+    }
+    return carry != 0;
+}
+
+// 统计 data[begin, end) 中双引号个数的奇偶性。
+inline bool CsvQuoteParity(const char* data, std::size_t begin, std::size_t end) noexcept {
+    std::uint64_t count = 0;
+    std::size_t i = begin;
+    for (; i + 64 <= end; i += 64) {
+        count += static_cast<std::uint64_t>(__builtin_popcountll(detail::ScanCsvBlock(data + i).quote));
+    }
+    for (; i < end; ++i) {
+        count += data[i] == '"' ? 1u : 0u;
+    }
+    return (count & 1u) != 0;
+}
+
+// 从记录开头 begin 起跳过一条记录，返回下一条记录的首字节位置（没有换行时返回 end）。
+inline std::size_t SkipCsvRecord(const char* data, std::size_t begin, std::size_t end) {
+    std::size_t next = end;
+    ScanCsvStructural(data, begin, end, false, [&](std::size_t pos, bool is_newline) {
+        if (is_newline) {
+            next = pos + 1;
+            return false;
+        }
+        return true;
+    });
+    return next;
+}
+
+// 把 [begin, end) 切成至多 parts 段并对齐到记录边界，三步均按段并行：
+// 1) 各段统计引号奇偶性；2) 前缀异或得到每段起点是否处在引号内；
+// 3) 每段以正确的引号状态找到起点之后第一个引号外换行，下一字节即该段的首条记录。
+// 引号内的换行（字段内换行）不会被误当作记录边界。
+inline std::vector<CsvChunk> SplitCsvChunks(const char* data,
+                                            std::size_t begin,
+                                            std::size_t end,
+                                            std::size_t parts) {
+    parts = std::max<std::size_t>(1, std::min(parts, (end - begin) / 4096 + 1));
+    std::vector<std::size_t> raw(parts + 1);
+    for (std::size_t t = 0; t <= parts; ++t) {
+        raw[t] = begin + (end - begin) * t / parts;
+    }
+
+    std::vector<unsigned char> parity(parts, 0);
+    const auto count = static_cast<std::int64_t>(parts);
+#pragma omp parallel for schedule(static)
+    for (std::int64_t t = 0; t < count; ++t) {
+        const auto i = static_cast<std::size_t>(t);
+        parity[i] = CsvQuoteParity(data, raw[i], raw[i + 1]) ? 1 : 0;
+    }
+    std::vector<unsigned char> in_quote(parts, 0);
+    for (std::size_t t = 1; t < parts; ++t) {
+        in_quote[t] = in_quote[t - 1] ^ parity[t - 1];
+    }
+
+    std::vector<std::size_t> start(parts + 1, end);
+    start[0] = begin;
+#pragma omp parallel for schedule(static)
+    for (std::int64_t t = 1; t < count; ++t) {
+        const auto i = static_cast<std::size_t>(t);
+        std::size_t first = end;
+        ScanCsvStructural(data, raw[i], end, in_quote[i] != 0,
+                          [&](std::size_t pos, bool is_newline) {
+                              if (is_newline) {
+                                  first = pos + 1;
+                                  return false;
+                              }
+                              return true;
+                          });
+        start[i] = first;
+    }
+
+    std::vector<CsvChunk> chunks;
+    chunks.reserve(parts);
+    for (std::size_t t = 0; t < parts; ++t) {
+        // 一条记录跨越整段时后续段的起点会落在更后面，保持单调。
+        start[t + 1] = std::max(start[t + 1], start[t]);
+        if (start[t] < start[t + 1]) {
+            chunks.push_back(CsvChunk{start[t], start[t + 1]});
+        }
+    }
+    return chunks;
+}
+
+// 逐条解析 chunk 内的记录：on_record(fields, n, record_offset) 返回 false 时停止。
+// 字段数超过 max_fields 的记录以 n = max_fields + 1 上报，由调用方判错。
+// 行尾的 \r 会从最后一个字段中去掉；文件末尾没有换行的最后一条记录同样上报。
+template <typename RecordFn>
+bool ParseCsvRecords(const char* data,
+                     const CsvChunk& chunk,
+                     std::size_t max_fields,
+                     RecordFn&& on_record) {
+    std::vector<CsvField> fields(max_fields + 1);
+    std::size_t n = 0;
+    std::size_t field_begin = chunk.begin;
+    std::size_t record_begin = chunk.begin;
+    bool ok = true;
+
+    const auto close_field = [&](std::size_t field_end) {
+        if (n > max_fields) {
+            return;
+        }
+        CsvField& f = fields[n++];
+        f.begin = data + field_begin;
+        f.end = data + field_end;
+        f.quoted = false;
+        f.escaped = false;
+        if (f.end - f.begin >= 2 && f.begin[0] == '"' && f.end[-1] == '"') {
+            ++f.begin;
+            --f.end;
+            f.quoted = true;
+            f.escaped = std::find(f.begin, f.end, '"') != f.end;
+        }
+    };
+
+    ScanCsvStructural(data, chunk.begin, chunk.end, false, [&](std::size_t pos, bool is_newline) {
+        std::size_t field_end = pos;
+        if (is_newline && field_end > field_begin && data[field_end - 1] == '\r') {
+            --field_end;
+        }
+        close_field(field_end);
+        field_begin = pos + 1;
+        if (is_newline) {
+            ok = on_record(fields.data(), n, record_begin);
+            n = 0;
+            record_begin = pos + 1;
+        }
+        return ok;
+    });
+    // 末尾没有换行的记录：还有未关闭的字段，或者已收集了字段（如 "a,b," 以逗号结尾，
+    // 最后一个空字段从 chunk.end 开始）。
+    if (ok && (field_begin < chunk.end || n > 0)) {
+        std::size_t field_end = chunk.end;
+        if (field_end > field_begin && data[field_end - 1] == '\r') {
+            --field_end;
+        }
+        close_field(field_end);
+        ok = on_record(fields.data(), n, record_begin);
+    }
+    return ok;
+}
+
+}  // namespace columnar（列存命名空间）
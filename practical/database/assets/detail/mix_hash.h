@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace columnar {
+namespace detail {
+
+// 32 位整数键的混洗哈希（murmur3 finalizer）。
+// std::hash<uint32_t> 是恒等映射，配合 FlatIndexMap 的 hash & mask 寻址时，
+// dense id 或按低位分区后的键会集中到少数桶里，因此整数键统一走这里。
+struct MixHash32 {
+    std::size_t operator()(std::uint32_t x) const noexcept {
+        x ^= x >> 16;
+        x *= 0x85ebca6bu;
+        x ^= x >> 13;
+        x *= 0xc2b2ae35u;
+        x ^= x >> 16;
+        return static_cast<std::size_t>(x);
+    }
+};
+
+}  // namespace detail（内部实现）
+}  // namespace columnar（列存命名空间）
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <system_error>
+
+namespace columnar {
+namespace detail {
+
+// 10^0 .. 10^22 都能用 double 精确表示。
+constexpr double kExactPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// 解析 [begin, end) 整段为 double，成功返回 true。
+// 快速路径（Clinger）：有效数字能装进 53 位尾数且十进制指数绝对值 <= 22 时，
+// 尾数和 10 的幂都是精确的 double，一次乘/除的正确舍入结果就是正确答案。
+// 绝大多数 CSV 金额/频率（如 40.900749）都走快速路径；其余交给 std::from_chars。
+inline bool ParseFloat64(const char* begin, const char* end, double* out) noexcept {
+    const char* p = begin;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    const char* digits_begin = p;
+    while (p != end && static_cast<unsigned>(*p - '0') < 10u) {
+        mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+        ++digits;
+        ++p;
+    }
+    if (p != end && *p == '.') {
+        ++p;
+        while (p != end && static_cast<unsigned>(*p - '0') < 10u) {
+            mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+            ++digits;
+            --exponent;
+            ++p;
+        }
+    }
+    if (p == digits_begin || (p == digits_begin + 1 && *digits_begin == '.')) {
+        return false;
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool exp_negative = false;
+        if (p != end && (*p == '-' || *p == '+')) {
+            exp_negative = *p == '-';
+            ++p;
+        }
+        int e = 0;
+        const char* exp_begin = p;
+        while (p != end && static_cast<unsigned>(*p - '0') < 10u && e < 100000) {
+            e = e * 10 + (*p - '0');
+            ++p;
+        }
+        if (p == exp_begin) {
+            return false;
+        }
+        exponent += exp_negative ? -e : e;
+    }
+    if (p != end) {
+        return false;
+    }
+
+    constexpr std::uint64_t kMaxExactMantissa = std::uint64_t{1} << 53;
+    if (digits <= 19 && mantissa <= kMaxExactMantissa && exponent >= -22 && exponent <= 22) {
+        double v = static_cast<double>(mantissa);
+        v = exponent < 0 ? v / kExactPow10[-exponent] : v * kExactPow10[exponent];
+        *out = negative ? -v : v;
+        return true;
+    }
+
+    // 慢路径：from_chars 不接受前导 '+'。
+    const char* first = begin != end && *begin == '+' ? begin + 1 : begin;
+    const auto result = std::from_chars(first, end, *out);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+// 解析整段为 int64。允许 "12.0" 这类整数值的浮点写法（pandas 对含 NULL 的整数列会这样输出）。
+inline bool ParseInt64(const char* begin, const char* end, std::int64_t* out) noexcept {
+    const char* first = begin != end && *begin == '+' ? begin + 1 : begin;
+    const auto result = std::from_chars(first, end, *out);
+    if (result.ec == std::errc() && result.ptr == end) {
+        return true;
+    }
+    double v = 0.0;
+    if (!ParseFloat64(begin, end, &v) || !(v > -9.2e18 && v < 9.2e18) ||
+        v != static_cast<double>(static_cast<std::int64_t>(v))) {
+        return false;
+    }
+    *out = static_cast<std::int64_t>(v);
+    return true;
+}
+
+}  // namespace detail（内部实现）
+}  // namespace columnar（列存命名空间）
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <omp.h>
+
+#include "csv_scanner.h"
+#include "detail/parse_number.h"
+#include "finace_tables.h"
+#include "mapped_file.h"
+#include "sqlite_util.h"
+
+namespace columnar {
+
+// 原始 finance CSV 的 18 列（notebook 用 pandas 读入后拆成五张子表）。
+// 列顺序以表头为准，这里只规定列名与类型。
+enum class CsvColumnKind : std::uint8_t { kText, kFloat64, kInt64 };
+
+struct FinaceCsvColumn {
+    const char* name;
+    CsvColumnKind kind;
+};
+
+constexpr std::array<FinaceCsvColumn, 18> kFinaceCsvColumns = {{
+    {"CUST_ID", CsvColumnKind::kText},
+    {"BALANCE", CsvColumnKind::kFloat64},
+    {"BALANCE_FREQUENCY", CsvColumnKind::kFloat64},
+    {"PURCHASES", CsvColumnKind::kFloat64},
+    {"ONEOFF_PURCHASES", CsvColumnKind::kFloat64},
+    {"INSTALLMENTS_PURCHASES", CsvColumnKind::kFloat64},
+    {"CASH_ADVANCE", CsvColumnKind::kFloat64},
+    {"PURCHASES_FREQUENCY", CsvColumnKind::kFloat64},
+    {"ONEOFF_PURCHASES_FREQUENCY", CsvColumnKind::kFloat64},
+    {"PURCHASES_INSTALLMENTS_FREQUENCY", CsvColumnKind::kFloat64},
+    {"CASH_ADVANCE_FREQUENCY", CsvColumnKind::kFloat64},
+    {"CASH_ADVANCE_TRX", CsvColumnKind::kInt64},
+    {"PURCHASES_TRX", CsvColumnKind::kInt64},
+    {"CREDIT_LIMIT", CsvColumnKind::kFloat64},
+    {"PAYMENTS", CsvColumnKind::kFloat64},
+    {"MINIMUM_PAYMENTS", CsvColumnKind::kFloat64},
+    {"PRC_FULL_PAYMENT", CsvColumnKind::kFloat64},
+    {"TENURE", CsvColumnKind::kInt64},
+}};
+
+namespace detail {
+
+// kFinaceCsvColumns 中各列的下标，用于暂存区的按列访问。
+enum FinaceCsvSlot : std::size_t {
+    kCsvCustId,
+    kCsvBalance,
+    kCsvBalanceFrequency,
+    kCsvPurchases,
+    kCsvOneoffPurchases,
+    kCsvInstallmentsPurchases,
+    kCsvCashAdvance,
+    kCsvPurchasesFrequency,
+    kCsvOneoffPurchasesFrequency,
+    kCsvPurchasesInstallmentsFrequency,
+    kCsvCashAdvanceFrequency,
+    kCsvCashAdvanceTrx,
+    kCsvPurchasesTrx,
+    kCsvCreditLimit,
+    kCsvPayments,
+    kCsvMinimumPayments,
+    kCsvPrcFullPayment,
+    kCsvTenure,
+    kCsvSlots
+};
+
+// 一个 chunk 的解析结果，按 schema 列分别暂存。
+// 数值列统一暂存为 double / int64，按 kind 只使用其一。
+// cust_id 多数直接指向映射文件；含 "" 转义的才在 unescaped 中留一份副本。
+struct FinaceCsvStage {
+    std::vector<std::string_view> cust_ids;
+    // 合并前由 EncodeFinaceCsvStages 填入的字典编码，与 cust_ids 一一对应。
+    std::vector<std::uint32_t> codes;
+    std::deque<std::string> unescaped;
+    std::array<std::vector<double>, kCsvSlots> floats;
+    std::array<std::vector<std::int64_t>, kCsvSlots> ints;
+    std::string error;
+
+    std::size_t size() const noexcept { return cust_ids.size(); }
+};
+
+inline std::string UnescapeCsvField(const CsvField& f) {
+    std::string out;
+    out.reserve(f.size());
+    for (const char* p = f.begin; p != f.end; ++p) {
+        out.push_back(*p);
+        if (*p == '"' && p + 1 != f.end && p[1] == '"') {
+            ++p;
+        }
+    }
+    return out;
+}
+
+// 表头各列映射到 schema 下标；缺列、重复列或多余列都报错。
+inline bool MapFinaceCsvHeader(const char* data,
+                               const CsvChunk& header,
+                               std::array<std::size_t, kCsvSlots>* slot_of,
+                               std::string* error) {
+    std::string message = "csv has no header";
+    ParseCsvRecords(data, header, kCsvSlots, [&](const CsvField* fields, std::size_t n, std::size_t) {
+        if (n != kCsvSlots) {
+            message = "csv header has " + std::to_string(n) + " columns, expected " +
+                      std::to_string(kCsvSlots);
+            return false;
+        }
+        message.clear();
+        std::array<bool, kCsvSlots> seen{};
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::string name = fields[i].escaped ? UnescapeCsvField(fields[i])
+                                                       : std::string(fields[i].begin, fields[i].end);
+            const auto it = std::find_if(kFinaceCsvColumns.begin(), kFinaceCsvColumns.end(),
+                                         [&](const FinaceCsvColumn& c) { return name == c.name; });
+            if (it == kFinaceCsvColumns.end()) {
+                message = "unknown csv column " + name;
+                return false;
+            }
+            const auto slot = static_cast<std::size_t>(it - kFinaceCsvColumns.begin());
+            if (seen[slot]) {
+                message = "duplicate csv column " + name;
+                return false;
+            }
+            seen[slot] = true;
+            (*slot_of)[i] = slot;
+        }
+        return true;
+    });
+    return message.empty() ? true : SetError(error, message);
+}
+
+// 解析一个 chunk；空字段为 NULL，空行跳过。
+inline void ParseFinaceCsvChunk(const char* data,
+                                const CsvChunk& chunk,
+                                const std::array<std::size_t, kCsvSlots>& slot_of,
+                                FinaceCsvStage* stage) {
+    // 实测每行约 180 字节，按 128 字节估计宁多勿少。
+    const std::size_t hint = (chunk.end - chunk.begin) / 128 + 1;
+    stage->cust_ids.reserve(hint);
+    for (std::size_t s = 0; s < kCsvSlots; ++s) {
+        if (kFinaceCsvColumns[s].kind == CsvColumnKind::kFloat64) {
+            stage->floats[s].reserve(hint);
+        } else if (kFinaceCsvColumns[s].kind == CsvColumnKind::kInt64) {
+            stage->ints[s].reserve(hint);
+        }
+    }
+
+    ParseCsvRecords(data, chunk, kCsvSlots, [&](const CsvField* fields, std::size_t n,
+                                                std::size_t offset) {
+        if (n == 1 && fields[0].empty() && !fields[0].quoted) {
+            return true;
+        }
+        if (n != kCsvSlots) {
+            stage->error = "csv record at byte " + std::to_string(offset) + " has " +
+                           std::to_string(n) + " fields";
+            return false;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const CsvField& f = fields[i];
+            const std::size_t slot = slot_of[i];
+            bool ok = true;
+            switch (kFinaceCsvColumns[slot].kind) {
+                case CsvColumnKind::kText:
+                    if (f.escaped) {
+                        stage->unescaped.push_back(UnescapeCsvField(f));
+                        stage->cust_ids.emplace_back(stage->unescaped.back());
+                    } else {
+                        stage->cust_ids.emplace_back(f.begin, f.size());
+                    }
+                    break;
+                case CsvColumnKind::kFloat64: {
+                    double v = kNullFloat64;
+                    ok = f.empty() || ParseFloat64(f.begin, f.end, &v);
+                    stage->floats[slot].push_back(v);
+                    break;
+                }
+                case CsvColumnKind::kInt64: {
+                    std::int64_t v = kNullInt64;
+                    ok = f.empty() || ParseInt64(f.begin, f.end, &v);
+                    stage->ints[slot].push_back(v);
+                    break;
+                }
+            }
+            if (!ok) {
+                stage->error = "bad " + std::string(kFinaceCsvColumns[slot].name) +
+                               " value '" + std::string(f.begin, f.end) + "' in record at byte " +
+                               std::to_string(offset);
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+template <typename T>
+void AppendStaged(const std::vector<T>& values, Column<T>* dst) {
+    for (const T v : values) {
+        dst->Append(v);
+    }
+}
+
+// 按总行数预留字典容量后，各段并行编码 cust_id（字典支持并发写入）。
+// 行序不受影响；多线程时 dense id 的分配顺序取决于线程交错。
+// 预留容量仍不够时 EncodeShared 会提前停止，剩余部分退回单写者 Encode（可扩容）顺序补编；
+// 仍有编码失败则返回 false，不把 kInvalidCode 合并进表。
+inline bool EncodeFinaceCsvStages(std::vector<FinaceCsvStage>* stages,
+                                  CustIdDictionary* dict,
+                                  int workers,
+                                  std::string* error) {
+    std::size_t rows = 0;
+    for (const FinaceCsvStage& s : *stages) {
+        rows += s.size();
+    }
+    dict->Reserve(dict->size() + rows);
+    std::vector<std::size_t> encoded(stages->size());
+    const auto count = static_cast<std::int64_t>(stages->size());
+#pragma omp parallel for schedule(dynamic, 1) num_threads(workers)
+    for (std::int64_t i = 0; i < count; ++i) {
+        const auto c = static_cast<std::size_t>(i);
+        FinaceCsvStage& s = (*stages)[c];
+        s.codes.resize(s.size());
+        encoded[c] = dict->EncodeShared(s.cust_ids.data(), s.size(), s.codes.data());
+    }
+    for (std::size_t c = 0; c < stages->size(); ++c) {
+        FinaceCsvStage& s = (*stages)[c];
+        for (std::size_t r = encoded[c]; r < s.size(); ++r) {
+            s.codes[r] = dict->Encode(s.cust_ids[r]);
+            if (s.codes[r] == CustIdDictionary::kInvalidCode) {
+                return SetError(error, "cust_id dictionary is full at '" +
+                                           std::string(s.cust_ids[r]) + "' (" +
+                                           std::to_string(dict->size()) + " codes)");
+            }
+        }
+    }
+    return true;
+}
+
+// 按 chunk 顺序合并已编码的暂存区，列追加是顺序的，保证行序确定。
+inline void MergeFinaceCsvStages(const std::vector<FinaceCsvStage>& stages, FinaceTables* out) {
+    std::size_t rows = 0;
+    for (const FinaceCsvStage& s : stages) {
+        rows += s.size();
+    }
+    const auto reserve = [rows](auto&... columns) { (columns.Reserve(columns.size() + rows), ...); };
+    CustomersTable& c = out->customers;
+    AccountSummaryTable& a = out->account_summary;
+    PurchaseActivityTable& p = out->purchase_activity;
+    CashAdvanceActivityTable& ca = out->cash_advance_activity;
+    PaymentActivityTable& pm = out->payment_activity;
+    reserve(c.cust_id, c.tenure, a.cust_id, a.balance, a.balance_frequency, a.credit_limit,
+            p.cust_id, p.purchases, p.oneoff_purchases, p.installments_purchases,
+            p.purchases_frequency, p.oneoff_purchases_frequency,
+            p.purchases_installments_frequency, p.purchases_trx, ca.cust_id, ca.cash_advance,
+            ca.cash_advance_frequency, ca.cash_advance_trx, pm.cust_id, pm.payments,
+            pm.minimum_payments, pm.prc_full_payment);
+
+    for (const FinaceCsvStage& s : stages) {
+        for (const std::uint32_t code : s.codes) {
+            c.cust_id.Append(code);
+            a.cust_id.Append(code);
+            p.cust_id.Append(code);
+            ca.cust_id.Append(code);
+            pm.cust_id.Append(code);
+        }
+        AppendStaged(s.ints[kCsvTenure], &c.tenure);
+        AppendStaged(s.floats[kCsvBalance], &a.balance);
+        AppendStaged(s.floats[kCsvBalanceFrequency], &a.balance_frequency);
+        AppendStaged(s.floats[kCsvCreditLimit], &a.credit_limit);
+        AppendStaged(s.floats[kCsvPurchases], &p.purchases);
+        AppendStaged(s.floats[kCsvOneoffPurchases], &p.oneoff_purchases);
+        AppendStaged(s.floats[kCsvInstallmentsPurchases], &p.installments_purchases);
+        AppendStaged(s.floats[kCsvPurchasesFrequency], &p.purchases_frequency);
+        AppendStaged(s.floats[kCsvOneoffPurchasesFrequency], &p.oneoff_purchases_frequency);
+        AppendStaged(s.floats[kCsvPurchasesInstallmentsFrequency],
+                     &p.purchases_installments_frequency);
+        AppendStaged(s.ints[kCsvPurchasesTrx], &p.purchases_trx);
+        AppendStaged(s.floats[kCsvCashAdvance], &ca.cash_advance);
+        AppendStaged(s.floats[kCsvCashAdvanceFrequency], &ca.cash_advance_frequency);
+        AppendStaged(s.ints[kCsvCashAdvanceTrx], &ca.cash_advance_trx);
+        AppendStaged(s.floats[kCsvPayments], &pm.payments);
+        AppendStaged(s.floats[kCsvMinimumPayments], &pm.minimum_payments);
+        AppendStaged(s.floats[kCsvPrcFullPayment], &pm.prc_full_payment);
+    }
+}
+
+}  // namespace detail（内部实现）
+
+// 把内存中的 finance CSV 解析进五张列存子表（追加到 out 已有内容之后）。
+// 流程：跳过表头 -> SplitCsvChunks 按记录边界切段 -> 各段并行解析到暂存区
+// -> 各段并行编码 cust_id -> 顺序合并。
+// threads = 0 使用 OpenMP 默认线程数。每段约为总量的 1/(4*threads)，解析阶段按 dynamic 调度均衡。
+inline bool LoadFinaceCsv(const char* data,
+                          std::size_t size,
+                          FinaceTables* out,
+                          int threads = 0,
+                          std::string* error = nullptr) {
+    const int workers = threads > 0 ? threads : omp_get_max_threads();
+    const std::size_t body = SkipCsvRecord(data, 0, size);
+    std::array<std::size_t, detail::kCsvSlots> slot_of{};
+    if (!detail::MapFinaceCsvHeader(data, CsvChunk{0, body}, &slot_of, error)) {
+        return false;
+    }
+
+    const std::vector<CsvChunk> chunks =
+        SplitCsvChunks(data, body, size, static_cast<std::size_t>(workers) * 4);
+    std::vector<detail::FinaceCsvStage> stages(chunks.size());
+    const auto count = static_cast<std::int64_t>(chunks.size());
+#pragma omp parallel for schedule(dynamic, 1) num_threads(workers)
+    for (std::int64_t i = 0; i < count; ++i) {
+        const auto c = static_cast<std::size_t>(i);
+        detail::ParseFinaceCsvChunk(data, chunks[c], slot_of, &stages[c]);
+    }
+    for (const detail::FinaceCsvStage& s : stages) {
+        if (!s.error.empty()) {
+            return SetError(error, s.error);
+        }
+    }
+    if (!detail::EncodeFinaceCsvStages(&stages, &out->cust_ids, workers, error)) {
+        return false;
+    }
+    detail::MergeFinaceCsvStages(stages, out);
+    return true;
+}
+
+inline bool LoadFinaceCsv(const std::string& path,
+                          FinaceTables* out,
+                          int threads = 0,
+                          std::string* error = nullptr) {
+    MappedFile file;
+    return file.Open(path, true, error) &&
+           LoadFinaceCsv(file.data(), file.size(), out, threads, error);
+}
+
+}  // namespace columnar（列存命名空间）
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <sqlite3.h>
+
+#include "finace_tables.h"
+#include "sqlite_util.h"
+
+namespace columnar {
+namespace detail {
+
+inline double ReadFloat64(sqlite3_stmt* stmt, int col) noexcept {
+    return sqlite3_column_type(stmt, col) == SQLITE_NULL ? kNullFloat64
+                                                          : sqlite3_column_double(stmt, col);
+}
+
+inline std::int64_t ReadInt64(sqlite3_stmt* stmt, int col) noexcept {
+    return sqlite3_column_type(stmt, col) == SQLITE_NULL ? kNullInt64
+                                                          : sqlite3_column_int64(stmt, col);
+}
+
+inline std::uint32_t ReadCustId(sqlite3_stmt* stmt, int col, CustIdDictionary* dict) {
+    const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+    const int bytes = sqlite3_column_bytes(stmt, col);
+    return dict->Encode(std::string_view(text != nullptr ? text : "",
+                                         static_cast<std::size_t>(bytes)));
+}
+
+// 只用于 reserve 的行数估计：max(rowid) 走 B-tree 最右路径，O(log n)。
+inline std::size_t RowCountHint(sqlite3* db, const char* table) {
+    StatementHandle stmt;
+    if (!Prepare(db, std::string("SELECT max(rowid) FROM ") + table, &stmt)) {
+        return 0;
+    }
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+        return 0;
+    }
+    const sqlite3_int64 n = sqlite3_column_int64(stmt.get(), 0);
+    constexpr sqlite3_int64 kMaxHint = sqlite3_int64{1} << 28;
+    return static_cast<std::size_t>(n < 0 ? 0 : (n > kMaxHint ? kMaxHint : n));
+}
+
+// 单趟流式扫描：prepare 一次，逐行 step 并交给 on_row 追加到列中。
+template <typename RowFn>
+bool StreamRows(sqlite3* db, const std::string& sql, RowFn&& on_row, std::string* error) {
+    StatementHandle stmt;
+    if (!Prepare(db, sql, &stmt, error)) {
+        return false;
+    }
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+        on_row(stmt.get());
+    }
+    if (rc != SQLITE_DONE) {
+        return SetSqliteError(error, db, "step");
+    }
+    return true;
+}
+
+}  // namespace detail（内部实现）
+
+inline bool LoadCustomers(sqlite3* db,
+                          CustIdDictionary* dict,
+                          CustomersTable* out,
+                          std::string* error = nullptr) {
+    const std::size_t hint = detail::RowCountHint(db, "customers");
+    out->cust_id.Reserve(hint);
+    out->tenure.Reserve(hint);
+    return detail::StreamRows(
+        db, "SELECT cust_id, tenure FROM customers",
+        [&](sqlite3_stmt* stmt) {
+            out->cust_id.Append(detail::ReadCustId(stmt, 0, dict));
+            out->tenure.Append(detail::ReadInt64(stmt, 1));
+        },
+        error);
+}
+
+inline bool LoadAccountSummary(sqlite3* db,
+                               CustIdDictionary* dict,
+                               AccountSummaryTable* out,
+                               std::string* error = nullptr) {
+    const std::size_t hint = detail::RowCountHint(db, "account_summary");
+    out->cust_id.Reserve(hint);
+    out->balance.Reserve(hint);
+    out->balance_frequency.Reserve(hint);
+    out->credit_limit.Reserve(hint);
+    return detail::StreamRows(
+        db,
+        "SELECT cust_id, balance, balance_frequency, credit_limit FROM account_summary",
+        [&](sqlite3_stmt* stmt) {
+            out->cust_id.Append(detail::ReadCustId(stmt, 0, dict));
+            out->balance.Append(detail::ReadFloat64(stmt, 1));
+            out->balance_frequency.Append(detail::ReadFloat64(stmt, 2));
+            out->credit_limit.Append(detail::ReadFloat64(stmt, 3));
+        },
+        error);
+}
+
+inline bool LoadPurchaseActivity(sqlite3* db,
+                                 CustIdDictionary* dict,
+                                 PurchaseActivityTable* out,
+                                 std::string* error = nullptr) {
+    const std::size_t hint = detail::RowCountHint(db, "purchase_activity");
+    out->cust_id.Reserve(hint);
+    out->purchases.Reserve(hint);
+    out->oneoff_purchases.Reserve(hint);
+    out->installments_purchases.Reserve(hint);
+    out->purchases_frequency.Reserve(hint);
+    out->oneoff_purchases_frequency.Reserve(hint);
+    out->purchases_installments_frequency.Reserve(hint);
+    out->purchases_trx.Reserve(hint);
+    return detail::StreamRows(
+        db,
+        "SELECT cust_id, purchases, oneoff_purchases, installments_purchases, "
+        "purchases_frequency, oneoff_purchases_frequency, "
+        "purchases_installments_frequency, purchases_trx FROM purchase_activity",
+        [&](sqlite3_stmt* stmt) {
+            out->cust_id.Append(detail::ReadCustId(stmt, 0, dict));
+            out->purchases.Append(detail::ReadFloat64(stmt, 1));
+            out->oneoff_purchases.Append(detail::ReadFloat64(stmt, 2));
+            out->installments_purchases.Append(detail::ReadFloat64(stmt, 3));
+            out->purchases_frequency.Append(detail::ReadFloat64(stmt, 4));
+            out->oneoff_purchases_frequency.Append(detail::ReadFloat64(stmt, 5));
+            out->purchases_installments_frequency.Append(detail::ReadFloat64(stmt, 6));
+            out->purchases_trx.Append(detail::ReadInt64(stmt, 7));
+        },
+        error);
+}
+
+inline bool LoadCashAdvanceActivity(sqlite3* db,
+                                    CustIdDictionary* dict,
+                                    CashAdvanceActivityTable* out,
+                                    std::string* error = nullptr) {
+    const std::size_t hint = detail::RowCountHint(db, "cash_advance_activity");
+    out->cust_id.Reserve(hint);
+    out->cash_advance.Reserve(hint);
+    out->cash_advance_frequency.Reserve(hint);
+    out->cash_advance_trx.Reserve(hint);
+    return detail::StreamRows(
+        db,
+        "SELECT cust_id, cash_advance, cash_advance_frequency, cash_advance_trx "
+        "FROM cash_advance_activity",
+        [&](sqlite3_stmt* stmt) {
+            out->cust_id.Append(detail::ReadCustId(stmt, 0, dict));
+            out->cash_advance.Append(detail::ReadFloat64(stmt, 1));
+            out->cash_advance_frequency.Append(detail::ReadFloat64(stmt, 2));
+            out->cash_advance_trx.Append(detail::ReadInt64(stmt, 3));
+        },
+        error);
+}
+
+inline bool LoadPaymentActivity(sqlite3* db,
+                                CustIdDictionary* dict,
+                                PaymentActivityTable* out,
+                                std::string* error = nullptr) {
+    const std::size_t hint = detail::RowCountHint(db, "payment_activity");
+    out->cust_id.Reserve(hint);
+    out->payments.Reserve(hint);
+    out->minimum_payments.Reserve(hint);
+    out->prc_full_payment.Reserve(hint);
+    return detail::StreamRows(
+        db,
+        "SELECT cust_id, payments, minimum_payments, prc_full_payment FROM payment_activity",
+        [&](sqlite3_stmt* stmt) {
+            out->cust_id.Append(detail::ReadCustId(stmt, 0, dict));
+            out->payments.Append(detail::ReadFloat64(stmt, 1));
+            out->minimum_payments.Append(detail::ReadFloat64(stmt, 2));
+            out->prc_full_payment.Append(detail::ReadFloat64(stmt, 3));
+        },
+        error);
+}
+
+// 按 customers 优先的顺序加载，使 cust_id 的 dense id 与 customers 行号一致。
+inline bool LoadFinaceTables(sqlite3* db, FinaceTables* out, std::string* error = nullptr) {
+    return LoadCustomers(db, &out->cust_ids, &out->customers, error) &&
+           LoadAccountSummary(db, &out->cust_ids, &out->account_summary, error) &&
+           LoadPurchaseActivity(db, &out->cust_ids, &out->purchase_activity, error) &&
+           LoadCashAdvanceActivity(db, &out->cust_ids, &out->cash_advance_activity, error) &&
+           LoadPaymentActivity(db, &out->cust_ids, &out->payment_activity, error);
+}
+
+// 只读打开数据库并开启 mmap 读，避免 page cache 到 SQLite 页缓存的二次拷贝。
+inline bool OpenFinaceReadOnly(const std::string& path,
+                               SqliteHandle* out,
+                               std::string* error = nullptr) {
+    if (!OpenDatabase(path, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, out, error)) {
+        return false;
+    }
+    return Exec(out->get(), "PRAGMA mmap_size = 268435456", error);
+}
+
+inline bool LoadFinaceTables(const std::string& path,
+                             FinaceTables* out,
+                             std::string* error = nullptr) {
+    SqliteHandle db;
+    return OpenFinaceReadOnly(path, &db, error) && LoadFinaceTables(db.get(), out, error);
+}
+
+}  // namespace columnar（列存命名空间）
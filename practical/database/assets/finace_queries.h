@@ -0,0 +1,638 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+#include <sqlite3.h>
+
+#include "finace_loader.h"
+#include "finace_tables.h"
+#include "hash_join.h"
+#include "sqlite_util.h"
+#include "top_k.h"
+#include "vector_engine.h"
+
+namespace columnar {
+
+// notebook 中 top_balances 查询（四表 JOIN + WHERE + ORDER BY + LIMIT）。
+constexpr const char* kTopBalancesSql = R"SQL(
+SELECT
+    c.cust_id,
+    c.tenure,
+    a.balance,
+    a.credit_limit,
+    p.payments,
+    pa.purchases
+FROM customers c
+JOIN account_summary a USING (cust_id)
+JOIN payment_activity p USING (cust_id)
+JOIN purchase_activity pa USING (cust_id)
+WHERE a.balance > 5000
+ORDER BY a.balance DESC
+LIMIT 10
+)SQL";
+
+constexpr double kTopBalancesMinBalance = 5000.0;
+constexpr std::size_t kTopBalancesLimit = 10;
+
+// notebook 中 purchase_band 查询（GROUP BY + HAVING）。
+constexpr const char* kPurchaseBandSql = R"SQL(
+SELECT
+    CASE
+        WHEN pa.purchases >= 5000 THEN 'high_spend'
+        WHEN pa.purchases >= 1000 THEN 'mid_spend'
+        ELSE 'low_spend'
+    END AS purchase_band,
+    COUNT(*) AS customer_count,
+    ROUND(AVG(pa.purchases), 2) AS avg_purchases,
+    ROUND(AVG(pm.payments), 2) AS avg_payments
+FROM purchase_activity pa
+JOIN payment_activity pm USING (cust_id)
+GROUP BY purchase_band
+HAVING COUNT(*) >= 100
+ORDER BY avg_purchases DESC
+)SQL";
+
+// notebook 先 CREATE TABLE payment_activity_demo AS SELECT + UPDATE 计算两列，
+// 再做 GROUP BY；这里把 UPDATE 中的 CASE 内联进同一条 SELECT，结果等价。
+constexpr const char* kPaymentSegmentSql = R"SQL(
+SELECT
+    payment_segment,
+    COUNT(*) AS customer_count,
+    ROUND(AVG(payment_ratio), 2) AS avg_payment_ratio
+FROM (
+    SELECT
+        CASE
+            WHEN minimum_payments IS NULL OR minimum_payments = 0 THEN NULL
+            ELSE ROUND(payments / minimum_payments, 2)
+        END AS payment_ratio,
+        CASE
+            WHEN prc_full_payment >= 0.95 THEN 'full_payment'
+            WHEN minimum_payments IS NULL OR minimum_payments = 0 THEN 'no_minimum_due'
+            WHEN payments >= minimum_payments THEN 'paid_at_least_minimum'
+            ELSE 'below_minimum'
+        END AS payment_segment
+    FROM payment_activity
+)
+GROUP BY payment_segment
+ORDER BY customer_count DESC
+)SQL";
+
+// notebook 索引实验中的单表过滤；无索引场景用 NOT INDEXED 强制全表扫描，
+// 不必像 notebook 那样先 DROP INDEX 再重建。
+constexpr const char* kBalanceFilterSql = R"SQL(
+SELECT cust_id, balance
+FROM account_summary
+WHERE balance > 5000
+)SQL";
+
+constexpr const char* kBalanceFilterNoIndexSql = R"SQL(
+SELECT cust_id, balance
+FROM account_summary NOT INDEXED
+WHERE balance > 5000
+)SQL";
+
+// notebook 索引实验中的三表 join_query（两张表各带一个过滤条件）。
+constexpr const char* kJoinFilterSql = R"SQL(
+SELECT
+    c.cust_id,
+    a.balance,
+    p.payments
+FROM customers c
+JOIN account_summary a USING (cust_id)
+JOIN payment_activity p USING (cust_id)
+WHERE a.balance > 5000 AND p.payments > 2000
+)SQL";
+
+constexpr double kJoinFilterMinPayments = 2000.0;
+
+// notebook 中 above_average_credit 查询（两个 AVG 标量子查询 + JOIN + ORDER BY + LIMIT）。
+constexpr const char* kAboveAverageCreditSql = R"SQL(
+SELECT
+    a.cust_id,
+    a.balance,
+    a.credit_limit,
+    p.payments
+FROM account_summary a
+JOIN payment_activity p USING (cust_id)
+WHERE a.credit_limit > (
+    SELECT AVG(credit_limit) FROM account_summary
+)
+  AND p.payments > (
+    SELECT AVG(payments) FROM payment_activity
+)
+ORDER BY p.payments DESC
+LIMIT 10
+)SQL";
+
+constexpr std::size_t kAboveAverageCreditLimit = 10;
+
+struct TopBalanceRow {
+    std::string cust_id;
+    std::int64_t tenure{0};
+    double balance{0.0};
+    double credit_limit{0.0};
+    double payments{0.0};
+    double purchases{0.0};
+};
+
+struct PurchaseBandRow {
+    std::string purchase_band;
+    std::int64_t customer_count{0};
+    double avg_purchases{0.0};
+    double avg_payments{0.0};
+};
+
+struct PaymentSegmentRow {
+    std::string payment_segment;
+    std::int64_t customer_count{0};
+    double avg_payment_ratio{0.0};
+};
+
+struct BalanceFilterRow {
+    std::string cust_id;
+    double balance{0.0};
+};
+
+struct JoinFilterRow {
+    std::string cust_id;
+    double balance{0.0};
+    double payments{0.0};
+};
+
+struct AboveAverageCreditRow {
+    std::string cust_id;
+    double balance{0.0};
+    double credit_limit{0.0};
+    double payments{0.0};
+};
+
+namespace detail {
+
+constexpr const char* kPurchaseBands[] = {"high_spend", "mid_spend", "low_spend"};
+constexpr double kPurchaseBandThresholds[] = {5000.0, 1000.0};
+
+constexpr const char* kPaymentSegments[] = {"full_payment", "no_minimum_due",
+                                            "paid_at_least_minimum", "below_minimum"};
+
+// payment_activity_demo 两列的逐行定义，批量查询和增量视图共用。
+inline double PaymentRatioOf(double payments, double minimum_payments) noexcept {
+    const bool no_minimum = IsNull(minimum_payments) || minimum_payments == 0.0;
+    return no_minimum ? kNullFloat64 : SqlRound(payments / minimum_payments, 2);
+}
+
+// 倒序套用 CASE 分支，先匹配的 WHEN 最后写入、优先级最高；无分支，便于向量化。
+inline std::uint32_t PaymentSegmentOf(double payments,
+                                      double minimum_payments,
+                                      double prc_full_payment) noexcept {
+    const bool no_minimum = IsNull(minimum_payments) || minimum_payments == 0.0;
+    std::uint32_t seg = 3u;
+    seg = payments >= minimum_payments ? 2u : seg;
+    seg = no_minimum ? 1u : seg;
+    seg = prc_full_payment >= 0.95 ? 0u : seg;
+    return seg;
+}
+
+inline bool SameValue(double a, double b) noexcept {
+    return (IsNull(a) && IsNull(b)) || a == b;
+}
+
+inline std::string ReadText(sqlite3_stmt* stmt, int col) {
+    const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+    return text != nullptr ? std::string(text) : std::string();
+}
+
+// ORDER BY 只按计数排序时并列行的先后不确定，比较前统一按 (计数降序, 名称) 排好。
+template <typename Row, typename NameFn>
+void SortByCountThenName(std::vector<Row>* rows, NameFn&& name) {
+    std::sort(rows->begin(), rows->end(), [&](const Row& a, const Row& b) {
+        if (a.customer_count != b.customer_count) {
+            return a.customer_count > b.customer_count;
+        }
+        return name(a) < name(b);
+    });
+}
+
+// ORDER BY balance DESC 对并列余额不定序，比较前按 (余额降序, cust_id) 排好。
+inline void SortByBalanceThenId(std::vector<TopBalanceRow>* rows) {
+    std::sort(rows->begin(), rows->end(), [](const TopBalanceRow& a, const TopBalanceRow& b) {
+        if (a.balance != b.balance) {
+            return a.balance > b.balance;
+        }
+        return a.cust_id < b.cust_id;
+    });
+}
+
+
+// 无 ORDER BY 的结果集行序不确定，比较前按 cust_id 排好。
+template <typename Row>
+void SortById(std::vector<Row>* rows) {
+    std::sort(rows->begin(), rows->end(),
+              [](const Row& a, const Row& b) { return a.cust_id < b.cust_id; });
+}
+
+inline void SortByPaymentsThenId(std::vector<AboveAverageCreditRow>* rows) {
+    std::sort(rows->begin(), rows->end(),
+              [](const AboveAverageCreditRow& a, const AboveAverageCreditRow& b) {
+                  if (a.payments != b.payments) {
+                      return a.payments > b.payments;
+                  }
+                  return a.cust_id < b.cust_id;
+              });
+}
+
+// 表经 ReplicateTables 放大后 cust_id 可能超出字典范围，按字典大小取模解码。
+inline std::string DecodeCustId(const FinaceTables& tables, std::uint32_t code) {
+    return std::string(
+        tables.cust_ids.Decode(static_cast<std::uint32_t>(code % tables.cust_ids.size())));
+}
+
+// 与 SQL AVG 相同：跳过 NULL，全 NULL 时为 NULL。
+inline double ColumnAvg(const Float64Column& column) {
+    std::vector<CompensatedSum> sums(static_cast<std::size_t>(omp_get_max_threads()));
+    std::vector<std::size_t> counts(sums.size(), 0);
+    const double* v = column.data();
+    ParallelBatches(column.size(), [&](std::size_t begin, std::size_t end, int thread) {
+        const auto t = static_cast<std::size_t>(thread);
+        for (std::size_t i = begin; i < end; ++i) {
+            if (!IsNull(v[i])) {
+                sums[t].Add(v[i]);
+                ++counts[t];
+            }
+        }
+    });
+    for (std::size_t t = 1; t < sums.size(); ++t) {
+        sums[0].Merge(sums[t]);
+        counts[0] += counts[t];
+    }
+    return counts[0] == 0 ? kNullFloat64 : sums[0].value() / static_cast<double>(counts[0]);
+}
+
+}  // namespace detail（内部实现）
+
+// top_balances 的原生实现：balance > 5000 先在 account_summary 上按 zone map 剪枝过滤，
+// 过滤结果作为 MultiJoin 起点，依次以 radix 哈希 join 接入 customers、
+// payment_activity、purchase_activity，最后在 join 结果上做并行 top-K，不做全排序。
+inline std::vector<TopBalanceRow> TopBalances(const FinaceTables& tables,
+                                              std::size_t limit = kTopBalancesLimit,
+                                              std::uint32_t radix_bits = kAutoRadixBits) {
+    const CustomersTable& c = tables.customers;
+    const AccountSummaryTable& a = tables.account_summary;
+    const PaymentActivityTable& pm = tables.payment_activity;
+    const PurchaseActivityTable& pa = tables.purchase_activity;
+
+    const SelectionVector rich = FilterRowsZoned<CompareOp::kGreater>(
+        a.balance.data(), a.balance.zone_map(), kTopBalancesMinBalance);
+    MultiJoin join(a.cust_id.data(), rich.data(), rich.size());
+    const std::size_t c_t = join.Join(c.cust_id.data(), nullptr, c.size(), radix_bits);
+    const std::size_t pm_t = join.Join(pm.cust_id.data(), nullptr, pm.size(), radix_bits);
+    const std::size_t pa_t = join.Join(pa.cust_id.data(), nullptr, pa.size(), radix_bits);
+
+    const SelectionVector& a_rows = join.rows(0);
+    const std::vector<TopKEntry> top = ParallelTopK<SortOrder::kDescending>(
+        a.balance.data(), a_rows.data(), join.size(), limit);
+
+    std::vector<TopBalanceRow> rows;
+    rows.reserve(top.size());
+    for (const TopKEntry& entry : top) {
+        const std::uint32_t o = entry.row;
+        const std::uint32_t c_row = join.rows(c_t)[o];
+        const std::uint32_t a_row = a_rows[o];
+        rows.push_back(TopBalanceRow{
+            detail::DecodeCustId(tables, c.cust_id[c_row]),
+            c.tenure[c_row], a.balance[a_row], a.credit_limit[a_row],
+            pm.payments[join.rows(pm_t)[o]], pa.purchases[join.rows(pa_t)[o]]});
+    }
+    detail::SortByBalanceThenId(&rows);
+    return rows;
+}
+
+// purchase_band 的原生实现：
+// dense cust_id 直接寻址完成 join，SIMD 友好的 CASE 分桶，线程私有哈希聚合后合并。
+inline std::vector<PurchaseBandRow> PurchaseBandSummary(const FinaceTables& tables) {
+    const PurchaseActivityTable& pa = tables.purchase_activity;
+    const PaymentActivityTable& pm = tables.payment_activity;
+    const std::vector<std::uint32_t> pm_row =
+        BuildDenseIndex(pm.cust_id.data(), pm.size(), tables.cust_ids.size());
+
+    constexpr std::uint32_t kBands = 3;
+    std::vector<HashAggregator> partials(static_cast<std::size_t>(omp_get_max_threads()),
+                                         HashAggregator(kBands, 2));
+    ParallelBatches(pa.size(), [&](std::size_t begin, std::size_t end, int thread) {
+        alignas(64) std::uint32_t sel[kBatchSize];
+        alignas(64) std::uint32_t build[kBatchSize];
+        alignas(64) std::uint32_t band[kBatchSize];
+        const std::size_t n =
+            ProbeDenseIndex(pa.cust_id.data(), begin, end, pm_row.data(), sel, build);
+        CaseGreaterEqual(pa.purchases.data(), begin, end, detail::kPurchaseBandThresholds,
+                         kBands - 1, band);
+        HashAggregator& agg = partials[static_cast<std::size_t>(thread)];
+        for (std::size_t k = 0; k < n; ++k) {
+            const std::uint32_t row = sel[k];
+            const double measures[2] = {pa.purchases[row], pm.payments[build[k]]};
+            agg.Add(band[row - begin], measures);
+        }
+    });
+    for (std::size_t t = 1; t < partials.size(); ++t) {
+        partials[0].Merge(partials[t]);
+    }
+
+    const HashAggregator& agg = partials[0];
+    std::vector<PurchaseBandRow> rows;
+    for (std::size_t slot = 0; slot < agg.size(); ++slot) {
+        if (agg.count(slot) < 100) {
+            continue;
+        }
+        rows.push_back(PurchaseBandRow{detail::kPurchaseBands[agg.key(slot)], agg.count(slot),
+                                       SqlRound(agg.Avg(slot, 0), 2),
+                                       SqlRound(agg.Avg(slot, 1), 2)});
+    }
+    std::sort(rows.begin(), rows.end(), [](const PurchaseBandRow& a, const PurchaseBandRow& b) {
+        return a.avg_purchases > b.avg_purchases;
+    });
+    return rows;
+}
+
+// payment_segment 的原生实现：单表扫描，ratio 与 segment 在批内逐元素计算，
+// AVG(payment_ratio) 自动跳过 NULL。
+inline std::vector<PaymentSegmentRow> PaymentSegmentSummary(const FinaceTables& tables) {
+    const PaymentActivityTable& pm = tables.payment_activity;
+    constexpr std::uint32_t kSegments = 4;
+    std::vector<HashAggregator> partials(static_cast<std::size_t>(omp_get_max_threads()),
+                                         HashAggregator(kSegments, 1));
+    ParallelBatches(pm.size(), [&](std::size_t begin, std::size_t end, int thread) {
+        alignas(64) std::uint32_t segment[kBatchSize];
+        alignas(64) double ratio[kBatchSize];
+        const double* pay = pm.payments.data() + begin;
+        const double* min_pay = pm.minimum_payments.data() + begin;
+        const double* full = pm.prc_full_payment.data() + begin;
+        const std::size_t n = end - begin;
+#pragma omp simd
+        for (std::size_t i = 0; i < n; ++i) {
+            ratio[i] = detail::PaymentRatioOf(pay[i], min_pay[i]);
+            segment[i] = detail::PaymentSegmentOf(pay[i], min_pay[i], full[i]);
+        }
+        HashAggregator& agg = partials[static_cast<std::size_t>(thread)];
+        for (std::size_t i = 0; i < n; ++i) {
+            agg.Add(segment[i], &ratio[i]);
+        }
+    });
+    for (std::size_t t = 1; t < partials.size(); ++t) {
+        partials[0].Merge(partials[t]);
+    }
+
+    const HashAggregator& agg = partials[0];
+    std::vector<PaymentSegmentRow> rows;
+    for (std::size_t slot = 0; slot < agg.size(); ++slot) {
+        rows.push_back(PaymentSegmentRow{detail::kPaymentSegments[agg.key(slot)],
+                                         agg.count(slot), SqlRound(agg.Avg(slot, 0), 2)});
+    }
+    detail::SortByCountThenName(&rows, [](const PaymentSegmentRow& r) -> const std::string& {
+        return r.payment_segment;
+    });
+    return rows;
+}
+
+// 单表过滤的原生实现。use_zone_map = false 时逐行 SIMD 全扫（对应 SQLite 无索引），
+// true 时先按 zone map 整块跳过或整块命中（列存里与二级索引对应的手段）。
+inline std::vector<BalanceFilterRow> BalanceFilter(const FinaceTables& tables, bool use_zone_map) {
+    const AccountSummaryTable& a = tables.account_summary;
+    const SelectionVector sel =
+        use_zone_map
+            ? FilterRowsZoned<CompareOp::kGreater>(a.balance.data(), a.balance.zone_map(),
+                                                   kTopBalancesMinBalance)
+            : FilterRows<CompareOp::kGreater>(a.balance.data(), a.size(), kTopBalancesMinBalance);
+    std::vector<BalanceFilterRow> rows(sel.size());
+    const auto count = static_cast<std::int64_t>(sel.size());
+#pragma omp parallel for schedule(static)
+    for (std::int64_t i = 0; i < count; ++i) {
+        const std::uint32_t row = sel[static_cast<std::size_t>(i)];
+        rows[static_cast<std::size_t>(i)] =
+            BalanceFilterRow{detail::DecodeCustId(tables, a.cust_id[row]), a.balance[row]};
+    }
+    return rows;
+}
+
+// join_query 的原生实现：两张表的过滤条件各自下推，account_summary 侧为起点，
+// 依次接入过滤后的 payment_activity 与整张 customers。
+inline std::vector<JoinFilterRow> JoinFilter(const FinaceTables& tables,
+                                             std::uint32_t radix_bits = kAutoRadixBits) {
+    const CustomersTable& c = tables.customers;
+    const AccountSummaryTable& a = tables.account_summary;
+    const PaymentActivityTable& pm = tables.payment_activity;
+    const SelectionVector rich = FilterRowsZoned<CompareOp::kGreater>(
+        a.balance.data(), a.balance.zone_map(), kTopBalancesMinBalance);
+    const SelectionVector paying = FilterRowsZoned<CompareOp::kGreater>(
+        pm.payments.data(), pm.payments.zone_map(), kJoinFilterMinPayments);
+    MultiJoin join(a.cust_id.data(), rich.data(), rich.size());
+    const std::size_t pm_t = join.Join(pm.cust_id.data(), paying.data(), paying.size(), radix_bits);
+    const std::size_t c_t = join.Join(c.cust_id.data(), nullptr, c.size(), radix_bits);
+
+    std::vector<JoinFilterRow> rows(join.size());
+    const auto count = static_cast<std::int64_t>(join.size());
+#pragma omp parallel for schedule(static)
+    for (std::int64_t i = 0; i < count; ++i) {
+        const auto o = static_cast<std::size_t>(i);
+        rows[o] = JoinFilterRow{detail::DecodeCustId(tables, c.cust_id[join.rows(c_t)[o]]),
+                                a.balance[join.rows(0)[o]], pm.payments[join.rows(pm_t)[o]]};
+    }
+    return rows;
+}
+
+// above_average_credit 的原生实现：两个 AVG 子查询与外层无关，先各算一次，
+// 然后退化为两个下推过滤 + 一次 join + 按 payments 的 top-K。
+inline std::vector<AboveAverageCreditRow> AboveAverageCredit(
+    const FinaceTables& tables,
+    std::size_t limit = kAboveAverageCreditLimit,
+    std::uint32_t radix_bits = kAutoRadixBits) {
+    const AccountSummaryTable& a = tables.account_summary;
+    const PaymentActivityTable& pm = tables.payment_activity;
+    const double avg_credit = detail::ColumnAvg(a.credit_limit);
+    const double avg_payments = detail::ColumnAvg(pm.payments);
+    const SelectionVector high_credit = FilterRowsZoned<CompareOp::kGreater>(
+        a.credit_limit.data(), a.credit_limit.zone_map(), avg_credit);
+    const SelectionVector high_payments = FilterRowsZoned<CompareOp::kGreater>(
+        pm.payments.data(), pm.payments.zone_map(), avg_payments);
+    MultiJoin join(a.cust_id.data(), high_credit.data(), high_credit.size());
+    const std::size_t pm_t =
+        join.Join(pm.cust_id.data(), high_payments.data(), high_payments.size(), radix_bits);
+
+    const SelectionVector& pm_rows = join.rows(pm_t);
+    const std::vector<TopKEntry> top = ParallelTopK<SortOrder::kDescending>(
+        pm.payments.data(), pm_rows.data(), join.size(), limit);
+    std::vector<AboveAverageCreditRow> rows;
+    rows.reserve(top.size());
+    for (const TopKEntry& entry : top) {
+        const std::uint32_t a_row = join.rows(0)[entry.row];
+        rows.push_back(AboveAverageCreditRow{detail::DecodeCustId(tables, a.cust_id[a_row]),
+                                             a.balance[a_row], a.credit_limit[a_row],
+                                             pm.payments[pm_rows[entry.row]]});
+    }
+    detail::SortByPaymentsThenId(&rows);
+    return rows;
+}
+
+// 同一查询经 SQLite 执行，用作基准对照和结果校验。
+inline bool SqlitePurchaseBandSummary(sqlite3* db,
+                                      std::vector<PurchaseBandRow>* out,
+                                      std::string* error = nullptr) {
+    out->clear();
+    return detail::StreamRows(
+        db, kPurchaseBandSql,
+        [&](sqlite3_stmt* stmt) {
+            out->push_back(PurchaseBandRow{detail::ReadText(stmt, 0),
+                                           sqlite3_column_int64(stmt, 1),
+                                           detail::ReadFloat64(stmt, 2),
+                                           detail::ReadFloat64(stmt, 3)});
+        },
+        error);
+}
+
+inline bool SqlitePaymentSegmentSummary(sqlite3* db,
+                                        std::vector<PaymentSegmentRow>* out,
+                                        std::string* error = nullptr) {
+    out->clear();
+    const bool ok = detail::StreamRows(
+        db, kPaymentSegmentSql,
+        [&](sqlite3_stmt* stmt) {
+            out->push_back(PaymentSegmentRow{detail::ReadText(stmt, 0),
+                                             sqlite3_column_int64(stmt, 1),
+                                             detail::ReadFloat64(stmt, 2)});
+        },
+        error);
+    detail::SortByCountThenName(out, [](const PaymentSegmentRow& r) -> const std::string& {
+        return r.payment_segment;
+    });
+    return ok;
+}
+
+inline bool SqliteTopBalances(sqlite3* db,
+                              std::vector<TopBalanceRow>* out,
+                              std::string* error = nullptr) {
+    out->clear();
+    const bool ok = detail::StreamRows(
+        db, kTopBalancesSql,
+        [&](sqlite3_stmt* stmt) {
+            out->push_back(TopBalanceRow{detail::ReadText(stmt, 0), detail::ReadInt64(stmt, 1),
+                                         detail::ReadFloat64(stmt, 2),
+                                         detail::ReadFloat64(stmt, 3),
+                                         detail::ReadFloat64(stmt, 4),
+                                         detail::ReadFloat64(stmt, 5)});
+        },
+        error);
+    detail::SortByBalanceThenId(out);
+    return ok;
+}
+
+inline bool SameResult(const std::vector<TopBalanceRow>& a,
+                       const std::vector<TopBalanceRow>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const TopBalanceRow& x, const TopBalanceRow& y) {
+                          return x.cust_id == y.cust_id && x.tenure == y.tenure &&
+                                 detail::SameValue(x.balance, y.balance) &&
+                                 detail::SameValue(x.credit_limit, y.credit_limit) &&
+                                 detail::SameValue(x.payments, y.payments) &&
+                                 detail::SameValue(x.purchases, y.purchases);
+                      });
+}
+
+inline bool SameResult(const std::vector<PurchaseBandRow>& a,
+                       const std::vector<PurchaseBandRow>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const PurchaseBandRow& x, const PurchaseBandRow& y) {
+                          return x.purchase_band == y.purchase_band &&
+                                 x.customer_count == y.customer_count &&
+                                 detail::SameValue(x.avg_purchases, y.avg_purchases) &&
+                                 detail::SameValue(x.avg_payments, y.avg_payments);
+                      });
+}
+
+inline bool SameResult(const std::vector<PaymentSegmentRow>& a,
+                       const std::vector<PaymentSegmentRow>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const PaymentSegmentRow& x, const PaymentSegmentRow& y) {
+                          return x.payment_segment == y.payment_segment &&
+                                 x.customer_count == y.customer_count &&
+                                 detail::SameValue(x.avg_payment_ratio, y.avg_payment_ratio);
+                      });
+}
+
+inline bool SqliteBalanceFilter(sqlite3* db,
+                                bool use_index,
+                                std::vector<BalanceFilterRow>* out,
+                                std::string* error = nullptr) {
+    out->clear();
+    return detail::StreamRows(
+        db, use_index ? kBalanceFilterSql : kBalanceFilterNoIndexSql,
+        [&](sqlite3_stmt* stmt) {
+            out->push_back(BalanceFilterRow{detail::ReadText(stmt, 0), detail::ReadFloat64(stmt, 1)});
+        },
+        error);
+}
+
+inline bool SqliteJoinFilter(sqlite3* db,
+                             std::vector<JoinFilterRow>* out,
+                             std::string* error = nullptr) {
+    out->clear();
+    return detail::StreamRows(
+        db, kJoinFilterSql,
+        [&](sqlite3_stmt* stmt) {
+            out->push_back(JoinFilterRow{detail::ReadText(stmt, 0), detail::ReadFloat64(stmt, 1),
+                                         detail::ReadFloat64(stmt, 2)});
+        },
+        error);
+}
+
+inline bool SqliteAboveAverageCredit(sqlite3* db,
+                                     std::vector<AboveAverageCreditRow>* out,
+                                     std::string* error = nullptr) {
+    out->clear();
+    const bool ok = detail::StreamRows(
+        db, kAboveAverageCreditSql,
+        [&](sqlite3_stmt* stmt) {
+            out->push_back(AboveAverageCreditRow{
+                detail::ReadText(stmt, 0), detail::ReadFloat64(stmt, 1),
+                detail::ReadFloat64(stmt, 2), detail::ReadFloat64(stmt, 3)});
+        },
+        error);
+    detail::SortByPaymentsThenId(out);
+    return ok;
+}
+
+// 无序结果集：排序后的副本逐行比较。
+inline bool SameResult(std::vector<BalanceFilterRow> a, std::vector<BalanceFilterRow> b) {
+    detail::SortById(&a);
+    detail::SortById(&b);
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const BalanceFilterRow& x, const BalanceFilterRow& y) {
+                          return x.cust_id == y.cust_id && detail::SameValue(x.balance, y.balance);
+                      });
+}
+
+inline bool SameResult(std::vector<JoinFilterRow> a, std::vector<JoinFilterRow> b) {
+    detail::SortById(&a);
+    detail::SortById(&b);
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const JoinFilterRow& x, const JoinFilterRow& y) {
+                          return x.cust_id == y.cust_id &&
+                                 detail::SameValue(x.balance, y.balance) &&
+                                 detail::SameValue(x.payments, y.payments);
+                      });
+}
+
+inline bool SameResult(const std::vector<AboveAverageCreditRow>& a,
+                       const std::vector<AboveAverageCreditRow>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const AboveAverageCreditRow& x, const AboveAverageCreditRow& y) {
+                          return x.cust_id == y.cust_id &&
+                                 detail::SameValue(x.balance, y.balance) &&
+                                 detail::SameValue(x.credit_limit, y.credit_limit) &&
+                                 detail::SameValue(x.payments, y.payments);
+                      });
+}
+
+}  // namespace columnar（列存命名空间）
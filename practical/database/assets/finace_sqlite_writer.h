@@ -0,0 +1,273 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <sqlite3.h>
+
+#include "finace_tables.h"
+#include "sqlite_util.h"
+
+namespace columnar {
+
+// 与 notebook 建表脚本相同的五张子表（含外键声明）。
+constexpr const char* kFinaceSchemaSql = R"SQL(
+CREATE TABLE IF NOT EXISTS customers (
+    cust_id TEXT PRIMARY KEY,
+    tenure INTEGER
+);
+CREATE TABLE IF NOT EXISTS account_summary (
+    cust_id TEXT PRIMARY KEY,
+    balance REAL,
+    balance_frequency REAL,
+    credit_limit REAL,
+    FOREIGN KEY (cust_id) REFERENCES customers(cust_id)
+);
+CREATE TABLE IF NOT EXISTS purchase_activity (
+    cust_id TEXT PRIMARY KEY,
+    purchases REAL,
+    oneoff_purchases REAL,
+    installments_purchases REAL,
+    purchases_frequency REAL,
+    oneoff_purchases_frequency REAL,
+    purchases_installments_frequency REAL,
+    purchases_trx INTEGER,
+    FOREIGN KEY (cust_id) REFERENCES customers(cust_id)
+);
+CREATE TABLE IF NOT EXISTS cash_advance_activity (
+    cust_id TEXT PRIMARY KEY,
+    cash_advance REAL,
+    cash_advance_frequency REAL,
+    cash_advance_trx INTEGER,
+    FOREIGN KEY (cust_id) REFERENCES customers(cust_id)
+);
+CREATE TABLE IF NOT EXISTS payment_activity (
+    cust_id TEXT PRIMARY KEY,
+    payments REAL,
+    minimum_payments REAL,
+    prc_full_payment REAL,
+    FOREIGN KEY (cust_id) REFERENCES customers(cust_id)
+);
+)SQL";
+
+// notebook 索引实验中建立的两个二级索引。
+constexpr const char* kFinaceIndexSql = R"SQL(
+CREATE INDEX IF NOT EXISTS idx_account_summary_balance ON account_summary(balance);
+CREATE INDEX IF NOT EXISTS idx_payment_activity_payments ON payment_activity(payments);
+)SQL";
+
+namespace detail {
+
+inline void BindFloat64(sqlite3_stmt* stmt, int col, double v) noexcept {
+    if (IsNull(v)) {
+        sqlite3_bind_null(stmt, col);
+    } else {
+        sqlite3_bind_double(stmt, col, v);
+    }
+}
+
+inline void BindInt64(sqlite3_stmt* stmt, int col, std::int64_t v) noexcept {
+    if (IsNull(v)) {
+        sqlite3_bind_null(stmt, col);
+    } else {
+        sqlite3_bind_int64(stmt, col, v);
+    }
+}
+
+// 字典里的字符串在写入期间一直有效，用 SQLITE_STATIC 省掉一次拷贝。
+inline void BindCustId(sqlite3_stmt* stmt, int col, const CustIdDictionary& dict,
+                       std::uint32_t code) noexcept {
+    const std::string_view s = dict.Decode(code);
+    sqlite3_bind_text(stmt, col, s.data(), static_cast<int>(s.size()), SQLITE_STATIC);
+}
+
+// 生成每条语句插入 rows 行的 INSERT：INSERT INTO t VALUES (?,..),(?,..)...
+inline std::string MultiRowInsertSql(const char* table, int columns, std::size_t rows) {
+    std::string row = "(";
+    for (int c = 0; c < columns; ++c) {
+        row += c == 0 ? "?" : ",?";
+    }
+    row += ")";
+    std::string sql = std::string("INSERT INTO ") + table + " VALUES ";
+    for (std::size_t r = 0; r < rows; ++r) {
+        sql += r == 0 ? row : "," + row;
+    }
+    return sql;
+}
+
+// 预编译 INSERT，逐行绑定后 step/reset；每 batch_rows 行提交一次事务。
+// 单行一个事务时每行都要 fsync 日志，批量提交把这部分开销摊到整批上。
+// rows_per_statement > 1 时一条语句绑定多行，摊薄每次 step/reset 的 VDBE 开销；
+// 批内不足一整条语句的尾部行退回单行语句。bind_row(stmt, first_param, row)。
+template <typename BindFn>
+bool InsertRows(sqlite3* db,
+                const char* table,
+                int columns,
+                std::size_t rows,
+                std::size_t batch_rows,
+                std::size_t rows_per_statement,
+                BindFn&& bind_row,
+                std::string* error) {
+    rows_per_statement = rows_per_statement == 0 ? 1 : rows_per_statement;
+    StatementHandle single;
+    StatementHandle multi;
+    if (!Prepare(db, MultiRowInsertSql(table, columns, 1), &single, error) ||
+        (rows_per_statement > 1 &&
+         !Prepare(db, MultiRowInsertSql(table, columns, rows_per_statement), &multi, error))) {
+        return false;
+    }
+    const auto step = [&](sqlite3_stmt* stmt) {
+        const bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+        if (!ok) {
+            SetSqliteError(error, db, "insert");
+        }
+        sqlite3_reset(stmt);
+        return ok;
+    };
+
+    batch_rows = batch_rows == 0 ? rows : batch_rows;
+    for (std::size_t begin = 0; begin < rows; begin += batch_rows) {
+        const std::size_t end = begin + batch_rows < rows ? begin + batch_rows : rows;
+        if (!Exec(db, "BEGIN", error)) {
+            return false;
+        }
+        std::size_t i = begin;
+        bool ok = true;
+        for (; ok && multi != nullptr && i + rows_per_statement <= end; i += rows_per_statement) {
+            for (std::size_t r = 0; r < rows_per_statement; ++r) {
+                bind_row(multi.get(), static_cast<int>(r) * columns + 1, i + r);
+            }
+            ok = step(multi.get());
+        }
+        for (; ok && i < end; ++i) {
+            bind_row(single.get(), 1, i);
+            ok = step(single.get());
+        }
+        if (!ok) {
+            Exec(db, "ROLLBACK");
+            return false;
+        }
+        if (!Exec(db, "COMMIT", error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace detail（内部实现）
+
+inline bool CreateFinaceSchema(sqlite3* db, bool with_indexes, std::string* error = nullptr) {
+    return Exec(db, kFinaceSchemaSql, error) && (!with_indexes || Exec(db, kFinaceIndexSql, error));
+}
+
+// 写入路径的批量参数。
+struct FinaceWriteOptions {
+    // 每个显式事务包含的行数；0 表示每张表一个事务。
+    std::size_t batch_rows{100000};
+    // 每条 INSERT 语句绑定的行数。
+    std::size_t rows_per_statement{1};
+};
+
+// 把列存五张表按 customers 优先的顺序写回 SQLite（表需已存在）。
+// cust_id 按字典解码为原始字符串；NULL 哨兵写为 SQL NULL。
+inline bool WriteFinaceTables(sqlite3* db,
+                              const FinaceTables& tables,
+                              const FinaceWriteOptions& options,
+                              std::string* error = nullptr) {
+    const CustIdDictionary& dict = tables.cust_ids;
+    const CustomersTable& c = tables.customers;
+    const AccountSummaryTable& a = tables.account_summary;
+    const PurchaseActivityTable& p = tables.purchase_activity;
+    const CashAdvanceActivityTable& ca = tables.cash_advance_activity;
+    const PaymentActivityTable& pm = tables.payment_activity;
+    const std::size_t batch = options.batch_rows;
+    const std::size_t per_stmt = options.rows_per_statement;
+    return detail::InsertRows(
+               db, "customers", 2, c.size(), batch, per_stmt,
+               [&](sqlite3_stmt* s, int k, std::size_t i) {
+                   detail::BindCustId(s, k, dict, c.cust_id[i]);
+                   detail::BindInt64(s, k + 1, c.tenure[i]);
+               },
+               error) &&
+           detail::InsertRows(
+               db, "account_summary", 4, a.size(), batch, per_stmt,
+               [&](sqlite3_stmt* s, int k, std::size_t i) {
+                   detail::BindCustId(s, k, dict, a.cust_id[i]);
+                   detail::BindFloat64(s, k + 1, a.balance[i]);
+                   detail::BindFloat64(s, k + 2, a.balance_frequency[i]);
+                   detail::BindFloat64(s, k + 3, a.credit_limit[i]);
+               },
+               error) &&
+           detail::InsertRows(
+               db, "purchase_activity", 8, p.size(), batch, per_stmt,
+               [&](sqlite3_stmt* s, int k, std::size_t i) {
+                   detail::BindCustId(s, k, dict, p.cust_id[i]);
+                   detail::BindFloat64(s, k + 1, p.purchases[i]);
+                   detail::BindFloat64(s, k + 2, p.oneoff_purchases[i]);
+                   detail::BindFloat64(s, k + 3, p.installments_purchases[i]);
+                   detail::BindFloat64(s, k + 4, p.purchases_frequency[i]);
+                   detail::BindFloat64(s, k + 5, p.oneoff_purchases_frequency[i]);
+                   detail::BindFloat64(s, k + 6, p.purchases_installments_frequency[i]);
+                   detail::BindInt64(s, k + 7, p.purchases_trx[i]);
+               },
+               error) &&
+           detail::InsertRows(
+               db, "cash_advance_activity", 4, ca.size(), batch, per_stmt,
+               [&](sqlite3_stmt* s, int k, std::size_t i) {
+                   detail::BindCustId(s, k, dict, ca.cust_id[i]);
+                   detail::BindFloat64(s, k + 1, ca.cash_advance[i]);
+                   detail::BindFloat64(s, k + 2, ca.cash_advance_frequency[i]);
+                   detail::BindInt64(s, k + 3, ca.cash_advance_trx[i]);
+               },
+               error) &&
+           detail::InsertRows(
+               db, "payment_activity", 4, pm.size(), batch, per_stmt,
+               [&](sqlite3_stmt* s, int k, std::size_t i) {
+                   detail::BindCustId(s, k, dict, pm.cust_id[i]);
+                   detail::BindFloat64(s, k + 1, pm.payments[i]);
+                   detail::BindFloat64(s, k + 2, pm.minimum_payments[i]);
+                   detail::BindFloat64(s, k + 3, pm.prc_full_payment[i]);
+               },
+               error);
+}
+
+// 整库批量导入的可调项，默认值即实测最快的安全组合。
+struct SqliteBulkOptions {
+    // journal_mode=WAL：提交只追加 WAL，不再先写回滚日志再改主库。
+    bool wal{true};
+    // OFF / NORMAL / FULL。WAL 下 NORMAL 只在 checkpoint 时 fsync，掉电不损坏库。
+    const char* synchronous{"NORMAL"};
+    // 新库的页大小，只在建表之前设置才生效。
+    int page_size{16384};
+    // 页缓存大小（KiB）；批量插入时 B-tree 的热页都留在缓存里。
+    int cache_size_kib{262144};
+    // true 时先灌数据再建二级索引：一次排序建树，代替每行一次随机的索引插入。
+    bool defer_indexes{true};
+    FinaceWriteOptions write{100000, 32};
+};
+
+// 新建（path 须不存在或为空库）并导入五张表，包括 notebook 中的两个二级索引。
+inline bool BulkLoadFinace(const std::string& path,
+                           const FinaceTables& tables,
+                           const SqliteBulkOptions& options,
+                           std::string* error = nullptr) {
+    SqliteHandle db;
+    if (!OpenDatabase(path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, &db,
+                      error)) {
+        return false;
+    }
+    const std::string pragmas =
+        "PRAGMA page_size = " + std::to_string(options.page_size) + ";" +
+        "PRAGMA journal_mode = " + (options.wal ? "WAL" : "DELETE") + ";" +
+        "PRAGMA synchronous = " + options.synchronous + ";" +
+        "PRAGMA cache_size = -" + std::to_string(options.cache_size_kib) + ";";
+    return Exec(db.get(), pragmas, error) &&
+           CreateFinaceSchema(db.get(), !options.defer_indexes, error) &&
+           WriteFinaceTables(db.get(), tables, options.write, error) &&
+           (!options.defer_indexes || Exec(db.get(), kFinaceIndexSql, error)) &&
+           (!options.wal || Exec(db.get(), "PRAGMA wal_checkpoint(TRUNCATE)", error));
+}
+
+}  // namespace columnar（列存命名空间）
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "column.h"
+#include "string_dictionary.h"
+
+namespace columnar {
+
+// cust_id 字典：字符串 -> 从 0 开始的 dense id。
+// 所有表共用同一个字典，因此跨表 join 只需比较 uint32。
+// 底层是 kvcache::StringDictionary：Find/Decode 无锁，EncodeShared 可多线程并发
+// （容量须事先 Reserve 够）；Encode 是单写者接口，容量不够时自动翻倍。
+class CustIdDictionary {
+public:
+    static constexpr std::uint32_t kInvalidCode = 0xffffffffu;
+    static constexpr std::size_t kInitialCapacity = 1024;
+
+    std::uint32_t Encode(std::string_view s) {
+        std::uint32_t code = dict_.Encode(s);
+        if (code == kInvalidCode) {
+            dict_.Reserve(dict_.capacity() < kInitialCapacity ? kInitialCapacity
+                                                               : dict_.capacity() * 2);
+            code = dict_.Encode(s);
+        }
+        return code;
+    }
+
+    // 并发编码：多个线程可同时调用，但不会扩容，满了返回 kInvalidCode。
+    std::uint32_t EncodeShared(std::string_view s) { return dict_.Encode(s); }
+
+    // 批量并发编码一列，返回成功编码的个数（容量不足时提前停止）。
+    std::size_t EncodeShared(const std::string_view* in, std::size_t n, std::uint32_t* out) {
+        return dict_.EncodeBatch(in, n, out);
+    }
+
+    // 单写者，字符串不拷贝，直接引用外部内存（mmap 的字典页），内存须比字典活得久。
+    std::uint32_t EncodeView(std::string_view s) {
+        std::uint32_t code = dict_.EncodeView(s);
+        if (code == kInvalidCode) {
+            dict_.Reserve(dict_.capacity() < kInitialCapacity ? kInitialCapacity
+                                                               : dict_.capacity() * 2);
+            code = dict_.EncodeView(s);
+        }
+        return code;
+    }
+
+    std::uint32_t Find(std::string_view s) const { return dict_.Find(s); }
+
+    std::string_view Decode(std::uint32_t code) const { return dict_.Decode(code); }
+
+    std::size_t size() const noexcept { return dict_.size(); }
+
+    // 批量导入前预留容量，之后在容量内可以并发编码。非并发。
+    void Reserve(std::size_t n) { dict_.Reserve(n); }
+
+private:
+    kvcache::StringDictionary<> dict_;
+};
+
+// 以下表结构与 notebook 中拆分 finance 表得到的五张子表一一对应。
+struct CustomersTable {
+    DictColumn cust_id;
+    Int64Column tenure;
+
+    std::size_t size() const noexcept { return cust_id.size(); }
+};
+
+struct AccountSummaryTable {
+    DictColumn cust_id;
+    Float64Column balance;
+    Float64Column balance_frequency;
+    Float64Column credit_limit;
+
+    std::size_t size() const noexcept { return cust_id.size(); }
+};
+
+struct PurchaseActivityTable {
+    DictColumn cust_id;
+    Float64Column purchases;
+    Float64Column oneoff_purchases;
+    Float64Column installments_purchases;
+    Float64Column purchases_frequency;
+    Float64Column oneoff_purchases_frequency;
+    Float64Column purchases_installments_frequency;
+    Int64Column purchases_trx;
+
+    std::size_t size() const noexcept { return cust_id.size(); }
+};
+
+struct CashAdvanceActivityTable {
+    DictColumn cust_id;
+    Float64Column cash_advance;
+    Float64Column cash_advance_frequency;
+    Int64Column cash_advance_trx;
+
+    std::size_t size() const noexcept { return cust_id.size(); }
+};
+
+struct PaymentActivityTable {
+    DictColumn cust_id;
+    Float64Column payments;
+    Float64Column minimum_payments;
+    Float64Column prc_full_payment;
+
+    std::size_t size() const noexcept { return cust_id.size(); }
+};
+
+struct FinaceTables {
+    CustIdDictionary cust_ids;
+    CustomersTable customers;
+    AccountSummaryTable account_summary;
+    PurchaseActivityTable purchase_activity;
+    CashAdvanceActivityTable cash_advance_activity;
+    PaymentActivityTable payment_activity;
+
+    std::size_t total_rows() const noexcept {
+        return customers.size() + account_summary.size() + purchase_activity.size() +
+               cash_advance_activity.size() + payment_activity.size();
+    }
+};
+
+// 按 (表名, 列名, 列) 依次访问五张表的全部列，Tables 可以是 const 或非 const。
+// 列存文件的 schema 即按此顺序排列。
+template <typename Tables, typename Fn>
+void ForEachFinaceColumn(Tables& t, Fn&& fn) {
+    fn("customers", "cust_id", t.customers.cust_id);
+    fn("customers", "tenure", t.customers.tenure);
+    fn("account_summary", "cust_id", t.account_summary.cust_id);
+    fn("account_summary", "balance", t.account_summary.balance);
+    fn("account_summary", "balance_frequency", t.account_summary.balance_frequency);
+    fn("account_summary", "credit_limit", t.account_summary.credit_limit);
+    fn("purchase_activity", "cust_id", t.purchase_activity.cust_id);
+    fn("purchase_activity", "purchases", t.purchase_activity.purchases);
+    fn("purchase_activity", "oneoff_purchases", t.purchase_activity.oneoff_purchases);
+    fn("purchase_activity", "installments_purchases", t.purchase_activity.installments_purchases);
+    fn("purchase_activity", "purchases_frequency", t.purchase_activity.purchases_frequency);
+    fn("purchase_activity", "oneoff_purchases_frequency",
+       t.purchase_activity.oneoff_purchases_frequency);
+    fn("purchase_activity", "purchases_installments_frequency",
+       t.purchase_activity.purchases_installments_frequency);
+    fn("purchase_activity", "purchases_trx", t.purchase_activity.purchases_trx);
+    fn("cash_advance_activity", "cust_id", t.cash_advance_activity.cust_id);
+    fn("cash_advance_activity", "cash_advance", t.cash_advance_activity.cash_advance);
+    fn("cash_advance_activity", "cash_advance_frequency",
+       t.cash_advance_activity.cash_advance_frequency);
+    fn("cash_advance_activity", "cash_advance_trx", t.cash_advance_activity.cash_advance_trx);
+    fn("payment_activity", "cust_id", t.payment_activity.cust_id);
+    fn("payment_activity", "payments", t.payment_activity.payments);
+    fn("payment_activity", "minimum_payments", t.payment_activity.minimum_payments);
+    fn("payment_activity", "prc_full_payment", t.payment_activity.prc_full_payment);
+}
+
+namespace detail {
+
+template <typename T>
+void AppendReplicas(const Column<T>& src, std::size_t scale, Column<T>* dst) {
+    dst->Reserve(src.size() * scale);
+    for (std::size_t r = 0; r < scale; ++r) {
+        for (std::size_t i = 0; i < src.size(); ++i) {
+            dst->Append(src[i]);
+        }
+    }
+}
+
+// 第 r 份副本的 id 整体平移 r * id_space，保证副本之间键不冲突。
+inline void AppendReplicaIds(const DictColumn& src,
+                             std::size_t scale,
+                             std::size_t id_space,
+                             DictColumn* dst) {
+    dst->Reserve(src.size() * scale);
+    for (std::size_t r = 0; r < scale; ++r) {
+        const auto shift = static_cast<std::uint32_t>(r * id_space);
+        for (std::size_t i = 0; i < src.size(); ++i) {
+            dst->Append(src[i] + shift);
+        }
+    }
+}
+
+}  // namespace detail（内部实现）
+
+// 把五张表整体复制 scale 份，用于放大数据规模做基准。
+// 副本的 cust_id 是 dense id + r * cust_ids.size()，字典本身不复制：
+// 解码时对 cust_ids.size() 取模即可得到原始字符串。
+inline FinaceTables ReplicateTables(const FinaceTables& src, std::size_t scale) {
+    FinaceTables out;
+    for (std::size_t i = 0; i < src.cust_ids.size(); ++i) {
+        out.cust_ids.Encode(src.cust_ids.Decode(static_cast<std::uint32_t>(i)));
+    }
+    const std::size_t ids = src.cust_ids.size();
+
+    detail::AppendReplicaIds(src.customers.cust_id, scale, ids, &out.customers.cust_id);
+    detail::AppendReplicas(src.customers.tenure, scale, &out.customers.tenure);
+
+    const AccountSummaryTable& a = src.account_summary;
+    detail::AppendReplicaIds(a.cust_id, scale, ids, &out.account_summary.cust_id);
+    detail::AppendReplicas(a.balance, scale, &out.account_summary.balance);
+    detail::AppendReplicas(a.balance_frequency, scale, &out.account_summary.balance_frequency);
+    detail::AppendReplicas(a.credit_limit, scale, &out.account_summary.credit_limit);
+
+    const PurchaseActivityTable& pa = src.purchase_activity;
+    PurchaseActivityTable& opa = out.purchase_activity;
+    detail::AppendReplicaIds(pa.cust_id, scale, ids, &opa.cust_id);
+    detail::AppendReplicas(pa.purchases, scale, &opa.purchases);
+    detail::AppendReplicas(pa.oneoff_purchases, scale, &opa.oneoff_purchases);
+    detail::AppendReplicas(pa.installments_purchases, scale, &opa.installments_purchases);
+    detail::AppendReplicas(pa.purchases_frequency, scale, &opa.purchases_frequency);
+    detail::AppendReplicas(pa.oneoff_purchases_frequency, scale, &opa.oneoff_purchases_frequency);
+    detail::AppendReplicas(pa.purchases_installments_frequency, scale,
+                           &opa.purchases_installments_frequency);
+    detail::AppendReplicas(pa.purchases_trx, scale, &opa.purchases_trx);
+
+    const CashAdvanceActivityTable& ca = src.cash_advance_activity;
+    CashAdvanceActivityTable& oca = out.cash_advance_activity;
+    detail::AppendReplicaIds(ca.cust_id, scale, ids, &oca.cust_id);
+    detail::AppendReplicas(ca.cash_advance, scale, &oca.cash_advance);
+    detail::AppendReplicas(ca.cash_advance_frequency, scale, &oca.cash_advance_frequency);
+    detail::AppendReplicas(ca.cash_advance_trx, scale, &oca.cash_advance_trx);
+
+    const PaymentActivityTable& pm = src.payment_activity;
+    detail::AppendReplicaIds(pm.cust_id, scale, ids, &out.payment_activity.cust_id);
+    detail::AppendReplicas(pm.payments, scale, &out.payment_activity.payments);
+    detail::AppendReplicas(pm.minimum_payments, scale, &out.payment_activity.minimum_payments);
+    detail::AppendReplicas(pm.prc_full_payment, scale, &out.payment_activity.prc_full_payment);
+    return out;
+}
+
+}  // namespace columnar（列存命名空间）
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "detail/mix_hash.h"
+#include "finace_loader.h"
+#include "finace_queries.h"
+#include "finace_tables.h"
+#include "incremental_aggregate.h"
+#include "sharded_fd_kv_cache.h"
+#include "sqlite_cdc.h"
+#include "sqlite_fdkv.h"
+
+namespace columnar {
+
+// payment_activity 一行在写缓存中的值；缓存键为 cust_id 的 dense id。
+struct PaymentRecord {
+    double payments{kNullFloat64};
+    double minimum_payments{kNullFloat64};
+    double prc_full_payment{kNullFloat64};
+};
+
+using PaymentCache = kvcache::ShardedFdKVCache<std::uint32_t, PaymentRecord, detail::MixHash32>;
+
+// payment_segment 的增量物化视图：notebook 每次刷新都要
+// CREATE TABLE ... AS SELECT + UPDATE + GROUP BY 全表重算，这里改为挂在
+// PaymentCache 的写路径上按 delta 维护，读结果只遍历 4 个分组。
+// 用法：把视图作为 on_change 传给缓存的 Insert/InsertOrAssign/Update/Erase。
+// payment_ratio 已 ROUND 到 2 位，按百分之一定点累加，增删任意次后仍与重算一致。
+class PaymentSegmentView {
+public:
+    static constexpr std::uint32_t kSegments = 4;
+
+    PaymentSegmentView() : agg_(kSegments, 1, 100.0) {}
+
+    // 缓存写接口的变更回调：撤出旧行、加入新行。
+    void operator()(const PaymentRecord* old_value, const PaymentRecord* new_value) noexcept {
+        if (old_value != nullptr) {
+            Apply(*old_value, -1);
+        }
+        if (new_value != nullptr) {
+            Apply(*new_value, 1);
+        }
+    }
+
+    // 与 PaymentSegmentSummary 相同的结果和排序；空分组不输出。
+    std::vector<PaymentSegmentRow> Rows() const {
+        std::vector<PaymentSegmentRow> rows;
+        for (std::uint32_t seg = 0; seg < kSegments; ++seg) {
+            const std::int64_t count = agg_.count(seg);
+            if (count == 0) {
+                continue;
+            }
+            rows.push_back(PaymentSegmentRow{detail::kPaymentSegments[seg], count,
+                                             SqlRound(agg_.Avg(seg, 0), 2)});
+        }
+        detail::SortByCountThenName(&rows, [](const PaymentSegmentRow& r) -> const std::string& {
+            return r.payment_segment;
+        });
+        return rows;
+    }
+
+private:
+    void Apply(const PaymentRecord& r, std::int64_t sign) noexcept {
+        const double ratio = detail::PaymentRatioOf(r.payments, r.minimum_payments);
+        agg_.Apply(detail::PaymentSegmentOf(r.payments, r.minimum_payments, r.prc_full_payment),
+                   &ratio, sign);
+    }
+
+    kvcache::IncrementalAggregate agg_;
+};
+
+// 把列存中的 payment_activity 全量写入缓存，同时建立视图的初始状态。
+inline std::size_t LoadPaymentCache(const PaymentActivityTable& table,
+                                    PaymentCache* cache,
+                                    PaymentSegmentView* view) {
+    std::size_t loaded = 0;
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        const PaymentRecord record{table.payments[i], table.minimum_payments[i],
+                                   table.prc_full_payment[i]};
+        loaded += static_cast<std::size_t>(
+            !kvcache::FdToken::IsNull(cache->InsertOrAssign(0, table.cust_id[i], record, *view)));
+    }
+    return loaded;
+}
+
+// 按 rowid 回源读取 payment_activity 的一行，作为 CacheInvalidator 的 loader。
+// 新出现的 cust_id 会追加进字典。
+class PaymentRowLoader {
+public:
+    PaymentRowLoader(sqlite3* db, CustIdDictionary* dict, std::string* error = nullptr)
+        : dict_(dict) {
+        ok_ = Prepare(db,
+                      "SELECT cust_id, payments, minimum_payments, prc_full_payment "
+                      "FROM payment_activity WHERE rowid = ?1",
+                      &stmt_, error);
+    }
+
+    bool ok() const noexcept { return ok_; }
+
+    bool operator()(sqlite3_int64 rowid, std::uint32_t* key, PaymentRecord* value) {
+        sqlite3_stmt* stmt = stmt_.get();
+        sqlite3_bind_int64(stmt, 1, rowid);
+        const bool found = sqlite3_step(stmt) == SQLITE_ROW;
+        if (found) {
+            *key = detail::ReadCustId(stmt, 0, dict_);
+            *value = PaymentRecord{detail::ReadFloat64(stmt, 1), detail::ReadFloat64(stmt, 2),
+                                   detail::ReadFloat64(stmt, 3)};
+        }
+        sqlite3_reset(stmt);
+        return found;
+    }
+
+private:
+    CustIdDictionary* dict_;
+    StatementHandle stmt_;
+    bool ok_{false};
+};
+
+// 把已装入缓存的 payment_activity 行按 rowid 登记到失效器。
+template <typename Invalidator>
+bool TrackPaymentRows(sqlite3* db,
+                      const CustIdDictionary& dict,
+                      const PaymentCache& cache,
+                      Invalidator* invalidator,
+                      std::string* error = nullptr) {
+    return detail::StreamRows(
+        db, "SELECT rowid, cust_id FROM payment_activity",
+        [&](sqlite3_stmt* stmt) {
+            const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            const std::uint32_t key = dict.Find(
+                std::string_view(text, static_cast<std::size_t>(sqlite3_column_bytes(stmt, 1))));
+            const auto handle = cache.FindHandle(key);
+            if (!kvcache::FdToken::IsNull(handle)) {
+                invalidator->Track(sqlite3_column_int64(stmt, 0), key, handle);
+            }
+        },
+        error);
+}
+
+// PaymentCache 在 fdkv 虚表中的列：与 payment_activity 同名同序，
+// 键列 cust_id 通过字典在 TEXT 与 dense id 之间转换。
+class PaymentCacheColumns {
+public:
+    explicit PaymentCacheColumns(const CustIdDictionary* dict) : dict_(dict) {}
+
+    std::string Schema() const {
+        return "CREATE TABLE x(cust_id TEXT, payments REAL, minimum_payments REAL, "
+               "prc_full_payment REAL)";
+    }
+
+    bool KeyFrom(sqlite3_value* value, std::uint32_t* key) const {
+        if (sqlite3_value_type(value) != SQLITE_TEXT) {
+            return false;
+        }
+        const auto* text = reinterpret_cast<const char*>(sqlite3_value_text(value));
+        *key = dict_->Find(std::string_view(text, static_cast<std::size_t>(sqlite3_value_bytes(value))));
+        return *key != CustIdDictionary::kInvalidCode;
+    }
+
+    void Result(std::uint32_t key, const PaymentRecord& r, int column, sqlite3_context* ctx) const {
+        switch (column) {
+            case 0: {
+                const std::string_view id = dict_->Decode(key);
+                sqlite3_result_text(ctx, id.data(), static_cast<int>(id.size()), SQLITE_STATIC);
+                return;
+            }
+            case 1: return ResultFloat64(ctx, r.payments);
+            case 2: return ResultFloat64(ctx, r.minimum_payments);
+            default: return ResultFloat64(ctx, r.prc_full_payment);
+        }
+    }
+
+private:
+    static void ResultFloat64(sqlite3_context* ctx, double v) {
+        if (IsNull(v)) {
+            sqlite3_result_null(ctx);
+        } else {
+            sqlite3_result_double(ctx, v);
+        }
+    }
+
+    const CustIdDictionary* dict_;
+};
+
+}  // namespace columnar（列存命名空间）
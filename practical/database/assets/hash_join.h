@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <omp.h>
+
+#include "detail/flat_index_map.h"
+#include "detail/mix_hash.h"
+#include "vector_engine.h"
+
+namespace columnar {
+
+// 由 build 侧行数自动选择分区位数。
+constexpr std::uint32_t kAutoRadixBits = 0xffffffffu;
+
+// 一次等值 join 的输出：第 i 对匹配为 (probe_rows[i], build_rows[i])，按分区顺序排列。
+struct JoinResult {
+    SelectionVector probe_rows;
+    SelectionVector build_rows;
+
+    std::size_t size() const noexcept { return probe_rows.size(); }
+};
+
+namespace detail {
+
+using JoinIndexMap = kvcache::detail::FlatIndexMap<std::uint32_t, MixHash32,
+                                                   std::equal_to<std::uint32_t>>;
+
+// 每个分区的目标 build 行数：FlatIndexMap 按 2 倍容量分配桶，
+// 4096 行约 100KB，整张分区表可以留在 L2 里。
+constexpr std::size_t kRadixPartitionRows = 4096;
+constexpr std::uint32_t kMaxRadixBits = 12;
+
+// 分区取哈希高位，FlatIndexMap 桶内寻址取低位，两者互不相关。
+inline std::uint32_t RadixPartitionOf(std::uint32_t key, std::uint32_t bits) noexcept {
+    return bits == 0 ? 0u : static_cast<std::uint32_t>(MixHash32{}(key)) >> (32 - bits);
+}
+
+// 按分区连续存放的 (key, row)；[offsets[p], offsets[p + 1]) 是第 p 个分区。
+struct RadixPartitions {
+    SelectionVector keys;
+    SelectionVector rows;
+    std::vector<std::size_t> offsets;
+};
+
+// 并行 radix 分区：各线程统计直方图 -> 按 (分区, 线程) 顺序前缀和 -> 各线程无锁 scatter。
+// sel 为空时输入行就是 [0, n)，否则是 sel[0, n)；键总是 keys[row]。
+inline void RadixPartition(const std::uint32_t* keys,
+                           const std::uint32_t* sel,
+                           std::size_t n,
+                           std::uint32_t bits,
+                           RadixPartitions* out) {
+    const std::size_t parts = std::size_t{1} << bits;
+    out->keys.resize(n);
+    out->rows.resize(n);
+    out->offsets.assign(parts + 1, 0);
+    std::vector<std::size_t> hist(static_cast<std::size_t>(omp_get_max_threads()) * parts, 0);
+
+#pragma omp parallel
+    {
+        const auto threads = static_cast<std::size_t>(omp_get_num_threads());
+        const auto t = static_cast<std::size_t>(omp_get_thread_num());
+        const std::size_t begin = n * t / threads;
+        const std::size_t end = n * (t + 1) / threads;
+        std::size_t* mine = hist.data() + t * parts;
+
+        for (std::size_t i = begin; i < end; ++i) {
+            const std::uint32_t row = sel != nullptr ? sel[i] : static_cast<std::uint32_t>(i);
+            ++mine[RadixPartitionOf(keys[row], bits)];
+        }
+#pragma omp barrier
+#pragma omp single
+        {
+            std::size_t offset = 0;
+            for (std::size_t p = 0; p < parts; ++p) {
+                out->offsets[p] = offset;
+                for (std::size_t w = 0; w < threads; ++w) {
+                    const std::size_t count = hist[w * parts + p];
+                    hist[w * parts + p] = offset;
+                    offset += count;
+                }
+            }
+            out->offsets[parts] = offset;
+        }
+        for (std::size_t i = begin; i < end; ++i) {
+            const std::uint32_t row = sel != nullptr ? sel[i] : static_cast<std::uint32_t>(i);
+            const std::uint32_t key = keys[row];
+            const std::size_t pos = mine[RadixPartitionOf(key, bits)]++;
+            out->keys[pos] = key;
+            out->rows[pos] = row;
+        }
+    }
+}
+
+}  // namespace detail（内部实现）
+
+// 分区并行哈希 join（radix hash join），键为字典编码后的 uint32。
+// build 与 probe 两侧按同一组哈希高位分区，每个分区各自一张 FlatIndexMap，
+// 分区之间没有共享状态，build 与 probe 都按分区并行且不加锁。
+// 约定 build 侧键唯一（各子表的 cust_id 都是主键），因此每个 probe 行至多匹配一次；
+// 重复键时后插入的行覆盖先插入的行。
+class RadixHashJoin {
+public:
+    explicit RadixHashJoin(std::uint32_t radix_bits = kAutoRadixBits)
+        : requested_bits_(radix_bits) {}
+
+    static std::uint32_t AutoRadixBits(std::size_t build_rows) noexcept {
+        std::uint32_t bits = 0;
+        while (bits < detail::kMaxRadixBits &&
+               (build_rows >> bits) > detail::kRadixPartitionRows) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    // sel 为空时 build 行为 [0, n)，否则为 sel[0, n)。
+    void Build(const std::uint32_t* keys, const std::uint32_t* sel, std::size_t n) {
+        bits_ = requested_bits_ == kAutoRadixBits ? AutoRadixBits(n) : requested_bits_;
+        build_size_ = n;
+        detail::RadixPartitions parts;
+        detail::RadixPartition(keys, sel, n, bits_, &parts);
+
+        const auto count = static_cast<std::int64_t>(std::size_t{1} << bits_);
+        tables_.assign(static_cast<std::size_t>(count), detail::JoinIndexMap{});
+#pragma omp parallel for schedule(dynamic)
+        for (std::int64_t p = 0; p < count; ++p) {
+            const std::size_t begin = parts.offsets[static_cast<std::size_t>(p)];
+            const std::size_t end = parts.offsets[static_cast<std::size_t>(p) + 1];
+            detail::JoinIndexMap& table = tables_[static_cast<std::size_t>(p)];
+            table.Init(end - begin);
+            for (std::size_t i = begin; i < end; ++i) {
+                table.Insert(parts.keys[i], parts.rows[i]);
+            }
+        }
+    }
+
+    // probe 侧同样先分区，再逐分区查表；每个分区把命中项压紧写在自己的区间开头，
+    // 最后按分区前缀和拼接成连续输出。
+    JoinResult Probe(const std::uint32_t* keys, const std::uint32_t* sel, std::size_t n) const {
+        detail::RadixPartitions parts;
+        detail::RadixPartition(keys, sel, n, bits_, &parts);
+
+        const std::size_t count = tables_.size();
+        std::vector<std::size_t> matched(count + 1, 0);
+        SelectionVector build_rows(n);
+#pragma omp parallel for schedule(dynamic)
+        for (std::int64_t p = 0; p < static_cast<std::int64_t>(count); ++p) {
+            const auto part = static_cast<std::size_t>(p);
+            const std::size_t begin = parts.offsets[part];
+            const std::size_t end = parts.offsets[part + 1];
+            const detail::JoinIndexMap& table = tables_[part];
+            std::size_t k = begin;
+            for (std::size_t i = begin; i < end; ++i) {
+                std::uint32_t build_row = kNoRow;
+                if (table.Find(parts.keys[i], &build_row)) {
+                    parts.rows[k] = parts.rows[i];
+                    build_rows[k] = build_row;
+                    ++k;
+                }
+            }
+            matched[part + 1] = k - begin;
+        }
+        for (std::size_t p = 0; p < count; ++p) {
+            matched[p + 1] += matched[p];
+        }
+
+        JoinResult result;
+        result.probe_rows.resize(matched[count]);
+        result.build_rows.resize(matched[count]);
+#pragma omp parallel for schedule(static)
+        for (std::int64_t p = 0; p < static_cast<std::int64_t>(count); ++p) {
+            const auto part = static_cast<std::size_t>(p);
+            const std::size_t src = parts.offsets[part];
+            const std::size_t dst = matched[part];
+            const std::size_t len = matched[part + 1] - dst;
+            if (len == 0) {
+                continue;
+            }
+            std::memcpy(result.probe_rows.data() + dst, parts.rows.data() + src,
+                        len * sizeof(std::uint32_t));
+            std::memcpy(result.build_rows.data() + dst, build_rows.data() + src,
+                        len * sizeof(std::uint32_t));
+        }
+        return result;
+    }
+
+    std::size_t build_size() const noexcept { return build_size_; }
+    std::uint32_t radix_bits() const noexcept { return bits_; }
+
+private:
+    std::uint32_t requested_bits_;
+    std::uint32_t bits_{0};
+    std::size_t build_size_{0};
+    std::vector<detail::JoinIndexMap> tables_;
+};
+
+// 同一键上的多路 join（星型：所有表都按 cust_id 相连）。
+// 中间结果按列保存每个输出行在各表中的行号，rows(t)[i] 即第 i 行在第 t 张表的行号。
+// 每次 Join 都以当前中间结果为 build 侧：过滤条件在起点表上先行下推，
+// 中间结果通常远小于待接入的整表，整表只做顺序分区 + probe。
+class MultiJoin {
+public:
+    // 起点表（第 0 张）：sel 为下推过滤后的行，为空时取 [0, n)。
+    MultiJoin(const std::uint32_t* keys, const std::uint32_t* sel, std::size_t n)
+        : keys_(n), rows_(1) {
+        rows_[0].resize(n);
+        const auto count = static_cast<std::int64_t>(n);
+#pragma omp parallel for schedule(static)
+        for (std::int64_t i = 0; i < count; ++i) {
+            const std::uint32_t row =
+                sel != nullptr ? sel[i] : static_cast<std::uint32_t>(i);
+            rows_[0][static_cast<std::size_t>(i)] = row;
+            keys_[static_cast<std::size_t>(i)] = keys[row];
+        }
+    }
+
+    // 接入下一张表，返回它在 rows() 中的编号。sel 可用于该表自己的下推过滤。
+    std::size_t Join(const std::uint32_t* keys,
+                     const std::uint32_t* sel,
+                     std::size_t n,
+                     std::uint32_t radix_bits = kAutoRadixBits) {
+        RadixHashJoin join(radix_bits);
+        join.Build(keys_.data(), nullptr, keys_.size());
+        const JoinResult matched = join.Probe(keys, sel, n);
+
+        // 按匹配结果收缩已有各列，并追加新表的行号列。
+        const auto count = static_cast<std::int64_t>(matched.size());
+        SelectionVector next_keys(matched.size());
+        std::vector<SelectionVector> next_rows(rows_.size() + 1);
+        for (SelectionVector& column : next_rows) {
+            column.resize(matched.size());
+        }
+#pragma omp parallel for schedule(static)
+        for (std::int64_t i = 0; i < count; ++i) {
+            const auto out = static_cast<std::size_t>(i);
+            const std::uint32_t pos = matched.build_rows[out];
+            next_keys[out] = keys_[pos];
+            for (std::size_t t = 0; t < rows_.size(); ++t) {
+                next_rows[t][out] = rows_[t][pos];
+            }
+            next_rows[rows_.size()][out] = matched.probe_rows[out];
+        }
+        keys_ = std::move(next_keys);
+        rows_ = std::move(next_rows);
+        return rows_.size() - 1;
+    }
+
+    std::size_t size() const noexcept { return keys_.size(); }
+    std::size_t table_count() const noexcept { return rows_.size(); }
+    const SelectionVector& rows(std::size_t table) const { return rows_[table]; }
+
+private:
+    SelectionVector keys_;
+    std::vector<SelectionVector> rows_;
+};
+
+}  // namespace columnar（列存命名空间）
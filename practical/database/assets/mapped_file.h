@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sqlite_util.h"
+
+namespace columnar {
+
+// 只读 mmap 整个文件。内容直接来自 page cache，解析时不再额外拷贝一份。
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() { Reset(); }
+
+    // sequential = true 时提示内核按顺序预读（CSV 这类单趟扫描）。
+    bool Open(const std::string& path, bool sequential, std::string* error = nullptr) {
+        Reset();
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return SetError(error, "open " + path + ": " + std::strerror(errno));
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return SetError(error, "fstat " + path + ": " + std::strerror(errno));
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ == 0) {
+            ::close(fd);
+            return true;
+        }
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            size_ = 0;
+            return SetError(error, "mmap " + path + ": " + std::strerror(errno));
+        }
+        if (sequential) {
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+        }
+        data_ = static_cast<const char*>(p);
+        return true;
+    }
+
+    void Reset() noexcept {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const char* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    const char* data_{nullptr};
+    std::size_t size_{0};
+};
+
+}  // namespace columnar（列存命名空间）
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "fd_token.h"
+#include "sqlite_util.h"
+
+namespace columnar {
+
+// 一条已提交的行变更。table 是 watched 列表中的下标，op 取 SQLITE_INSERT/UPDATE/DELETE。
+struct RowChange {
+    std::uint32_t table{0};
+    int op{0};
+    sqlite3_int64 rowid{0};
+};
+
+namespace detail {
+
+inline int WatchedIndex(const std::vector<std::string>& tables, const char* name) {
+    for (std::size_t i = 0; i < tables.size(); ++i) {
+        if (tables[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// 同一批内同一行只保留最后一次变更：行的最终状态只取决于最后一次操作。
+inline void CoalesceChanges(std::vector<RowChange>* changes) {
+    std::vector<std::pair<RowChange, std::size_t>> tagged;
+    tagged.reserve(changes->size());
+    for (std::size_t i = 0; i < changes->size(); ++i) {
+        tagged.emplace_back((*changes)[i], i);
+    }
+    std::stable_sort(tagged.begin(), tagged.end(), [](const auto& x, const auto& y) {
+        return x.first.table != y.first.table ? x.first.table < y.first.table
+                                              : x.first.rowid < y.first.rowid;
+    });
+    changes->clear();
+    for (std::size_t i = 0; i < tagged.size(); ++i) {
+        const bool last = i + 1 == tagged.size() ||
+                          tagged[i + 1].first.table != tagged[i].first.table ||
+                          tagged[i + 1].first.rowid != tagged[i].first.rowid;
+        if (last) {
+            changes->push_back(tagged[i].first);
+        }
+    }
+}
+
+}  // namespace detail（内部实现）
+
+// 通过 sqlite3_update_hook 捕获本连接上的行变更：
+// 事务内的变更先暂存，commit hook 时转为已提交，rollback hook 时丢弃，
+// 因此 Drain 只会拿到真正落盘的变更。语句级回滚（事务内单条语句失败）不触发
+// rollback hook，该语句已上报的行仍会被当作变更：只会多失效，不会漏失效。
+// 限制（SQLite 本身的行为）：只覆盖本连接的写入；WITHOUT ROWID 表不触发；
+// 不带 WHERE 的 DELETE 走 truncate 优化时不触发。跨连接/跨进程用 Changelog。
+// 钩子回调在执行写语句的线程上同步运行，连接在同一时刻只能被一个线程使用。
+class ChangeCapture {
+public:
+    ChangeCapture(sqlite3* db, std::vector<std::string> tables)
+        : db_(db), tables_(std::move(tables)) {
+        sqlite3_update_hook(db_, &ChangeCapture::OnUpdate, this);
+        sqlite3_commit_hook(db_, &ChangeCapture::OnCommit, this);
+        sqlite3_rollback_hook(db_, &ChangeCapture::OnRollback, this);
+    }
+
+    ChangeCapture(const ChangeCapture&) = delete;
+    ChangeCapture& operator=(const ChangeCapture&) = delete;
+
+    ~ChangeCapture() {
+        sqlite3_update_hook(db_, nullptr, nullptr);
+        sqlite3_commit_hook(db_, nullptr, nullptr);
+        sqlite3_rollback_hook(db_, nullptr, nullptr);
+    }
+
+    const std::vector<std::string>& tables() const noexcept { return tables_; }
+
+    std::size_t committed() const noexcept { return committed_.size(); }
+
+    // 取走全部已提交变更（按提交顺序），out 原内容被覆盖。
+    void Drain(std::vector<RowChange>* out) {
+        out->swap(committed_);
+        committed_.clear();
+    }
+
+private:
+    static void OnUpdate(void* self, int op, const char*, const char* table, sqlite3_int64 rowid) {
+        auto* capture = static_cast<ChangeCapture*>(self);
+        const int index = detail::WatchedIndex(capture->tables_, table);
+        if (index >= 0) {
+            capture->pending_.push_back(RowChange{static_cast<std::uint32_t>(index), op, rowid});
+        }
+    }
+
+    static int OnCommit(void* self) {
+        auto* capture = static_cast<ChangeCapture*>(self);
+        capture->committed_.insert(capture->committed_.end(), capture->pending_.begin(),
+                                   capture->pending_.end());
+        capture->pending_.clear();
+        return 0;
+    }
+
+    static void OnRollback(void* self) { static_cast<ChangeCapture*>(self)->pending_.clear(); }
+
+    sqlite3* db_;
+    std::vector<std::string> tables_;
+    std::vector<RowChange> pending_;
+    std::vector<RowChange> committed_;
+};
+
+// 触发器写入的变更日志表：任何连接（包括其他进程）的写入都会在同一事务里记一行，
+// 回滚时日志随之回滚。读取方按 seq 增量拉取，处理完后 Trim 掉已消费的部分。
+// seq 用 AUTOINCREMENT：否则 Trim 清空表后 rowid 会从 1 重新分配，游标 last_seq 会漏掉新变更。
+constexpr const char* kChangelogTable = "cdc_changelog";
+
+inline bool InstallChangelog(sqlite3* db,
+                             const std::vector<std::string>& tables,
+                             std::string* error = nullptr) {
+    std::string sql = std::string("CREATE TABLE IF NOT EXISTS ") + kChangelogTable +
+                      " (seq INTEGER PRIMARY KEY AUTOINCREMENT, tbl TEXT NOT NULL, op INTEGER NOT NULL, "
+                      "row INTEGER NOT NULL);";
+    const struct {
+        const char* event;
+        int op;
+        const char* row;
+    } kEvents[] = {{"INSERT", SQLITE_INSERT, "NEW.rowid"},
+                   {"UPDATE", SQLITE_UPDATE, "NEW.rowid"},
+                   {"DELETE", SQLITE_DELETE, "OLD.rowid"}};
+    for (const std::string& table : tables) {
+        for (const auto& e : kEvents) {
+            sql += "CREATE TRIGGER IF NOT EXISTS cdc_" + table + "_" + e.event + " AFTER " +
+                   e.event + " ON " + table + " BEGIN INSERT INTO " + kChangelogTable +
+                   " (tbl, op, row) VALUES ('" + table + "', " + std::to_string(e.op) + ", " +
+                   e.row + "); END;";
+        }
+    }
+    return Exec(db, sql, error);
+}
+
+// 拉取 seq > *last_seq 的至多 limit 条变更，追加到 out 并推进 *last_seq。
+// 不在 tables 中的表被跳过。
+inline bool PollChangelog(sqlite3* db,
+                          const std::vector<std::string>& tables,
+                          sqlite3_int64* last_seq,
+                          std::size_t limit,
+                          std::vector<RowChange>* out,
+                          std::string* error = nullptr) {
+    StatementHandle stmt;
+    if (!Prepare(db,
+                 std::string("SELECT seq, tbl, op, row FROM ") + kChangelogTable +
+                     " WHERE seq > ?1 ORDER BY seq LIMIT ?2",
+                 &stmt, error)) {
+        return false;
+    }
+    sqlite3_bind_int64(stmt.get(), 1, *last_seq);
+    sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(limit));
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+        *last_seq = sqlite3_column_int64(stmt.get(), 0);
+        const int index = detail::WatchedIndex(
+            tables, reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1)));
+        if (index >= 0) {
+            out->push_back(RowChange{static_cast<std::uint32_t>(index),
+                                     sqlite3_column_int(stmt.get(), 2),
+                                     sqlite3_column_int64(stmt.get(), 3)});
+        }
+    }
+    return rc == SQLITE_DONE ? true : SetSqliteError(error, db, "poll changelog");
+}
+
+inline bool TrimChangelog(sqlite3* db, sqlite3_int64 upto_seq, std::string* error = nullptr) {
+    return Exec(db,
+                std::string("DELETE FROM ") + kChangelogTable +
+                    " WHERE seq <= " + std::to_string(upto_seq),
+                error);
+}
+
+// 把一张源表的已提交变更批量应用到缓存。
+// 维护 rowid -> (键, 句柄) 映射（首次装载时 Track 登记），每批先按 rowid 合并重复变更：
+// - kErase：源行任何变化都 Erase，旧句柄的 generation 失效，下次访问回源重建；
+// - kRefresh：DELETE 时 Erase，INSERT/UPDATE 用 loader 从源库读最新值写回缓存，
+//   已有条目走 Update（句柄不变，值即时刷新），新行走 InsertOrAssign 并登记句柄。
+// loader(rowid, Key*, Value*) 读不到行时返回 false（按删除处理）。
+// 缓存的写接口带 on_change 重载，增量视图可以跟着失效/刷新一起维护。
+enum class InvalidatePolicy { kErase, kRefresh };
+
+template <typename Cache, typename Loader>
+class CacheInvalidator {
+public:
+    using Key = typename Cache::key_type;
+    using Value = typename Cache::mapped_type;
+    using Handle = typename Cache::handle_type;
+
+    CacheInvalidator(Cache* cache, std::uint32_t table, InvalidatePolicy policy, Loader loader)
+        : cache_(cache), table_(table), policy_(policy), loader_(std::move(loader)) {}
+
+    void Reserve(std::size_t n) { entries_.reserve(n); }
+
+    void Track(sqlite3_int64 rowid, const Key& key, Handle handle) {
+        entries_[rowid] = Entry{key, handle};
+    }
+
+    std::size_t tracked() const noexcept { return entries_.size(); }
+
+    struct Stats {
+        std::size_t erased{0};
+        std::size_t refreshed{0};
+        std::size_t inserted{0};
+    };
+
+    // changes 可包含其他表的变更（会被忽略）；调用后内容被过滤、合并。
+    Stats Apply(std::vector<RowChange>* changes) { return Apply(changes, nullptr); }
+
+    // on_change 为 nullptr 时走缓存不带观察者的写接口。
+    template <typename OnChange>
+    Stats Apply(std::vector<RowChange>* changes, OnChange&& on_change) {
+        changes->erase(std::remove_if(changes->begin(), changes->end(),
+                                      [&](const RowChange& c) { return c.table != table_; }),
+                       changes->end());
+        detail::CoalesceChanges(changes);
+        Stats stats;
+        for (const RowChange& c : *changes) {
+            const auto it = entries_.find(c.rowid);
+            Key key{};
+            Value value{};
+            const bool refresh = policy_ == InvalidatePolicy::kRefresh &&
+                                 c.op != SQLITE_DELETE && loader_(c.rowid, &key, &value);
+            // 主键被改写时旧键对应的条目同样要撤掉。
+            if (it != entries_.end() && (!refresh || !(it->second.key == key))) {
+                stats.erased += Erase(it->second.handle, on_change) ? 1 : 0;
+                entries_.erase(it);
+            } else if (it != entries_.end() && Update(it->second.handle, value, on_change)) {
+                ++stats.refreshed;
+                continue;
+            }
+            if (!refresh) {
+                continue;
+            }
+            const Handle handle = Insert(key, value, on_change);
+            if (!kvcache::FdToken::IsNull(handle)) {
+                entries_[c.rowid] = Entry{key, handle};
+                ++stats.inserted;
+            }
+        }
+        return stats;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        Handle handle;
+    };
+
+    template <typename OnChange>
+    static constexpr bool kObserved = !std::is_same_v<std::decay_t<OnChange>, std::nullptr_t>;
+
+    template <typename OnChange>
+    bool Erase(Handle handle, OnChange&& on_change) {
+        if constexpr (kObserved<OnChange>) {
+            return cache_->Erase(handle, on_change);
+        } else {
+            return cache_->Erase(handle);
+        }
+    }
+
+    template <typename OnChange>
+    bool Update(Handle handle, const Value& value, OnChange&& on_change) {
+        if constexpr (kObserved<OnChange>) {
+            return cache_->Update(handle, value, on_change);
+        } else {
+            return cache_->Update(handle, value);
+        }
+    }
+
+    template <typename OnChange>
+    Handle Insert(const Key& key, const Value& value, OnChange&& on_change) {
+        if constexpr (kObserved<OnChange>) {
+            return cache_->InsertOrAssign(0, key, value, on_change);
+        } else {
+            return cache_->InsertOrAssign(0, key, value);
+        }
+    }
+
+    Cache* cache_;
+    std::uint32_t table_;
+    InvalidatePolicy policy_;
+    Loader loader_;
+    std::unordered_map<sqlite3_int64, Entry> entries_;
+};
+
+template <typename Cache, typename Loader>
+CacheInvalidator<Cache, Loader> MakeCacheInvalidator(Cache* cache,
+                                                     std::uint32_t table,
+                                                     InvalidatePolicy policy,
+                                                     Loader loader) {
+    return CacheInvalidator<Cache, Loader>(cache, table, policy, std::move(loader));
+}
+
+}  // namespace columnar（列存命名空间）
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "fd_token.h"
+#include "sqlite_util.h"
+
+namespace columnar {
+
+// 虚表游标当前持有的一批行（一个 shard 的快照或一次点查的结果）。
+class FdkvRows {
+public:
+    virtual ~FdkvRows() = default;
+    virtual std::size_t size() const noexcept = 0;
+    virtual void Clear() noexcept = 0;
+    // 第 row 行的句柄，作为虚表的 rowid。
+    virtual kvcache::FdToken::raw_type handle(std::size_t row) const noexcept = 0;
+    virtual void Result(std::size_t row, int column, sqlite3_context* ctx) const = 0;
+};
+
+// 一个可以挂到 fdkv 虚表上的缓存。第 0 列固定为键列。
+class FdkvSource {
+public:
+    virtual ~FdkvSource() = default;
+    // 交给 sqlite3_declare_vtab 的 CREATE TABLE 语句，表名会被忽略。
+    virtual const std::string& schema() const noexcept = 0;
+    virtual std::size_t shard_count() const noexcept = 0;
+    virtual std::size_t size() const noexcept = 0;
+    virtual std::unique_ptr<FdkvRows> NewRows() const = 0;
+    // 把一个 shard 的全部存活行装入 rows（覆盖原内容）。
+    virtual void LoadShard(std::size_t shard, FdkvRows* rows) const = 0;
+    // 按 SQL 值点查键列；不存在或类型不匹配时 rows 为空。
+    virtual void LoadKey(sqlite3_value* key, FdkvRows* rows) const = 0;
+};
+
+// 名字 -> 缓存。CREATE VIRTUAL TABLE t USING fdkv(name) 按 name 找到缓存。
+// 注册需在建表之前完成；注册表须比使用它的连接活得更久。
+// 同名再次注册会替换条目，已建的虚表仍持有旧 source，不会悬空。
+class FdkvRegistry {
+public:
+    void Register(std::string name, std::shared_ptr<const FdkvSource> source) {
+        sources_[std::move(name)] = std::move(source);
+    }
+
+    std::shared_ptr<const FdkvSource> Find(std::string_view name) const {
+        const auto it = sources_.find(std::string(name));
+        return it == sources_.end() ? nullptr : it->second;
+    }
+
+private:
+    std::map<std::string, std::shared_ptr<const FdkvSource>> sources_;
+};
+
+// ShardedFdKVCache 到 FdkvSource 的适配。Columns 描述 SQL 侧的列：
+//   std::string Schema() const;
+//   bool KeyFrom(sqlite3_value*, Key*) const;
+//   void Result(const Key&, const Value&, int column, sqlite3_context*) const;
+// 缓存与 Columns 引用的状态（如字典）须比虚表活得更久。
+template <typename Cache, typename Columns>
+class FdkvCacheSource final : public FdkvSource {
+public:
+    using Key = typename Cache::key_type;
+    using Value = typename Cache::mapped_type;
+    using Handle = typename Cache::handle_type;
+
+    FdkvCacheSource(const Cache* cache, Columns columns)
+        : cache_(cache), columns_(std::move(columns)), schema_(columns_.Schema()) {}
+
+    const std::string& schema() const noexcept override { return schema_; }
+    std::size_t shard_count() const noexcept override { return cache_->shard_count(); }
+    std::size_t size() const noexcept override { return cache_->size(); }
+
+    std::unique_ptr<FdkvRows> NewRows() const override { return std::make_unique<Rows>(&columns_); }
+
+    void LoadShard(std::size_t shard, FdkvRows* rows) const override {
+        Rows* r = static_cast<Rows*>(rows);
+        r->Clear();
+        cache_->ForEachInShard(shard, [r](Handle h, const Key& k, const Value& v) {
+            r->Push(h, k, v);
+        });
+    }
+
+    void LoadKey(sqlite3_value* key, FdkvRows* rows) const override {
+        Rows* r = static_cast<Rows*>(rows);
+        r->Clear();
+        Key k{};
+        if (!columns_.KeyFrom(key, &k)) {
+            return;
+        }
+        const Handle h = cache_->FindHandle(k);
+        cache_->Read(h, [&](const Value& v) { r->Push(h, k, v); });
+    }
+
+private:
+    class Rows final : public FdkvRows {
+    public:
+        explicit Rows(const Columns* columns) : columns_(columns) {}
+
+        std::size_t size() const noexcept override { return handles_.size(); }
+
+        void Clear() noexcept override {
+            handles_.clear();
+            keys_.clear();
+            values_.clear();
+        }
+
+        kvcache::FdToken::raw_type handle(std::size_t row) const noexcept override {
+            return handles_[row];
+        }
+
+        void Result(std::size_t row, int column, sqlite3_context* ctx) const override {
+            columns_->Result(keys_[row], values_[row], column, ctx);
+        }
+
+        void Push(Handle h, const Key& k, const Value& v) {
+            handles_.push_back(h);
+            keys_.push_back(k);
+            values_.push_back(v);
+        }
+
+    private:
+        const Columns* columns_;
+        std::vector<Handle> handles_;
+        std::vector<Key> keys_;
+        std::vector<Value> values_;
+    };
+
+    const Cache* cache_;
+    Columns columns_;
+    std::string schema_;
+};
+
+template <typename Cache, typename Columns>
+std::shared_ptr<const FdkvSource> MakeFdkvSource(const Cache* cache, Columns columns) {
+    return std::make_shared<FdkvCacheSource<Cache, Columns>>(cache, std::move(columns));
+}
+
+namespace detail {
+
+// 只读虚表：键列等值约束走 FindHandle + Read，其余按 shard 顺序全扫。
+// 扫描时游标每次只拷贝一个 shard 的行，只在拷贝期间持有该 shard 的共享锁，
+// 不会把整个缓存物化成临时表。
+// 虚表持有 source 的共享所有权：同名重新 Register 只影响之后建的表，
+// 已打开的表与游标（Rows 引用 source 内的列描述）在 Disconnect 前始终有效。
+struct FdkvTable {
+    sqlite3_vtab base{};
+    std::shared_ptr<const FdkvSource> source;
+};
+
+struct FdkvCursor {
+    sqlite3_vtab_cursor base{};
+    std::unique_ptr<FdkvRows> rows;
+    std::size_t row{0};
+    std::size_t next_shard{0};
+    bool scanning{false};
+};
+
+constexpr int kFdkvFullScan = 0;
+constexpr int kFdkvKeyLookup = 1;
+
+inline int FdkvConnect(sqlite3* db,
+                       void* aux,
+                       int argc,
+                       const char* const* argv,
+                       sqlite3_vtab** out,
+                       char** err) {
+    const auto* registry = static_cast<const FdkvRegistry*>(aux);
+    if (argc < 4) {
+        *err = sqlite3_mprintf("fdkv: usage CREATE VIRTUAL TABLE t USING fdkv(cache_name)");
+        return SQLITE_ERROR;
+    }
+    std::shared_ptr<const FdkvSource> source = registry->Find(argv[3]);
+    if (source == nullptr) {
+        *err = sqlite3_mprintf("fdkv: no cache registered as '%s'", argv[3]);
+        return SQLITE_ERROR;
+    }
+    const int rc = sqlite3_declare_vtab(db, source->schema().c_str());
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    auto* table = new FdkvTable;
+    table->source = std::move(source);
+    *out = &table->base;
+    return SQLITE_OK;
+}
+
+inline int FdkvDisconnect(sqlite3_vtab* vtab) {
+    delete reinterpret_cast<FdkvTable*>(vtab);
+    return SQLITE_OK;
+}
+
+inline int FdkvBestIndex(sqlite3_vtab* vtab, sqlite3_index_info* info) {
+    for (int i = 0; i < info->nConstraint; ++i) {
+        const auto& c = info->aConstraint[i];
+        if (c.usable && c.iColumn == 0 && c.op == SQLITE_INDEX_CONSTRAINT_EQ) {
+            info->idxNum = kFdkvKeyLookup;
+            info->aConstraintUsage[i].argvIndex = 1;
+            info->aConstraintUsage[i].omit = 1;
+            info->estimatedCost = 1.0;
+            info->estimatedRows = 1;
+            info->idxFlags = SQLITE_INDEX_SCAN_UNIQUE;
+            return SQLITE_OK;
+        }
+    }
+    const auto rows =
+        static_cast<double>(reinterpret_cast<FdkvTable*>(vtab)->source->size());
+    info->idxNum = kFdkvFullScan;
+    info->estimatedCost = rows + 1.0;
+    info->estimatedRows = static_cast<sqlite3_int64>(rows);
+    return SQLITE_OK;
+}
+
+inline int FdkvOpen(sqlite3_vtab* vtab, sqlite3_vtab_cursor** out) {
+    auto* cursor = new FdkvCursor;
+    cursor->rows = reinterpret_cast<FdkvTable*>(vtab)->source->NewRows();
+    *out = &cursor->base;
+    return SQLITE_OK;
+}
+
+inline int FdkvClose(sqlite3_vtab_cursor* cur) {
+    delete reinterpret_cast<FdkvCursor*>(cur);
+    return SQLITE_OK;
+}
+
+inline const FdkvSource* SourceOf(sqlite3_vtab_cursor* cur) {
+    return reinterpret_cast<FdkvTable*>(cur->pVtab)->source.get();
+}
+
+// 当前批次读完后装入下一个非空 shard。
+inline void FdkvAdvanceShard(FdkvCursor* cursor, const FdkvSource* source) {
+    while (cursor->scanning && cursor->row >= cursor->rows->size()) {
+        if (cursor->next_shard >= source->shard_count()) {
+            cursor->scanning = false;
+            cursor->rows->Clear();
+            break;
+        }
+        source->LoadShard(cursor->next_shard++, cursor->rows.get());
+        cursor->row = 0;
+    }
+}
+
+inline int FdkvFilter(sqlite3_vtab_cursor* cur,
+                      int idx_num,
+                      const char*,
+                      int argc,
+                      sqlite3_value** argv) {
+    auto* cursor = reinterpret_cast<FdkvCursor*>(cur);
+    const FdkvSource* source = SourceOf(cur);
+    cursor->row = 0;
+    cursor->next_shard = 0;
+    cursor->rows->Clear();
+    if (idx_num == kFdkvKeyLookup && argc == 1) {
+        cursor->scanning = false;
+        source->LoadKey(argv[0], cursor->rows.get());
+        return SQLITE_OK;
+    }
+    cursor->scanning = true;
+    FdkvAdvanceShard(cursor, source);
+    return SQLITE_OK;
+}
+
+inline int FdkvNext(sqlite3_vtab_cursor* cur) {
+    auto* cursor = reinterpret_cast<FdkvCursor*>(cur);
+    ++cursor->row;
+    FdkvAdvanceShard(cursor, SourceOf(cur));
+    return SQLITE_OK;
+}
+
+inline int FdkvEof(sqlite3_vtab_cursor* cur) {
+    const auto* cursor = reinterpret_cast<FdkvCursor*>(cur);
+    return cursor->row >= cursor->rows->size() ? 1 : 0;
+}
+
+inline int FdkvColumn(sqlite3_vtab_cursor* cur, sqlite3_context* ctx, int column) {
+    const auto* cursor = reinterpret_cast<FdkvCursor*>(cur);
+    cursor->rows->Result(cursor->row, column, ctx);
+    return SQLITE_OK;
+}
+
+inline int FdkvRowid(sqlite3_vtab_cursor* cur, sqlite3_int64* rowid) {
+    const auto* cursor = reinterpret_cast<FdkvCursor*>(cur);
+    *rowid = static_cast<sqlite3_int64>(cursor->rows->handle(cursor->row));
+    return SQLITE_OK;
+}
+
+inline const sqlite3_module& FdkvModule() {
+    static const sqlite3_module module = [] {
+        sqlite3_module m{};
+        m.iVersion = 1;
+        m.xCreate = FdkvConnect;
+        m.xConnect = FdkvConnect;
+        m.xBestIndex = FdkvBestIndex;
+        m.xDisconnect = FdkvDisconnect;
+        m.xDestroy = FdkvDisconnect;
+        m.xOpen = FdkvOpen;
+        m.xClose = FdkvClose;
+        m.xFilter = FdkvFilter;
+        m.xNext = FdkvNext;
+        m.xEof = FdkvEof;
+        m.xColumn = FdkvColumn;
+        m.xRowid = FdkvRowid;
+        return m;
+    }();
+    return module;
+}
+
+}  // namespace detail（内部实现）
+
+// 在连接上注册 fdkv 模块。之后可以：
+//   CREATE VIRTUAL TABLE temp.hot_payments USING fdkv(payments);
+// 只读库上用 temp 模式建表即可，不会写主库。
+inline bool RegisterFdkvModule(sqlite3* db,
+                               const FdkvRegistry* registry,
+                               std::string* error = nullptr) {
+    if (sqlite3_create_module_v2(db, "fdkv", &detail::FdkvModule(),
+                                 const_cast<FdkvRegistry*>(registry), nullptr) != SQLITE_OK) {
+        return SetSqliteError(error, db, "create module fdkv");
+    }
+    return true;
+}
+
+}  // namespace columnar（列存命名空间）
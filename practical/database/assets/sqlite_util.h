@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <sqlite3.h>
+
+namespace columnar {
+
+// sqlite3 C API 的最小 RAII 封装。
+// 错误统一通过 bool 返回值 + 可选的 error 输出参数上报。
+struct SqliteCloser {
+    void operator()(sqlite3* db) const noexcept { sqlite3_close_v2(db); }
+};
+
+struct StatementFinalizer {
+    void operator()(sqlite3_stmt* stmt) const noexcept { sqlite3_finalize(stmt); }
+};
+
+using SqliteHandle = std::unique_ptr<sqlite3, SqliteCloser>;
+using StatementHandle = std::unique_ptr<sqlite3_stmt, StatementFinalizer>;
+
+inline bool SetError(std::string* error, const std::string& message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+    return false;
+}
+
+inline bool SetSqliteError(std::string* error, sqlite3* db, const char* what) {
+    return SetError(error, std::string(what) + ": " +
+                               (db != nullptr ? sqlite3_errmsg(db) : "out of memory"));
+}
+
+inline bool OpenDatabase(const std::string& path,
+                         int flags,
+                         SqliteHandle* out,
+                         std::string* error = nullptr) {
+    sqlite3* raw = nullptr;
+    const int rc = sqlite3_open_v2(path.c_str(), &raw, flags, nullptr);
+    SqliteHandle db(raw);
+    if (rc != SQLITE_OK) {
+        return SetSqliteError(error, raw, ("open " + path).c_str());
+    }
+    *out = std::move(db);
+    return true;
+}
+
+inline bool Prepare(sqlite3* db,
+                    const std::string& sql,
+                    StatementHandle* out,
+                    std::string* error = nullptr) {
+    sqlite3_stmt* raw = nullptr;
+    if (sqlite3_prepare_v3(db, sql.c_str(), static_cast<int>(sql.size()),
+                           SQLITE_PREPARE_PERSISTENT, &raw, nullptr) != SQLITE_OK) {
+        return SetSqliteError(error, db, "prepare");
+    }
+    out->reset(raw);
+    return true;
+}
+
+inline bool Exec(sqlite3* db, const std::string& sql, std::string* error = nullptr) {
+    char* message = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &message) != SQLITE_OK) {
+        const std::string text = message != nullptr ? message : sqlite3_errmsg(db);
+        sqlite3_free(message);
+        return SetError(error, "exec: " + text);
+    }
+    return true;
+}
+
+// 用 backup API 把 src 整库拷贝到 dst（例如拷进 :memory: 做可写的实验副本）。
+inline bool CopyDatabase(sqlite3* src, sqlite3* dst, std::string* error = nullptr) {
+    sqlite3_backup* backup = sqlite3_backup_init(dst, "main", src, "main");
+    if (backup == nullptr) {
+        return SetSqliteError(error, dst, "backup init");
+    }
+    sqlite3_backup_step(backup, -1);
+    if (sqlite3_backup_finish(backup) != SQLITE_OK) {
+        return SetSqliteError(error, dst, "backup");
+    }
+    return true;
+}
+
+}  // namespace columnar（列存命名空间）
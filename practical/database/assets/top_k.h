@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <omp.h>
+
+#include "vector_engine.h"
+
+namespace columnar {
+
+enum class SortOrder : std::uint8_t { kAscending, kDescending };
+
+// top-K 的一个候选。row 是输入中的位置：整列版本即行号，
+// 带选择向量的版本是 sel 中的下标（调用方用 sel[row] 取回表内行号）。
+struct TopKEntry {
+    double value{0.0};
+    std::uint32_t row{0};
+};
+
+namespace detail {
+
+// 与 SQLite ORDER BY 一致：NULL 最小，升序排最前、降序排最后；
+// 值相同按位置靠前者优先，保证多线程合并后的结果确定。
+template <SortOrder Order>
+inline bool TopKBetter(const TopKEntry& a, const TopKEntry& b) noexcept {
+    const bool a_null = std::isnan(a.value);
+    const bool b_null = std::isnan(b.value);
+    if (a_null != b_null) {
+        return Order == SortOrder::kDescending ? b_null : a_null;
+    }
+    if (!a_null && a.value != b.value) {
+        return Order == SortOrder::kDescending ? a.value > b.value : a.value < b.value;
+    }
+    return a.row < b.row;
+}
+
+// 门槛预过滤：只留下“可能不比门槛差”的位置，其余行连堆都不用碰。
+// 比较包含等号（并列时还要按位置比），升序时 NULL 也要通过（NULL 排最前）。
+// 堆满之后绝大多数行在这里被 SIMD 批量淘汰。
+template <SortOrder Order>
+std::size_t TopKPrefilter(const double* values,
+                          std::size_t begin,
+                          std::size_t end,
+                          double threshold,
+                          std::uint32_t* out) noexcept {
+    std::size_t k = 0;
+    std::size_t i = begin;
+#if defined(__AVX2__)
+    constexpr int kPredicate = Order == SortOrder::kDescending ? _CMP_GE_OQ : _CMP_NGT_UQ;
+#endif
+#if defined(__AVX512F__) && defined(__AVX512VL__)
+    const __m512d vc = _mm512_set1_pd(threshold);
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(begin)),
+                                   _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    for (; i + 8 <= end; i += 8) {
+        const __mmask8 m = _mm512_cmp_pd_mask(_mm512_loadu_pd(values + i), vc, kPredicate);
+        _mm256_mask_compressstoreu_epi32(out + k, m, idx);
+        k += static_cast<std::size_t>(__builtin_popcount(m));
+        idx = _mm256_add_epi32(idx, step);
+    }
+#elif defined(__AVX2__)
+    const __m256d vc = _mm256_set1_pd(threshold);
+    for (; i + 4 <= end; i += 4) {
+        const int m =
+            _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(values + i), vc, kPredicate));
+        const __m128i lanes =
+            _mm_load_si128(reinterpret_cast<const __m128i*>(kCompressTable4.lanes[m]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + k),
+                         _mm_add_epi32(lanes, _mm_set1_epi32(static_cast<int>(i))));
+        k += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(m)));
+    }
+#endif
+    for (; i < end; ++i) {
+        out[k] = static_cast<std::uint32_t>(i);
+        const bool pass = Order == SortOrder::kDescending ? values[i] >= threshold
+                                                          : !(values[i] > threshold);
+        k += static_cast<std::size_t>(pass);
+    }
+    return k;
+}
+
+}  // namespace detail（内部实现）
+
+// 容量为 k 的有界堆，堆顶是当前第 k 名，也就是新候选的进入门槛。
+template <SortOrder Order>
+class TopKHeap {
+public:
+    explicit TopKHeap(std::size_t k) : k_(k) { heap_.reserve(k); }
+
+    std::size_t size() const noexcept { return heap_.size(); }
+    bool full() const noexcept { return heap_.size() >= k_; }
+
+    void Offer(double value, std::uint32_t row) {
+        const TopKEntry entry{value, row};
+        if (heap_.size() < k_) {
+            heap_.push_back(entry);
+            std::push_heap(heap_.begin(), heap_.end(), detail::TopKBetter<Order>);
+        } else if (k_ != 0 && detail::TopKBetter<Order>(entry, heap_.front())) {
+            std::pop_heap(heap_.begin(), heap_.end(), detail::TopKBetter<Order>);
+            heap_.back() = entry;
+            std::push_heap(heap_.begin(), heap_.end(), detail::TopKBetter<Order>);
+        }
+    }
+
+    // 一批连续值（n <= kBatchSize）：堆未满时逐个入堆，满了以后先按门槛 SIMD 预过滤。
+    // 第 i 个值的位置是 first_row + i。
+    void OfferBatch(const double* values, std::size_t n, std::uint32_t first_row) {
+        std::size_t i = 0;
+        for (; i < n && !full(); ++i) {
+            Offer(values[i], first_row + static_cast<std::uint32_t>(i));
+        }
+        if (i == n || k_ == 0) {
+            return;
+        }
+        const double threshold = heap_.front().value;
+        if (Order == SortOrder::kDescending && std::isnan(threshold)) {
+            // 门槛是 NULL：任何非 NULL 值都更好，预过滤无从淘汰，逐个比较。
+            for (; i < n; ++i) {
+                Offer(values[i], first_row + static_cast<std::uint32_t>(i));
+            }
+            return;
+        }
+        alignas(64) std::uint32_t candidates[kBatchSize];
+        const std::size_t m = detail::TopKPrefilter<Order>(values, i, n, threshold, candidates);
+        for (std::size_t j = 0; j < m; ++j) {
+            const std::uint32_t c = candidates[j];
+            Offer(values[c], first_row + c);
+        }
+    }
+
+    void Merge(const TopKHeap& other) {
+        for (const TopKEntry& entry : other.heap_) {
+            Offer(entry.value, entry.row);
+        }
+    }
+
+    // 按排序方向从好到差输出。
+    std::vector<TopKEntry> Sorted() const {
+        std::vector<TopKEntry> out = heap_;
+        std::sort(out.begin(), out.end(), detail::TopKBetter<Order>);
+        return out;
+    }
+
+private:
+    std::size_t k_;
+    std::vector<TopKEntry> heap_;
+};
+
+// 整列 top-K：各线程按批维护私有有界堆，最后合并，O(n + T * k log k)，无需全排序。
+template <SortOrder Order>
+std::vector<TopKEntry> ParallelTopK(const double* values, std::size_t n, std::size_t k) {
+    std::vector<TopKHeap<Order>> partials(static_cast<std::size_t>(omp_get_max_threads()),
+                                          TopKHeap<Order>(k));
+    ParallelBatches(n, [&](std::size_t begin, std::size_t end, int thread) {
+        partials[static_cast<std::size_t>(thread)].OfferBatch(
+            values + begin, end - begin, static_cast<std::uint32_t>(begin));
+    });
+    for (std::size_t t = 1; t < partials.size(); ++t) {
+        partials[0].Merge(partials[t]);
+    }
+    return partials[0].Sorted();
+}
+
+// 选择向量上的 top-K：值按 values[sel[i]] 取，先在批内 gather 成连续数组再预过滤。
+// 返回的 row 是 sel 中的下标，便于回到 join 结果等多列中间结果。
+template <SortOrder Order>
+std::vector<TopKEntry> ParallelTopK(const double* values,
+                                    const std::uint32_t* sel,
+                                    std::size_t n,
+                                    std::size_t k) {
+    std::vector<TopKHeap<Order>> partials(static_cast<std::size_t>(omp_get_max_threads()),
+                                          TopKHeap<Order>(k));
+    ParallelBatches(n, [&](std::size_t begin, std::size_t end, int thread) {
+        alignas(64) double gathered[kBatchSize];
+        for (std::size_t i = begin; i < end; ++i) {
+            gathered[i - begin] = values[sel[i]];
+        }
+        partials[static_cast<std::size_t>(thread)].OfferBatch(
+            gathered, end - begin, static_cast<std::uint32_t>(begin));
+    });
+    for (std::size_t t = 1; t < partials.size(); ++t) {
+        partials[0].Merge(partials[t]);
+    }
+    return partials[0].Sorted();
+}
+
+}  // namespace columnar（列存命名空间）
@@ -0,0 +1,483 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <omp.h>
+
+#include "column.h"
+#include "detail/flat_index_map.h"
+#include "detail/mix_hash.h"
+
+namespace columnar {
+
+// 向量化执行的批大小：一批的选择向量与中间结果都留在 L1/L2 内。
+constexpr std::size_t kBatchSize = 2048;
+constexpr std::uint32_t kNoRow = 0xffffffffu;
+
+// 选择向量：存放通过谓词的行号（绝对下标），后续算子只处理这些行。
+using SelectionVector = kvcache::detail::AlignedVector<std::uint32_t>;
+
+// 谓词语义与 SQL 一致：任一侧为 NULL（NaN）时结果为 false，包括 kNotEqual。
+enum class CompareOp : std::uint8_t {
+    kLess,
+    kLessEqual,
+    kGreater,
+    kGreaterEqual,
+    kEqual,
+    kNotEqual,
+};
+
+namespace detail {
+
+template <CompareOp Op>
+inline bool CompareScalar(double v, double c) noexcept {
+    if constexpr (Op == CompareOp::kLess) {
+        return v < c;
+    } else if constexpr (Op == CompareOp::kLessEqual) {
+        return v <= c;
+    } else if constexpr (Op == CompareOp::kGreater) {
+        return v > c;
+    } else if constexpr (Op == CompareOp::kGreaterEqual) {
+        return v >= c;
+    } else if constexpr (Op == CompareOp::kEqual) {
+        return v == c;
+    } else {
+        return v == v && c == c && v != c;
+    }
+}
+
+#if defined(__AVX2__)
+// 有序、非信号比较谓词：NaN 参与时结果为 false，对应 SQL 的 NULL 语义。
+template <CompareOp Op>
+constexpr int Avx2Predicate() noexcept {
+    if constexpr (Op == CompareOp::kLess) {
+        return _CMP_LT_OQ;
+    } else if constexpr (Op == CompareOp::kLessEqual) {
+        return _CMP_LE_OQ;
+    } else if constexpr (Op == CompareOp::kGreater) {
+        return _CMP_GT_OQ;
+    } else if constexpr (Op == CompareOp::kGreaterEqual) {
+        return _CMP_GE_OQ;
+    } else if constexpr (Op == CompareOp::kEqual) {
+        return _CMP_EQ_OQ;
+    } else {
+        return _CMP_NEQ_OQ;
+    }
+}
+
+// 4 位比较掩码 -> 命中 lane 的紧凑下标表，用于把比较结果压缩写入选择向量。
+struct CompressTable4 {
+    alignas(16) std::uint32_t lanes[16][4];
+
+    constexpr CompressTable4() : lanes() {
+        for (std::uint32_t mask = 0; mask < 16; ++mask) {
+            std::uint32_t k = 0;
+            for (std::uint32_t lane = 0; lane < 4; ++lane) {
+                if ((mask >> lane) & 1u) {
+                    lanes[mask][k++] = lane;
+                }
+            }
+        }
+    }
+};
+
+inline constexpr CompressTable4 kCompressTable4{};
+#endif
+
+}  // namespace detail（内部实现）
+
+// 对 values[begin, end) 求值 values[i] Op c，把命中行号写入 out，返回命中数。
+// out 至少需要 end - begin 个元素的空间。
+template <CompareOp Op>
+std::size_t SelectCompare(const double* values,
+                          std::size_t begin,
+                          std::size_t end,
+                          double c,
+                          std::uint32_t* out) noexcept {
+    std::size_t k = 0;
+    std::size_t i = begin;
+#if defined(__AVX512F__) && defined(__AVX512VL__)
+    const __m512d vc = _mm512_set1_pd(c);
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(begin)),
+                                   _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    for (; i + 8 <= end; i += 8) {
+        const __mmask8 m =
+            _mm512_cmp_pd_mask(_mm512_loadu_pd(values + i), vc, detail::Avx2Predicate<Op>());
+        _mm256_mask_compressstoreu_epi32(out + k, m, idx);
+        k += static_cast<std::size_t>(__builtin_popcount(m));
+        idx = _mm256_add_epi32(idx, step);
+    }
+#elif defined(__AVX2__)
+    const __m256d vc = _mm256_set1_pd(c);
+    for (; i + 4 <= end; i += 4) {
+        const __m256d cmp =
+            _mm256_cmp_pd(_mm256_loadu_pd(values + i), vc, detail::Avx2Predicate<Op>());
+        const int m = _mm256_movemask_pd(cmp);
+        // 无条件写 4 个下标，再按命中数推进游标：k <= i - begin，因此不会越界。
+        const __m128i lanes = _mm_load_si128(
+            reinterpret_cast<const __m128i*>(detail::kCompressTable4.lanes[m]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + k),
+                         _mm_add_epi32(lanes, _mm_set1_epi32(static_cast<int>(i))));
+        k += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(m)));
+    }
+#endif
+    for (; i < end; ++i) {
+        out[k] = static_cast<std::uint32_t>(i);
+        k += static_cast<std::size_t>(detail::CompareScalar<Op>(values[i], c));
+    }
+    return k;
+}
+
+// 在已有选择向量上继续过滤（AND）；允许 out == sel 原地收缩。
+template <CompareOp Op>
+std::size_t RefineCompare(const double* values,
+                          const std::uint32_t* sel,
+                          std::size_t n,
+                          double c,
+                          std::uint32_t* out) noexcept {
+    std::size_t k = 0;
+    for (std::size_t j = 0; j < n; ++j) {
+        const std::uint32_t row = sel[j];
+        out[k] = row;
+        k += static_cast<std::size_t>(detail::CompareScalar<Op>(values[row], c));
+    }
+    return k;
+}
+
+// 运行时 op 分派版本，内部仍走模板特化的紧凑循环。
+inline std::size_t SelectCompare(CompareOp op,
+                                 const double* values,
+                                 std::size_t begin,
+                                 std::size_t end,
+                                 double c,
+                                 std::uint32_t* out) noexcept {
+    switch (op) {
+        case CompareOp::kLess:
+            return SelectCompare<CompareOp::kLess>(values, begin, end, c, out);
+        case CompareOp::kLessEqual:
+            return SelectCompare<CompareOp::kLessEqual>(values, begin, end, c, out);
+        case CompareOp::kGreater:
+            return SelectCompare<CompareOp::kGreater>(values, begin, end, c, out);
+        case CompareOp::kGreaterEqual:
+            return SelectCompare<CompareOp::kGreaterEqual>(values, begin, end, c, out);
+        case CompareOp::kEqual:
+            return SelectCompare<CompareOp::kEqual>(values, begin, end, c, out);
+        case CompareOp::kNotEqual:
+            return SelectCompare<CompareOp::kNotEqual>(values, begin, end, c, out);
+    }
+    return 0;
+}
+
+// CASE WHEN v >= t[0] THEN 0 WHEN v >= t[1] THEN 1 ... ELSE k 的分桶编码，
+// thresholds 需按降序排列；NULL 落入 ELSE 分支（编码 k）。
+inline void CaseGreaterEqual(const double* values,
+                             std::size_t begin,
+                             std::size_t end,
+                             const double* thresholds,
+                             std::uint32_t k,
+                             std::uint32_t* out) noexcept {
+    const std::size_t n = end - begin;
+    const double* v = values + begin;
+#pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint32_t code = k;
+        for (std::uint32_t t = 0; t < k; ++t) {
+            code -= static_cast<std::uint32_t>(v[i] >= thresholds[t]);
+        }
+        out[i] = code;
+    }
+}
+
+// 与 SQLite round(x, digits) 一致的四舍五入（远离零）。
+inline double SqlRound(double x, int digits) noexcept {
+    if (std::isnan(x)) {
+        return x;
+    }
+    const double scale = std::pow(10.0, digits);
+    return std::round(x * scale) / scale;
+}
+
+// dense id -> 行号的直接寻址索引：id 空间就是字典大小，无需哈希。
+// 用作 dense 键等值 join 的 build 侧；不存在的 id 为 kNoRow。
+inline std::vector<std::uint32_t> BuildDenseIndex(const std::uint32_t* ids,
+                                                  std::size_t n,
+                                                  std::size_t id_space) {
+    std::vector<std::uint32_t> row_of(id_space, kNoRow);
+    for (std::size_t i = 0; i < n; ++i) {
+        row_of[ids[i]] = static_cast<std::uint32_t>(i);
+    }
+    return row_of;
+}
+
+// 用 probe 侧 ids[begin, end) 查 dense 索引（内连接）：
+// 命中的 probe 行号写 sel，对应 build 行号写 build_rows，返回命中数。
+inline std::size_t ProbeDenseIndex(const std::uint32_t* ids,
+                                   std::size_t begin,
+                                   std::size_t end,
+                                   const std::uint32_t* row_of,
+                                   std::uint32_t* sel,
+                                   std::uint32_t* build_rows) noexcept {
+    std::size_t k = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        const std::uint32_t row = row_of[ids[i]];
+        sel[k] = static_cast<std::uint32_t>(i);
+        build_rows[k] = row;
+        k += static_cast<std::size_t>(row != kNoRow);
+    }
+    return k;
+}
+
+// Neumaier 补偿求和：并行分块合并时顺序会变，补偿项让 AVG 结果与串行求和一致。
+struct CompensatedSum {
+    double sum{0.0};
+    double compensation{0.0};
+
+    void Add(double x) noexcept {
+        const double t = sum + x;
+        if (std::fabs(sum) >= std::fabs(x)) {
+            compensation += (sum - t) + x;
+        } else {
+            compensation += (x - t) + sum;
+        }
+        sum = t;
+    }
+
+    void Merge(const CompensatedSum& other) noexcept {
+        Add(other.sum);
+        compensation += other.compensation;
+    }
+
+    double value() const noexcept { return sum + compensation; }
+};
+
+// 整数分组键上的哈希聚合：COUNT(*) 以及每个度量的 SUM / 非 NULL 计数（AVG）。
+// 分组键 -> 组槽位使用固定容量的 FlatIndexMap，组状态按槽位平铺存放。
+class HashAggregator {
+public:
+    HashAggregator(std::size_t max_groups, std::size_t measures)
+        : index_(max_groups), measures_(measures) {
+        keys_.reserve(max_groups);
+        counts_.reserve(max_groups);
+        sums_.reserve(max_groups * measures);
+        non_null_.reserve(max_groups * measures);
+    }
+
+    std::size_t size() const noexcept { return keys_.size(); }
+
+    std::size_t measures() const noexcept { return measures_; }
+
+    // 分组数超过 max_groups 时返回 kNoRow，调用方据此判定溢出。
+    std::uint32_t Slot(std::uint32_t key) {
+        std::uint32_t slot = 0;
+        if (index_.Find(key, &slot)) {
+            return slot;
+        }
+        slot = static_cast<std::uint32_t>(keys_.size());
+        if (!index_.Insert(key, slot)) {
+            return kNoRow;
+        }
+        keys_.push_back(key);
+        counts_.push_back(0);
+        sums_.resize(sums_.size() + measures_);
+        non_null_.resize(non_null_.size() + measures_, 0);
+        return slot;
+    }
+
+    // measures 按构造时的度量顺序排列；NaN 视作 NULL，不计入 SUM/AVG。
+    bool Add(std::uint32_t key, const double* measures) {
+        const std::uint32_t slot = Slot(key);
+        if (slot == kNoRow) {
+            return false;
+        }
+        ++counts_[slot];
+        const std::size_t base = static_cast<std::size_t>(slot) * measures_;
+        for (std::size_t m = 0; m < measures_; ++m) {
+            const double v = measures[m];
+            if (!IsNull(v)) {
+                sums_[base + m].Add(v);
+                ++non_null_[base + m];
+            }
+        }
+        return true;
+    }
+
+    bool Merge(const HashAggregator& other) {
+        for (std::size_t s = 0; s < other.size(); ++s) {
+            const std::uint32_t slot = Slot(other.keys_[s]);
+            if (slot == kNoRow) {
+                return false;
+            }
+            counts_[slot] += other.counts_[s];
+            const std::size_t base = static_cast<std::size_t>(slot) * measures_;
+            const std::size_t other_base = s * measures_;
+            for (std::size_t m = 0; m < measures_; ++m) {
+                sums_[base + m].Merge(other.sums_[other_base + m]);
+                non_null_[base + m] += other.non_null_[other_base + m];
+            }
+        }
+        return true;
+    }
+
+    std::uint32_t key(std::size_t slot) const noexcept { return keys_[slot]; }
+
+    std::int64_t count(std::size_t slot) const noexcept { return counts_[slot]; }
+
+    double Sum(std::size_t slot, std::size_t measure) const noexcept {
+        return sums_[slot * measures_ + measure].value();
+    }
+
+    // 与 SQL AVG 一致：全部为 NULL 时结果为 NULL（NaN）。
+    double Avg(std::size_t slot, std::size_t measure) const noexcept {
+        const std::int64_t n = non_null_[slot * measures_ + measure];
+        return n == 0 ? kNullFloat64 : Sum(slot, measure) / static_cast<double>(n);
+    }
+
+private:
+    kvcache::detail::FlatIndexMap<std::uint32_t, detail::MixHash32, std::equal_to<std::uint32_t>>
+        index_;
+    std::size_t measures_{0};
+    std::vector<std::uint32_t> keys_;
+    std::vector<std::int64_t> counts_;
+    std::vector<CompensatedSum> sums_;
+    std::vector<std::int64_t> non_null_;
+};
+
+// 把 [0, rows) 按 kBatchSize 切批，由 OpenMP 静态调度到各线程：
+// fn(begin, end, thread_id)。thread_id 用于索引线程私有的中间状态。
+template <typename BatchFn>
+void ParallelBatches(std::size_t rows, BatchFn&& fn) {
+    const auto batches = static_cast<std::int64_t>((rows + kBatchSize - 1) / kBatchSize);
+#pragma omp parallel for schedule(static)
+    for (std::int64_t b = 0; b < batches; ++b) {
+        const std::size_t begin = static_cast<std::size_t>(b) * kBatchSize;
+        const std::size_t end = begin + kBatchSize < rows ? begin + kBatchSize : rows;
+        fn(begin, end, omp_get_thread_num());
+    }
+}
+
+namespace detail {
+
+// 并行过滤的收尾：第 c 块的命中行号已压紧写在 sel[c * chunk] 起，按块顺序拼接。
+inline void CompactChunks(SelectionVector* sel,
+                          const std::vector<std::size_t>& counts,
+                          std::size_t chunk) {
+    std::size_t k = 0;
+    for (std::size_t c = 0; c < counts.size(); ++c) {
+        if (k != c * chunk) {
+            std::memmove(sel->data() + k, sel->data() + c * chunk,
+                         counts[c] * sizeof(std::uint32_t));
+        }
+        k += counts[c];
+    }
+    sel->resize(k);
+}
+
+}  // namespace detail（内部实现）
+
+// 整列并行过滤：每批先压紧写到自身起始偏移处，再顺序拼接成一个选择向量。
+template <CompareOp Op>
+SelectionVector FilterRows(const double* values, std::size_t n, double c) {
+    SelectionVector sel(n);
+    std::vector<std::size_t> counts((n + kBatchSize - 1) / kBatchSize);
+    ParallelBatches(n, [&](std::size_t begin, std::size_t end, int) {
+        counts[begin / kBatchSize] = SelectCompare<Op>(values, begin, end, c, sel.data() + begin);
+    });
+    detail::CompactChunks(&sel, counts, kBatchSize);
+    return sel;
+}
+
+// 按 zone 的 min/max 判断整块结果：全不命中可跳过，全命中直接写行号，其余再逐行比较。
+enum class ZoneVerdict : std::uint8_t { kNone, kAll, kSome };
+
+template <CompareOp Op, typename T>
+ZoneVerdict ClassifyZone(T min, T max, std::uint32_t nulls, double c) noexcept {
+    const auto lo = static_cast<double>(min);
+    const auto hi = static_cast<double>(max);
+    if (std::isnan(c) || lo > hi) {
+        return ZoneVerdict::kNone;  // 与 NULL 比较恒为 false，全 NULL 块同理
+    }
+    bool none = false;
+    bool all = false;
+    if constexpr (Op == CompareOp::kGreater || Op == CompareOp::kGreaterEqual) {
+        none = !detail::CompareScalar<Op>(hi, c);
+        all = detail::CompareScalar<Op>(lo, c);
+    } else if constexpr (Op == CompareOp::kLess || Op == CompareOp::kLessEqual) {
+        none = !detail::CompareScalar<Op>(lo, c);
+        all = detail::CompareScalar<Op>(hi, c);
+    } else if constexpr (Op == CompareOp::kEqual) {
+        none = c < lo || c > hi;
+        all = lo == c && hi == c;
+    } else {
+        none = lo == c && hi == c;
+        all = c < lo || c > hi;
+    }
+    if (none) {
+        return ZoneVerdict::kNone;
+    }
+    // 块内有 NULL 时不能整块命中。
+    return all && nulls == 0 ? ZoneVerdict::kAll : ZoneVerdict::kSome;
+}
+
+struct ZoneScanStats {
+    std::size_t skipped{0};
+    std::size_t full{0};
+    std::size_t scanned{0};
+};
+
+// 带 zone map 剪枝的整列过滤，结果与 FilterRows 完全相同。
+// 按 zone 并行：kNone 块不读数据，kAll 块只写连续行号，kSome 块走 SIMD SelectCompare。
+template <CompareOp Op>
+SelectionVector FilterRowsZoned(const double* values,
+                                const ZoneMapView<double>& zones,
+                                double c,
+                                ZoneScanStats* stats = nullptr) {
+    const std::size_t n = zones.rows;
+    SelectionVector sel(n);
+    std::vector<std::size_t> counts(zones.zones);
+    std::size_t skipped = 0;
+    std::size_t full = 0;
+#pragma omp parallel for schedule(dynamic, 4) reduction(+ : skipped, full)
+    for (std::int64_t z = 0; z < static_cast<std::int64_t>(zones.zones); ++z) {
+        const auto zone = static_cast<std::size_t>(z);
+        const std::size_t begin = zone * kZoneRows;
+        const std::size_t end = begin + kZoneRows < n ? begin + kZoneRows : n;
+        std::uint32_t* out = sel.data() + begin;
+        switch (ClassifyZone<Op>(zones.min[zone], zones.max[zone], zones.nulls[zone], c)) {
+            case ZoneVerdict::kNone:
+                counts[zone] = 0;
+                ++skipped;
+                break;
+            case ZoneVerdict::kAll:
+#pragma omp simd
+                for (std::size_t i = begin; i < end; ++i) {
+                    out[i - begin] = static_cast<std::uint32_t>(i);
+                }
+                counts[zone] = end - begin;
+                ++full;
+                break;
+            case ZoneVerdict::kSome:
+                counts[zone] = SelectCompare<Op>(values, begin, end, c, out);
+                break;
+        }
+    }
+    detail::CompactChunks(&sel, counts, kZoneRows);
+    if (stats != nullptr) {
+        stats->skipped = skipped;
+        stats->full = full;
+        stats->scanned = zones.zones - skipped - full;
+    }
+    return sel;
+}
+
+}  // namespace columnar（列存命名空间）
@@ -0,0 +1,1068 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "columnar_file.h"
+#include "finace_loader.h"
+#include "finace_queries.h"
+#include "finace_tables.h"
+#include "finace_views.h"
+#include "hash_join.h"
+#include "sqlite_fdkv.h"
+#include "sqlite_util.h"
+#include "top_k.h"
+#include "vector_engine.h"
+
+namespace {
+
+// 默认读取 notebook 生成的 .db/finace.db；可用环境变量 FINACE_DB 覆盖。
+std::string DatabasePath() {
+    const char* env = std::getenv("FINACE_DB");
+    return env != nullptr ? std::string(env) : std::string(FINACE_DB_PATH);
+}
+
+// 所有基准共用一个只读连接；打开失败时各基准 SkipWithError。
+sqlite3* SharedDb(std::string* error) {
+    static std::string open_error;
+    static columnar::SqliteHandle db = [] {
+        columnar::SqliteHandle handle;
+        columnar::OpenFinaceReadOnly(DatabasePath(), &handle, &open_error);
+        return handle;
+    }();
+    if (db == nullptr && error != nullptr) {
+        *error = open_error;
+    }
+    return db.get();
+}
+
+// 每轮用新的字典和空表完整加载一次，items_per_second 即 rows/s。
+template <typename Table, typename LoadFn>
+void RunLoadBenchmark(benchmark::State& state, LoadFn&& load) {
+    std::string error;
+    sqlite3* db = SharedDb(&error);
+    if (db == nullptr) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+
+    std::size_t rows = 0;
+    for (auto _ : state) {
+        columnar::CustIdDictionary dict;
+        Table table;
+        if (!load(db, &dict, &table, &error)) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        rows = table.size();
+        benchmark::DoNotOptimize(table.cust_id.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+
+void BM_Load_Customers(benchmark::State& state) {
+    RunLoadBenchmark<columnar::CustomersTable>(
+        state, [](auto&&... args) { return columnar::LoadCustomers(args...); });
+}
+BENCHMARK(BM_Load_Customers)->Unit(benchmark::kMicrosecond);
+
+void BM_Load_AccountSummary(benchmark::State& state) {
+    RunLoadBenchmark<columnar::AccountSummaryTable>(
+        state, [](auto&&... args) { return columnar::LoadAccountSummary(args...); });
+}
+BENCHMARK(BM_Load_AccountSummary)->Unit(benchmark::kMicrosecond);
+
+void BM_Load_PurchaseActivity(benchmark::State& state) {
+    RunLoadBenchmark<columnar::PurchaseActivityTable>(
+        state, [](auto&&... args) { return columnar::LoadPurchaseActivity(args...); });
+}
+BENCHMARK(BM_Load_PurchaseActivity)->Unit(benchmark::kMicrosecond);
+
+void BM_Load_CashAdvanceActivity(benchmark::State& state) {
+    RunLoadBenchmark<columnar::CashAdvanceActivityTable>(
+        state, [](auto&&... args) { return columnar::LoadCashAdvanceActivity(args...); });
+}
+BENCHMARK(BM_Load_CashAdvanceActivity)->Unit(benchmark::kMicrosecond);
+
+void BM_Load_PaymentActivity(benchmark::State& state) {
+    RunLoadBenchmark<columnar::PaymentActivityTable>(
+        state, [](auto&&... args) { return columnar::LoadPaymentActivity(args...); });
+}
+BENCHMARK(BM_Load_PaymentActivity)->Unit(benchmark::kMicrosecond);
+
+// 五张表一次性加载（含打开连接），对应 notebook 中逐表 pd.read_sql 的总耗时。
+void BM_Load_AllTables(benchmark::State& state) {
+    std::size_t rows = 0;
+    for (auto _ : state) {
+        columnar::FinaceTables tables;
+        std::string error;
+        if (!columnar::LoadFinaceTables(DatabasePath(), &tables, &error)) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        rows = tables.total_rows();
+        benchmark::DoNotOptimize(tables.customers.cust_id.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+BENCHMARK(BM_Load_AllTables)->Unit(benchmark::kMillisecond);
+
+// 查询类基准共用一份已加载的列存表。
+struct QueryDataset {
+    columnar::FinaceTables tables;
+    std::string error;
+    bool ok{false};
+
+    QueryDataset() { ok = columnar::LoadFinaceTables(DatabasePath(), &tables, &error); }
+};
+
+const QueryDataset& GetQueryDataset() {
+    static QueryDataset data;
+    return data;
+}
+
+// 原生结果必须与 SQLite 逐行一致，否则基准直接报错而不是给出无意义的速度。
+template <typename Row, typename NativeFn, typename SqliteFn>
+bool CheckAgainstSqlite(benchmark::State& state, NativeFn&& native, SqliteFn&& sqlite) {
+    const QueryDataset& data = GetQueryDataset();
+    std::string error;
+    sqlite3* db = SharedDb(&error);
+    if (!data.ok || db == nullptr) {
+        state.SkipWithError((data.ok ? error : data.error).c_str());
+        return false;
+    }
+    std::vector<Row> expected;
+    if (!sqlite(db, &expected, &error)) {
+        state.SkipWithError(error.c_str());
+        return false;
+    }
+    if (!columnar::SameResult(native(data.tables), expected)) {
+        state.SkipWithError("native result differs from SQLite");
+        return false;
+    }
+    return true;
+}
+
+void BM_Native_PurchaseBand(benchmark::State& state) {
+    if (!CheckAgainstSqlite<columnar::PurchaseBandRow>(
+            state, columnar::PurchaseBandSummary,
+            [](auto&&... args) { return columnar::SqlitePurchaseBandSummary(args...); })) {
+        return;
+    }
+    const columnar::FinaceTables& tables = GetQueryDataset().tables;
+    for (auto _ : state) {
+        auto rows = columnar::PurchaseBandSummary(tables);
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * tables.purchase_activity.size()));
+}
+BENCHMARK(BM_Native_PurchaseBand)->Unit(benchmark::kMicrosecond);
+
+void BM_Sqlite_PurchaseBand(benchmark::State& state) {
+    std::string error;
+    sqlite3* db = SharedDb(&error);
+    if (db == nullptr) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    std::vector<columnar::PurchaseBandRow> rows;
+    for (auto _ : state) {
+        if (!columnar::SqlitePurchaseBandSummary(db, &rows, &error)) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(
+        state.iterations() * GetQueryDataset().tables.purchase_activity.size()));
+}
+BENCHMARK(BM_Sqlite_PurchaseBand)->Unit(benchmark::kMicrosecond);
+
+void BM_Native_PaymentSegment(benchmark::State& state) {
+    if (!CheckAgainstSqlite<columnar::PaymentSegmentRow>(
+            state, columnar::PaymentSegmentSummary,
+            [](auto&&... args) { return columnar::SqlitePaymentSegmentSummary(args...); })) {
+        return;
+    }
+    const columnar::FinaceTables& tables = GetQueryDataset().tables;
+    for (auto _ : state) {
+        auto rows = columnar::PaymentSegmentSummary(tables);
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * tables.payment_activity.size()));
+}
+BENCHMARK(BM_Native_PaymentSegment)->Unit(benchmark::kMicrosecond);
+
+void BM_Sqlite_PaymentSegment(benchmark::State& state) {
+    std::string error;
+    sqlite3* db = SharedDb(&error);
+    if (db == nullptr) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    std::vector<columnar::PaymentSegmentRow> rows;
+    for (auto _ : state) {
+        if (!columnar::SqlitePaymentSegmentSummary(db, &rows, &error)) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(
+        state.iterations() * GetQueryDataset().tables.payment_activity.size()));
+}
+BENCHMARK(BM_Sqlite_PaymentSegment)->Unit(benchmark::kMicrosecond);
+
+// TopBalances 连接四张表，每份副本输入 4 * 8950 = 35800 行，2794 份约 1 亿行；
+// ReplicateTables 会复制全部五张表，常驻内存约 4.4GB。
+constexpr std::int64_t kScaleFor100MRows = 2794;
+
+// scale 档位：1 / 16 / 256；1 亿行一档占用数 GB，只在设置 FINACE_SCALE_100M=1 时注册。
+void ScaleArgs(benchmark::internal::Benchmark* b) {
+    b->Arg(1)->Arg(16)->Arg(256);
+    const char* env = std::getenv("FINACE_SCALE_100M");
+    if (env != nullptr && std::string(env) == "1") {
+        b->Arg(kScaleFor100MRows);
+    }
+}
+
+// 按 scale 复制后的表；同一时刻只保留一份副本，换 scale 时先释放旧的。
+const columnar::FinaceTables* ScaledTables(std::size_t scale) {
+    static std::size_t cached_scale = 0;
+    static std::unique_ptr<columnar::FinaceTables> cached;
+    const QueryDataset& data = GetQueryDataset();
+    if (!data.ok) {
+        return nullptr;
+    }
+    if (scale <= 1) {
+        return &data.tables;
+    }
+    if (cached_scale != scale) {
+        cached.reset();
+        cached = std::make_unique<columnar::FinaceTables>(
+            columnar::ReplicateTables(data.tables, scale));
+        cached_scale = scale;
+    }
+    return cached.get();
+}
+
+std::size_t TopBalancesInputRows(const columnar::FinaceTables& tables) {
+    return tables.customers.size() + tables.account_summary.size() +
+           tables.payment_activity.size() + tables.purchase_activity.size();
+}
+
+// 参数为复制倍数；正确性只在原始规模上与 SQLite 对照。
+void BM_Native_TopBalances(benchmark::State& state) {
+    if (!CheckAgainstSqlite<columnar::TopBalanceRow>(
+            state, [](const columnar::FinaceTables& t) { return columnar::TopBalances(t); },
+            [](auto&&... args) { return columnar::SqliteTopBalances(args...); })) {
+        return;
+    }
+    const columnar::FinaceTables* tables =
+        ScaledTables(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto rows = columnar::TopBalances(*tables);
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * TopBalancesInputRows(*tables)));
+    state.counters["input_rows"] = static_cast<double>(TopBalancesInputRows(*tables));
+}
+BENCHMARK(BM_Native_TopBalances)->Apply(ScaleArgs)->Unit(benchmark::kMillisecond);
+
+void BM_Sqlite_TopBalances(benchmark::State& state) {
+    std::string error;
+    sqlite3* db = SharedDb(&error);
+    if (db == nullptr) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    std::vector<columnar::TopBalanceRow> rows;
+    for (auto _ : state) {
+        if (!columnar::SqliteTopBalances(db, &rows, &error)) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(
+        state.iterations() * TopBalancesInputRows(GetQueryDataset().tables)));
+}
+BENCHMARK(BM_Sqlite_TopBalances)->Unit(benchmark::kMillisecond);
+
+// 列存文件默认写在 /tmp，可用环境变量 FINACE_COLUMNAR_DIR 指定目录。
+// 已有文件能正常打开且头部记录的 finace.db 大小、修改时间与当前一致时直接复用，
+// 否则（不存在、损坏、旧版本或数据库已更新）从 finace.db 重写。
+std::string ColumnarPath(std::size_t scale, std::string* error) {
+    const char* dir = std::getenv("FINACE_COLUMNAR_DIR");
+    const std::string path = std::string(dir != nullptr ? dir : "/tmp") + "/finace_x" +
+                             std::to_string(scale) + ".fcol";
+    columnar::SourceStamp source;
+    if (!columnar::StatSourceStamp(DatabasePath(), &source, error)) {
+        return std::string();
+    }
+    {
+        columnar::ColumnarFile probe;
+        if (probe.Open(path) && probe.source() == source) {
+            return path;
+        }
+    }
+    const columnar::FinaceTables* tables = ScaledTables(scale);
+    if (tables == nullptr) {
+        *error = GetQueryDataset().error;
+        return std::string();
+    }
+    return columnar::WriteColumnarFile(path, *tables, source, error) ? path : std::string();
+}
+
+// 分析任务冷启动：每轮从 finace.db 完整加载五张表（逐行 step + 解码 + 追加）。
+void BM_Reload_Sqlite(benchmark::State& state) {
+    std::string error;
+    std::size_t rows = 0;
+    for (auto _ : state) {
+        columnar::FinaceTables tables;
+        if (!columnar::LoadFinaceTables(DatabasePath(), &tables, &error)) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        rows = tables.total_rows();
+        benchmark::DoNotOptimize(tables.customers.cust_id.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+BENCHMARK(BM_Reload_Sqlite)->Unit(benchmark::kMillisecond);
+
+// 同样的冷启动改为 mmap 打开列存文件：只校验头部并挂接列，数据页由 page cache 按需提供。
+// 参数为复制倍数；打开后的查询结果须与内存中的表一致。
+void BM_Reload_Columnar(benchmark::State& state) {
+    const auto scale = static_cast<std::size_t>(state.range(0));
+    std::string error;
+    const std::string path = ColumnarPath(scale, &error);
+    const columnar::FinaceTables* expected = ScaledTables(scale);
+    if (path.empty() || expected == nullptr) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    {
+        columnar::ColumnarFile file;
+        if (!file.Open(path, &error)) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        if (file.tables().total_rows() != expected->total_rows() ||
+            !columnar::SameResult(columnar::PaymentSegmentSummary(file.tables()),
+                                  columnar::PaymentSegmentSummary(*expected)) ||
+            !columnar::SameResult(columnar::TopBalances(file.tables()),
+                                  columnar::TopBalances(*expected))) {
+            state.SkipWithError("columnar file differs from the loaded tables");
+            return;
+        }
+        state.counters["file_mb"] = static_cast<double>(file.file_size()) / (1024.0 * 1024.0);
+    }
+    std::size_t rows = 0;
+    for (auto _ : state) {
+        columnar::ColumnarFile file;
+        if (!file.Open(path, &error)) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        rows = file.tables().total_rows();
+        benchmark::DoNotOptimize(file.tables().customers.cust_id.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+}
+BENCHMARK(BM_Reload_Columnar)->Arg(1)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+// 两张整表的主键 join（build = payment_activity，probe = purchase_activity）。
+// 第二个参数是分区位数，-1 表示按 build 行数自动选择；0 即不分区的单表哈希 join，
+// build 侧超出缓存后每次 probe 都是一次随机 DRAM 访问。
+void BM_RadixJoin_PaymentPurchase(benchmark::State& state) {
+    const columnar::FinaceTables* tables =
+        ScaledTables(static_cast<std::size_t>(state.range(0)));
+    if (tables == nullptr) {
+        state.SkipWithError(GetQueryDataset().error.c_str());
+        return;
+    }
+    const auto bits = state.range(1) < 0 ? columnar::kAutoRadixBits
+                                         : static_cast<std::uint32_t>(state.range(1));
+    const columnar::PaymentActivityTable& pm = tables->payment_activity;
+    const columnar::PurchaseActivityTable& pa = tables->purchase_activity;
+    std::size_t matched = 0;
+    std::uint32_t used_bits = 0;
+    for (auto _ : state) {
+        columnar::RadixHashJoin join(bits);
+        join.Build(pm.cust_id.data(), nullptr, pm.size());
+        const columnar::JoinResult result = join.Probe(pa.cust_id.data(), nullptr, pa.size());
+        matched = result.size();
+        used_bits = join.radix_bits();
+        benchmark::DoNotOptimize(result.probe_rows.data());
+    }
+    if (matched != pa.size()) {
+        state.SkipWithError("join lost rows");
+        return;
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * (pm.size() + pa.size())));
+    state.counters["radix_bits"] = static_cast<double>(used_bits);
+}
+BENCHMARK(BM_RadixJoin_PaymentPurchase)
+    ->ArgsProduct({{1, 16, 256}, {0, -1}})
+    ->Unit(benchmark::kMillisecond);
+
+// zone map 基准数据：account_summary.balance 复制 kZoneBenchScale 份。
+// natural 保持原始行序（余额随机分布，zone 几乎无法剪枝）；
+// clustered 按余额排序后追加，模拟按写入时间/业务键聚簇的表。
+// 同一批余额另写入内存 SQLite 表并建索引，对照 B-tree 二级索引。
+constexpr std::size_t kZoneBenchScale = 64;
+
+struct ZoneBenchData {
+    columnar::Float64Column natural;
+    columnar::Float64Column clustered;
+    std::vector<double> sorted;
+    columnar::SqliteHandle db;
+    std::string error;
+    bool ok{false};
+
+    ZoneBenchData() {
+        const QueryDataset& data = GetQueryDataset();
+        if (!data.ok) {
+            error = data.error;
+            return;
+        }
+        const columnar::Float64Column& balance = data.tables.account_summary.balance;
+        for (std::size_t r = 0; r < kZoneBenchScale; ++r) {
+            for (std::size_t i = 0; i < balance.size(); ++i) {
+                natural.Append(balance[i]);
+                sorted.push_back(balance[i]);
+            }
+        }
+        std::sort(sorted.begin(), sorted.end());
+        for (double v : sorted) {
+            clustered.Append(v);
+        }
+        ok = BuildSqlite();
+    }
+
+    bool BuildSqlite() {
+        if (!columnar::OpenDatabase(":memory:", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, &db,
+                                    &error) ||
+            !columnar::Exec(db.get(), "CREATE TABLE account_balance(balance REAL)", &error) ||
+            !columnar::Exec(db.get(), "BEGIN", &error)) {
+            return false;
+        }
+        columnar::StatementHandle insert;
+        if (!columnar::Prepare(db.get(), "INSERT INTO account_balance(balance) VALUES (?)",
+                               &insert, &error)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < natural.size(); ++i) {
+            sqlite3_bind_double(insert.get(), 1, natural[i]);
+            if (sqlite3_step(insert.get()) != SQLITE_DONE) {
+                return columnar::SetSqliteError(&error, db.get(), "insert");
+            }
+            sqlite3_reset(insert.get());
+        }
+        return columnar::Exec(db.get(), "COMMIT", &error) &&
+               columnar::Exec(db.get(),
+                              "CREATE INDEX idx_account_balance ON account_balance(balance)",
+                              &error);
+    }
+
+    // 返回阈值 c，使 balance > c 的行约占 percent%。
+    double Threshold(std::int64_t percent) const {
+        const std::size_t n = sorted.size();
+        const std::size_t pass = n * static_cast<std::size_t>(percent) / 100;
+        return pass >= n ? sorted.front() - 1.0 : sorted[n - pass - 1];
+    }
+
+    const columnar::Float64Column& Layout(std::int64_t clustered_layout) const {
+        return clustered_layout != 0 ? clustered : natural;
+    }
+};
+
+const ZoneBenchData& GetZoneBenchData() {
+    static ZoneBenchData data;
+    return data;
+}
+
+// 参数：{是否聚簇, 选择率%}。全量 SIMD 扫描，不看 zone map。
+void BM_Filter_FullScan(benchmark::State& state) {
+    const ZoneBenchData& data = GetZoneBenchData();
+    if (!data.ok) {
+        state.SkipWithError(data.error.c_str());
+        return;
+    }
+    const columnar::Float64Column& column = data.Layout(state.range(0));
+    const double c = data.Threshold(state.range(1));
+    std::size_t matched = 0;
+    for (auto _ : state) {
+        const columnar::SelectionVector sel =
+            columnar::FilterRows<columnar::CompareOp::kGreater>(column.data(), column.size(), c);
+        matched = sel.size();
+        benchmark::DoNotOptimize(sel.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * column.size()));
+    state.counters["selectivity"] =
+        static_cast<double>(matched) / static_cast<double>(column.size());
+}
+BENCHMARK(BM_Filter_FullScan)
+    ->ArgsProduct({{0, 1}, {1, 10, 50, 90}})
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_Filter_ZoneMap(benchmark::State& state) {
+    const ZoneBenchData& data = GetZoneBenchData();
+    if (!data.ok) {
+        state.SkipWithError(data.error.c_str());
+        return;
+    }
+    const columnar::Float64Column& column = data.Layout(state.range(0));
+    const double c = data.Threshold(state.range(1));
+    const columnar::SelectionVector expected =
+        columnar::FilterRows<columnar::CompareOp::kGreater>(column.data(), column.size(), c);
+    const columnar::SelectionVector pruned = columnar::FilterRowsZoned<columnar::CompareOp::kGreater>(
+        column.data(), column.zone_map(), c);
+    if (!std::equal(expected.begin(), expected.end(), pruned.begin(), pruned.end())) {
+        state.SkipWithError("zone-map filter differs from full scan");
+        return;
+    }
+
+    columnar::ZoneScanStats stats;
+    for (auto _ : state) {
+        const columnar::SelectionVector sel =
+            columnar::FilterRowsZoned<columnar::CompareOp::kGreater>(column.data(),
+                                                                     column.zone_map(), c, &stats);
+        benchmark::DoNotOptimize(sel.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * column.size()));
+    state.counters["selectivity"] =
+        static_cast<double>(expected.size()) / static_cast<double>(column.size());
+    state.counters["zones_skipped"] = static_cast<double>(stats.skipped);
+    state.counters["zones_full"] = static_cast<double>(stats.full);
+    state.counters["zones_scanned"] = static_cast<double>(stats.scanned);
+}
+BENCHMARK(BM_Filter_ZoneMap)
+    ->ArgsProduct({{0, 1}, {1, 10, 50, 90}})
+    ->Unit(benchmark::kMicrosecond);
+
+// SQLite 对照：取出满足条件的 rowid，与列存产出选择向量的工作量对应。
+void RunSqliteFilter(benchmark::State& state, const char* sql) {
+    const ZoneBenchData& data = GetZoneBenchData();
+    if (!data.ok) {
+        state.SkipWithError(data.error.c_str());
+        return;
+    }
+    std::string error;
+    columnar::StatementHandle stmt;
+    if (!columnar::Prepare(data.db.get(), sql, &stmt, &error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    const double c = data.Threshold(state.range(0));
+    std::vector<std::int64_t> rowids;
+    for (auto _ : state) {
+        rowids.clear();
+        sqlite3_bind_double(stmt.get(), 1, c);
+        while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+            rowids.push_back(sqlite3_column_int64(stmt.get(), 0));
+        }
+        sqlite3_reset(stmt.get());
+        benchmark::DoNotOptimize(rowids.data());
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * data.natural.size()));
+    state.counters["selectivity"] =
+        static_cast<double>(rowids.size()) / static_cast<double>(data.natural.size());
+}
+
+void BM_Filter_SqliteIndex(benchmark::State& state) {
+    RunSqliteFilter(state,
+                    "SELECT rowid FROM account_balance INDEXED BY idx_account_balance "
+                    "WHERE balance > ?");
+}
+BENCHMARK(BM_Filter_SqliteIndex)->Arg(1)->Arg(10)->Arg(50)->Arg(90)->Unit(benchmark::kMicrosecond);
+
+void BM_Filter_SqliteNoIndex(benchmark::State& state) {
+    RunSqliteFilter(state, "SELECT rowid FROM account_balance NOT INDEXED WHERE balance > ?");
+}
+BENCHMARK(BM_Filter_SqliteNoIndex)->Arg(1)->Arg(10)->Arg(50)->Arg(90)->Unit(benchmark::kMicrosecond);
+
+// top-K 基准复用 zone map 的 64 倍余额列（原始行序），参数为 k。
+void BM_TopK_Parallel(benchmark::State& state) {
+    const ZoneBenchData& data = GetZoneBenchData();
+    if (!data.ok) {
+        state.SkipWithError(data.error.c_str());
+        return;
+    }
+    const auto k = static_cast<std::size_t>(state.range(0));
+    const columnar::Float64Column& column = data.natural;
+    const std::vector<columnar::TopKEntry> top = columnar::ParallelTopK<columnar::SortOrder::kDescending>(
+        column.data(), column.size(), k);
+    if (top.size() != k || top.front().value != data.sorted.back() ||
+        top.back().value != data.sorted[data.sorted.size() - k]) {
+        state.SkipWithError("top-K differs from full sort");
+        return;
+    }
+    for (auto _ : state) {
+        auto rows = columnar::ParallelTopK<columnar::SortOrder::kDescending>(column.data(),
+                                                                            column.size(), k);
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * column.size()));
+}
+BENCHMARK(BM_TopK_Parallel)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+// 对照：行号按余额全排序后取前 k，即“先 ORDER BY 再 LIMIT”。
+void BM_TopK_FullSort(benchmark::State& state) {
+    const ZoneBenchData& data = GetZoneBenchData();
+    if (!data.ok) {
+        state.SkipWithError(data.error.c_str());
+        return;
+    }
+    const auto k = static_cast<std::size_t>(state.range(0));
+    const columnar::Float64Column& column = data.natural;
+    std::vector<std::uint32_t> order(column.size());
+    std::vector<std::uint32_t> top(k);
+    for (auto _ : state) {
+        // 行号数组的重置不计时：top-K 一侧没有对应的开销。
+        state.PauseTiming();
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            order[i] = static_cast<std::uint32_t>(i);
+        }
+        state.ResumeTiming();
+        std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return column[a] > column[b];
+        });
+        std::copy(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(k), top.begin());
+        benchmark::DoNotOptimize(top.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * column.size()));
+}
+BENCHMARK(BM_TopK_FullSort)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+void BM_TopK_Sqlite(benchmark::State& state) {
+    const ZoneBenchData& data = GetZoneBenchData();
+    if (!data.ok) {
+        state.SkipWithError(data.error.c_str());
+        return;
+    }
+    std::string error;
+    columnar::StatementHandle stmt;
+    if (!columnar::Prepare(data.db.get(),
+                           "SELECT rowid, balance FROM account_balance NOT INDEXED "
+                           "ORDER BY balance DESC LIMIT ?",
+                           &stmt, &error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    std::vector<std::int64_t> rowids;
+    for (auto _ : state) {
+        rowids.clear();
+        sqlite3_bind_int64(stmt.get(), 1, state.range(0));
+        while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+            rowids.push_back(sqlite3_column_int64(stmt.get(), 0));
+        }
+        sqlite3_reset(stmt.get());
+        benchmark::DoNotOptimize(rowids.data());
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * data.natural.size()));
+}
+BENCHMARK(BM_TopK_Sqlite)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+// 当前缓存内容导出为列存表后整表重算，作为增量视图的对照答案。
+std::vector<columnar::PaymentSegmentRow> RecomputePaymentSegments(
+    const columnar::PaymentCache& cache) {
+    kvcache::CacheColumns<std::uint32_t, columnar::PaymentRecord> columns;
+    cache.ExportColumns(&columns);
+    columnar::FinaceTables tables;
+    columnar::PaymentActivityTable& pm = tables.payment_activity;
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        pm.cust_id.Append(columns.keys[i]);
+        pm.payments.Append(columns.values[i].payments);
+        pm.minimum_payments.Append(columns.values[i].minimum_payments);
+        pm.prc_full_payment.Append(columns.values[i].prc_full_payment);
+    }
+    return columnar::PaymentSegmentSummary(tables);
+}
+
+// 已装载 payment_activity 的写缓存及其视图。
+struct PaymentViewFixture {
+    columnar::PaymentCache cache;
+    columnar::PaymentSegmentView view;
+    std::vector<kvcache::FdToken::raw_type> handles;
+
+    explicit PaymentViewFixture(const columnar::PaymentActivityTable& table)
+        : cache(columnar::PaymentCache::DefaultShardCount(), table.size() * 2) {
+        columnar::LoadPaymentCache(table, &cache, &view);
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            handles.push_back(cache.FindHandle(table.cust_id[i]));
+        }
+    }
+};
+
+// 读视图：O(分组数)，与数据量无关。结果先与 SQLite 的整表聚合对照。
+void BM_View_PaymentSegment_Read(benchmark::State& state) {
+    const QueryDataset& data = GetQueryDataset();
+    std::string error;
+    sqlite3* db = SharedDb(&error);
+    if (!data.ok || db == nullptr) {
+        state.SkipWithError((data.ok ? error : data.error).c_str());
+        return;
+    }
+    PaymentViewFixture fixture(data.tables.payment_activity);
+    std::vector<columnar::PaymentSegmentRow> expected;
+    if (!columnar::SqlitePaymentSegmentSummary(db, &expected, &error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    if (!columnar::SameResult(fixture.view.Rows(), expected)) {
+        state.SkipWithError("materialized view differs from SQLite");
+        return;
+    }
+    for (auto _ : state) {
+        auto rows = fixture.view.Rows();
+        benchmark::DoNotOptimize(rows.data());
+    }
+}
+BENCHMARK(BM_View_PaymentSegment_Read)->Unit(benchmark::kNanosecond);
+
+// 随机改写单行：参数 0 为不带视图的 Update，1 为同时维护视图，差值即增量维护的开销。
+// 改写值取自其它行，会让行在分组之间迁移；结束后视图必须与整表重算一致。
+void BM_View_PaymentSegment_Update(benchmark::State& state) {
+    const QueryDataset& data = GetQueryDataset();
+    if (!data.ok) {
+        state.SkipWithError(data.error.c_str());
+        return;
+    }
+    const columnar::PaymentActivityTable& table = data.tables.payment_activity;
+    PaymentViewFixture fixture(table);
+    const bool with_view = state.range(0) != 0;
+
+    constexpr std::size_t kOps = 1u << 16;
+    std::mt19937 rng(42);
+    std::vector<std::uint32_t> targets(kOps);
+    std::vector<columnar::PaymentRecord> records(kOps);
+    for (std::size_t i = 0; i < kOps; ++i) {
+        targets[i] = static_cast<std::uint32_t>(rng() % table.size());
+        const std::size_t src = rng() % table.size();
+        records[i] = columnar::PaymentRecord{table.payments[src], table.minimum_payments[src],
+                                             table.prc_full_payment[src]};
+    }
+
+    std::size_t op = 0;
+    for (auto _ : state) {
+        const std::size_t i = op++ & (kOps - 1);
+        const bool ok = with_view
+                            ? fixture.cache.Update(fixture.handles[targets[i]], records[i],
+                                                   fixture.view)
+                            : fixture.cache.Update(fixture.handles[targets[i]], records[i]);
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    if (with_view &&
+        !columnar::SameResult(fixture.view.Rows(), RecomputePaymentSegments(fixture.cache))) {
+        state.SkipWithError("materialized view drifted from recomputation");
+    }
+}
+BENCHMARK(BM_View_PaymentSegment_Update)->Arg(0)->Arg(1)->Unit(benchmark::kNanosecond);
+
+// 写缓存通过 fdkv 虚表挂到一个独立的只读连接上（temp.hot_payments），
+// 与磁盘上的 payment_activity 同列同序，可在同一条 SQL 里互换。
+struct HotPaymentsFixture {
+    columnar::PaymentCache cache;
+    columnar::PaymentSegmentView view;
+    columnar::FdkvRegistry registry;
+    columnar::SqliteHandle db;
+    std::string error;
+    bool ok{false};
+
+    explicit HotPaymentsFixture(const QueryDataset& data)
+        : cache(columnar::PaymentCache::DefaultShardCount(),
+                data.tables.payment_activity.size() * 2) {
+        columnar::LoadPaymentCache(data.tables.payment_activity, &cache, &view);
+        registry.Register("payments",
+                          columnar::MakeFdkvSource(
+                              &cache, columnar::PaymentCacheColumns(&data.tables.cust_ids)));
+        ok = columnar::OpenFinaceReadOnly(DatabasePath(), &db, &error) &&
+             columnar::RegisterFdkvModule(db.get(), &registry, &error) &&
+             columnar::Exec(db.get(),
+                            "CREATE VIRTUAL TABLE temp.hot_payments USING fdkv(payments)",
+                            &error);
+    }
+};
+
+const HotPaymentsFixture* GetHotPayments(benchmark::State& state) {
+    const QueryDataset& data = GetQueryDataset();
+    if (!data.ok) {
+        state.SkipWithError(data.error.c_str());
+        return nullptr;
+    }
+    static HotPaymentsFixture fixture(data);
+    if (!fixture.ok) {
+        state.SkipWithError(fixture.error.c_str());
+        return nullptr;
+    }
+    return &fixture;
+}
+
+const char* PaymentsTable(std::int64_t arg) {
+    return arg == 0 ? "payment_activity" : "hot_payments";
+}
+
+// 一次点查：返回三列拼成的校验值，NULL 记为 -1。
+double LookupPayment(sqlite3_stmt* stmt, std::string_view cust_id) {
+    sqlite3_bind_text(stmt, 1, cust_id.data(), static_cast<int>(cust_id.size()), SQLITE_STATIC);
+    double sum = 0.0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        for (int c = 0; c < 3; ++c) {
+            sum += sqlite3_column_type(stmt, c) == SQLITE_NULL ? -1.0
+                                                               : sqlite3_column_double(stmt, c);
+        }
+    }
+    sqlite3_reset(stmt);
+    return sum;
+}
+
+// 按 cust_id 点查：0 = 磁盘表（主键自动索引 + rowid 表两次 B-tree 下降），
+// 1 = fdkv 虚表（字典 + 分片哈希）。两边对同一批键的结果先逐个比对。
+void BM_Vtab_PointLookup(benchmark::State& state) {
+    const HotPaymentsFixture* hot = GetHotPayments(state);
+    if (hot == nullptr) {
+        return;
+    }
+    const columnar::CustIdDictionary& dict = GetQueryDataset().tables.cust_ids;
+    std::string error;
+    columnar::StatementHandle disk;
+    columnar::StatementHandle stmt;
+    const std::string sql_tail = " WHERE cust_id = ?1";
+    if (!columnar::Prepare(hot->db.get(),
+                           "SELECT payments, minimum_payments, prc_full_payment FROM "
+                           "payment_activity" + sql_tail, &disk, &error) ||
+        !columnar::Prepare(hot->db.get(),
+                           std::string("SELECT payments, minimum_payments, prc_full_payment FROM ") +
+                               PaymentsTable(state.range(0)) + sql_tail,
+                           &stmt, &error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+
+    constexpr std::size_t kKeys = 1u << 12;
+    std::mt19937 rng(7);
+    std::vector<std::uint32_t> keys(kKeys);
+    for (std::uint32_t& k : keys) {
+        k = static_cast<std::uint32_t>(rng() % dict.size());
+        if (LookupPayment(disk.get(), dict.Decode(k)) != LookupPayment(stmt.get(), dict.Decode(k))) {
+            state.SkipWithError("fdkv lookup differs from payment_activity");
+            return;
+        }
+    }
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(LookupPayment(stmt.get(), dict.Decode(keys[i++ & (kKeys - 1)])));
+    }
+    state.SetLabel(PaymentsTable(state.range(0)));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Vtab_PointLookup)->Arg(0)->Arg(1)->Unit(benchmark::kNanosecond);
+
+// notebook 的 join_query，payment_activity 换成内存中的 hot_payments 后结果必须不变。
+// 0 = 磁盘表；1 = hot_payments，由规划器定序；2 = hot_payments，用 CROSS JOIN
+// 固定为磁盘表的计划顺序（a 走 balance 索引，c、p 按 cust_id 点查）。
+// 库里没有 sqlite_stat1 时规划器把磁盘表按约 100 万行估算，而虚表报告真实行数，
+// 于是 1 会选择先全扫虚表再逐行回查磁盘表。
+void BM_Vtab_Join(benchmark::State& state) {
+    const HotPaymentsFixture* hot = GetHotPayments(state);
+    if (hot == nullptr) {
+        return;
+    }
+    const auto join_sql = [](const char* payments, bool pinned) {
+        const std::string from =
+            pinned ? std::string("account_summary a CROSS JOIN customers c ON c.cust_id = a.cust_id "
+                                 "CROSS JOIN ") +
+                         payments + " p ON p.cust_id = a.cust_id "
+                   : std::string("customers c JOIN account_summary a USING (cust_id) JOIN ") +
+                         payments + " p USING (cust_id) ";
+        return "SELECT c.cust_id, a.balance, p.payments FROM " + from +
+               "WHERE a.balance > 5000 AND p.payments > 2000 ORDER BY c.cust_id";
+    };
+    const auto run = [&](sqlite3_stmt* stmt) {
+        std::vector<std::string> rows;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            rows.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+            rows.back() += "|" + std::to_string(sqlite3_column_double(stmt, 1)) + "|" +
+                           std::to_string(sqlite3_column_double(stmt, 2));
+        }
+        sqlite3_reset(stmt);
+        return rows;
+    };
+    std::string error;
+    columnar::StatementHandle disk;
+    columnar::StatementHandle stmt;
+    if (!columnar::Prepare(hot->db.get(), join_sql("payment_activity", false), &disk, &error) ||
+        !columnar::Prepare(hot->db.get(),
+                           join_sql(PaymentsTable(state.range(0)), state.range(0) == 2), &stmt,
+                           &error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    const std::vector<std::string> expected = run(disk.get());
+    if (run(stmt.get()) != expected) {
+        state.SkipWithError("join over fdkv differs from payment_activity");
+        return;
+    }
+    for (auto _ : state) {
+        std::size_t rows = 0;
+        while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+            ++rows;
+        }
+        sqlite3_reset(stmt.get());
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetLabel(state.range(0) == 2 ? "hot_payments, pinned order" : PaymentsTable(state.range(0)));
+}
+BENCHMARK(BM_Vtab_Join)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMicrosecond);
+
+// CDC 实验用的可写副本：finace.db 拷进 :memory:，payment_activity 装入写缓存，
+// 视图挂在缓存写路径上，失效器按 kRefresh 回源刷新。
+struct CdcFixture {
+    columnar::SqliteHandle db;
+    columnar::FinaceTables tables;
+    columnar::PaymentCache cache;
+    columnar::PaymentSegmentView view;
+    std::vector<sqlite3_int64> rowids;
+    std::string error;
+    bool ok{false};
+
+    CdcFixture() : cache(columnar::PaymentCache::DefaultShardCount(), 1u << 15) {
+        columnar::SqliteHandle src;
+        ok = columnar::OpenFinaceReadOnly(DatabasePath(), &src, &error) &&
+             columnar::OpenDatabase(":memory:", SQLITE_OPEN_READWRITE, &db, &error) &&
+             columnar::CopyDatabase(src.get(), db.get(), &error) &&
+             columnar::LoadFinaceTables(db.get(), &tables, &error) &&
+             columnar::detail::StreamRows(
+                 db.get(), "SELECT rowid FROM payment_activity",
+                 [&](sqlite3_stmt* stmt) { rowids.push_back(sqlite3_column_int64(stmt, 0)); },
+                 &error);
+        if (ok) {
+            columnar::LoadPaymentCache(tables.payment_activity, &cache, &view);
+        }
+    }
+
+    // 缓存中与源表取值不同（或缺失）的行数。
+    std::size_t StaleRows() {
+        std::size_t stale = 0;
+        columnar::detail::StreamRows(
+            db.get(), "SELECT cust_id, payments, minimum_payments, prc_full_payment "
+                      "FROM payment_activity",
+            [&](sqlite3_stmt* stmt) {
+                const std::uint32_t key = columnar::detail::ReadCustId(stmt, 0, &tables.cust_ids);
+                columnar::PaymentRecord cached;
+                const double p = columnar::detail::ReadFloat64(stmt, 1);
+                const double m = columnar::detail::ReadFloat64(stmt, 2);
+                const double f = columnar::detail::ReadFloat64(stmt, 3);
+                const auto same = [](double x, double y) {
+                    return x == y || (columnar::IsNull(x) && columnar::IsNull(y));
+                };
+                stale += !cache.Get(cache.FindHandle(key), &cached) ||
+                                 !same(cached.payments, p) || !same(cached.minimum_payments, m) ||
+                                 !same(cached.prc_full_payment, f)
+                             ? 1
+                             : 0;
+            },
+            &error);
+        return stale;
+    }
+};
+
+// 每轮一个事务随机改写 64 行 payment_activity，然后把变更同步到缓存：
+// 0 = 不同步（对照，TTL 之前缓存一直是旧值）；1 = update hook + commit hook；
+// 2 = 触发器写 changelog，事后拉取并清理。结束时报告缓存中的过期行数，
+// 1/2 必须为 0，且增量视图要与 SQLite 上的整表聚合一致。
+void BM_Cdc_Invalidate(benchmark::State& state) {
+    const std::int64_t mode = state.range(0);
+    CdcFixture fx;
+    if (!fx.ok) {
+        state.SkipWithError(fx.error.c_str());
+        return;
+    }
+    const std::vector<std::string> watched{"payment_activity"};
+    columnar::PaymentRowLoader loader(fx.db.get(), &fx.tables.cust_ids, &fx.error);
+    auto invalidator = columnar::MakeCacheInvalidator(&fx.cache, 0,
+                                                      columnar::InvalidatePolicy::kRefresh,
+                                                      std::move(loader));
+    invalidator.Reserve(fx.rowids.size());
+    std::unique_ptr<columnar::ChangeCapture> capture;
+    if (mode == 1) {
+        capture = std::make_unique<columnar::ChangeCapture>(fx.db.get(), watched);
+    }
+    columnar::StatementHandle update;
+    if (!columnar::TrackPaymentRows(fx.db.get(), fx.tables.cust_ids, fx.cache, &invalidator,
+                                    &fx.error) ||
+        (mode == 2 && !columnar::InstallChangelog(fx.db.get(), watched, &fx.error)) ||
+        !columnar::Prepare(fx.db.get(),
+                           "UPDATE payment_activity SET payments = ?1, minimum_payments = ?2 "
+                           "WHERE rowid = ?3",
+                           &update, &fx.error)) {
+        state.SkipWithError(fx.error.c_str());
+        return;
+    }
+
+    constexpr std::size_t kRowsPerTxn = 64;
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> amount(0.0, 5000.0);
+    std::vector<columnar::RowChange> changes;
+    sqlite3_int64 last_seq = 0;
+    std::size_t applied = 0;
+    for (auto _ : state) {
+        columnar::Exec(fx.db.get(), "BEGIN");
+        for (std::size_t i = 0; i < kRowsPerTxn; ++i) {
+            sqlite3_bind_double(update.get(), 1, amount(rng));
+            if (rng() % 10 == 0) {
+                sqlite3_bind_null(update.get(), 2);
+            } else {
+                sqlite3_bind_double(update.get(), 2, amount(rng));
+            }
+            sqlite3_bind_int64(update.get(), 3, fx.rowids[rng() % fx.rowids.size()]);
+            sqlite3_step(update.get());
+            sqlite3_reset(update.get());
+        }
+        columnar::Exec(fx.db.get(), "COMMIT");
+
+        changes.clear();
+        if (mode == 1) {
+            capture->Drain(&changes);
+        } else if (mode == 2) {
+            columnar::PollChangelog(fx.db.get(), watched, &last_seq, 1u << 20, &changes);
+            columnar::TrimChangelog(fx.db.get(), last_seq);
+        }
+        if (mode != 0) {
+            const auto stats = invalidator.Apply(&changes, fx.view);
+            applied += stats.refreshed + stats.inserted + stats.erased;
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kRowsPerTxn));
+    state.counters["stale_rows"] = static_cast<double>(fx.StaleRows());
+    state.counters["applied"] = static_cast<double>(applied);
+    state.SetLabel(mode == 0 ? "no sync" : (mode == 1 ? "update hook" : "changelog"));
+    if (mode != 0) {
+        std::vector<columnar::PaymentSegmentRow> expected;
+        if (state.counters["stale_rows"] != 0.0 ||
+            !columnar::SqlitePaymentSegmentSummary(fx.db.get(), &expected, &fx.error) ||
+            !columnar::SameResult(fx.view.Rows(), expected)) {
+            state.SkipWithError("cache or view out of sync after CDC");
+        }
+    }
+}
+BENCHMARK(BM_Cdc_Invalidate)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
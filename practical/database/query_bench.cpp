@@ -0,0 +1,355 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "finace_loader.h"
+#include "finace_queries.h"
+#include "finace_sqlite_writer.h"
+#include "finace_tables.h"
+#include "mapped_file.h"
+#include "sqlite_util.h"
+
+// notebook 各查询分别经 SQLite（C API）与原生列存算子执行的对照基准。
+// 参数：scale = 数据复制倍数，query = kQueries 下标，engine = 0 SQLite / 1 原生。
+// label 给出查询名与执行计划：SQLite 为 EXPLAIN QUERY PLAN 的 detail 列，原生为算子链。
+// 结果只在 1x 上与 SQLite 逐行对照（放大后 ORDER BY ... LIMIT 的并列行不定序）。
+namespace {
+
+// 默认读取 notebook 生成的 .db/finace.db；可用环境变量 FINACE_DB 覆盖。
+std::string DatabasePath() {
+    const char* env = std::getenv("FINACE_DB");
+    return env != nullptr ? std::string(env) : std::string(FINACE_DB_PATH);
+}
+
+// 放大后的 SQLite 库默认生成在 /tmp，可用环境变量 FINACE_QUERY_DIR 指定目录。
+std::string ScaledDatabasePath(std::size_t scale) {
+    const char* dir = std::getenv("FINACE_QUERY_DIR");
+    return std::string(dir != nullptr ? dir : "/tmp") + "/finace_query_x" +
+           std::to_string(scale) + ".db";
+}
+
+enum Query : std::int64_t {
+    kFilterNoIndex,
+    kFilterIndex,
+    kJoinFilter,
+    kTopBalances,
+    kPurchaseBand,
+    kPaymentSegment,
+    kAboveAverageCredit,
+    kQueryCount,
+};
+
+struct QueryInfo {
+    const char* name;
+    const char* sql;
+    const char* native_plan;
+};
+
+constexpr QueryInfo kQueries[kQueryCount] = {
+    {"filter_without_index", columnar::kBalanceFilterNoIndexSql,
+     "SIMD full-column compare -> gather"},
+    {"filter_with_index", columnar::kBalanceFilterSql,
+     "zone-map pruned compare -> gather"},
+    {"join_query", columnar::kJoinFilterSql,
+     "zoned filter(a) + zoned filter(p) -> radix join p -> radix join c"},
+    {"top_balances", columnar::kTopBalancesSql,
+     "zoned filter(a) -> radix join c, p, pa -> parallel top-K"},
+    {"purchase_band", columnar::kPurchaseBandSql,
+     "dense-id join -> CASE bands -> thread-local hash agg"},
+    {"payment_segment", columnar::kPaymentSegmentSql,
+     "single scan -> CASE segments -> thread-local hash agg"},
+    {"above_average_credit", columnar::kAboveAverageCreditSql,
+     "2x AVG -> zoned filters -> radix join -> parallel top-K"},
+};
+
+// 每个查询读取的输入行数（所涉及各表行数之和），作为 items_per_second 的分子。
+std::size_t InputRows(Query q, const columnar::FinaceTables& t) {
+    const std::size_t c = t.customers.size();
+    const std::size_t a = t.account_summary.size();
+    const std::size_t pa = t.purchase_activity.size();
+    const std::size_t pm = t.payment_activity.size();
+    switch (q) {
+        case kFilterNoIndex:
+        case kFilterIndex:
+            return a;
+        case kJoinFilter:
+            return c + a + pm;
+        case kTopBalances:
+            return c + a + pm + pa;
+        case kPurchaseBand:
+            return pa + pm;
+        case kPaymentSegment:
+            return pm;
+        default:
+            return a + pm;
+    }
+}
+
+// 第 r 份副本的 cust_id 取原串加 "_r<r>" 后缀，按 r * ids + i 的顺序编码，
+// 与 ReplicateTables 平移后的 dense id 一一对应，写入 SQLite 后主键仍唯一。
+columnar::FinaceTables ScaleTables(const columnar::FinaceTables& src, std::size_t scale) {
+    columnar::FinaceTables out = columnar::ReplicateTables(src, scale);
+    const std::size_t ids = src.cust_ids.size();
+    out.cust_ids.Reserve(ids * scale);
+    for (std::size_t r = 1; r < scale; ++r) {
+        const std::string suffix = "_r" + std::to_string(r);
+        for (std::size_t i = 0; i < ids; ++i) {
+            std::string id(src.cust_ids.Decode(static_cast<std::uint32_t>(i)));
+            out.cust_ids.Encode(id + suffix);
+        }
+    }
+    return out;
+}
+
+// 同一 scale 的列存表与 SQLite 库。同一时刻只保留一份，换 scale 时先释放旧的。
+struct ScaledDataset {
+    std::size_t scale{0};
+    columnar::FinaceTables tables;
+    columnar::SqliteHandle db;
+    std::string error;
+    bool ok{false};
+
+    explicit ScaledDataset(std::size_t s) : scale(s) {
+        columnar::FinaceTables base;
+        if (!columnar::LoadFinaceTables(DatabasePath(), &base, &error)) {
+            return;
+        }
+        if (scale <= 1) {
+            tables = std::move(base);
+            ok = columnar::OpenFinaceReadOnly(DatabasePath(), &db, &error);
+            return;
+        }
+        tables = ScaleTables(base, scale);
+        const std::string path = ScaledDatabasePath(scale);
+        columnar::MappedFile existing;
+        if (!existing.Open(path, false) || existing.size() == 0) {
+            // 先写临时文件再 rename：中途失败不会留下半个库被下次直接复用。
+            // 回滚日志模式，生成后只有一个库文件，只读连接无需 -wal/-shm。
+            const std::string tmp = path + ".tmp";
+            std::remove(tmp.c_str());
+            columnar::SqliteBulkOptions options;
+            options.wal = false;
+            options.synchronous = "OFF";
+            if (!columnar::BulkLoadFinace(tmp, tables, options, &error)) {
+                std::remove(tmp.c_str());
+                return;
+            }
+            if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+                error = "rename " + tmp + " failed";
+                return;
+            }
+        }
+        ok = columnar::OpenFinaceReadOnly(path, &db, &error);
+    }
+};
+
+const ScaledDataset& GetScaled(std::size_t scale) {
+    static std::unique_ptr<ScaledDataset> cached;
+    if (cached == nullptr || cached->scale != scale) {
+        cached.reset();
+        cached = std::make_unique<ScaledDataset>(scale);
+    }
+    return *cached;
+}
+
+// EXPLAIN QUERY PLAN 的 detail 列，按行用 " | " 连接。
+std::string QueryPlan(sqlite3* db, const char* sql) {
+    std::string plan;
+    std::string error;
+    columnar::detail::StreamRows(
+        db, std::string("EXPLAIN QUERY PLAN ") + sql,
+        [&](sqlite3_stmt* stmt) {
+            plan += plan.empty() ? "" : " | ";
+            plan += columnar::detail::ReadText(stmt, 3);
+        },
+        &error);
+    return plan.empty() ? error : plan;
+}
+
+// 执行一次查询，返回结果行数；失败时返回 false。
+bool RunNative(Query q, const columnar::FinaceTables& t, std::size_t* rows) {
+    switch (q) {
+        case kFilterNoIndex:
+            *rows = columnar::BalanceFilter(t, false).size();
+            break;
+        case kFilterIndex:
+            *rows = columnar::BalanceFilter(t, true).size();
+            break;
+        case kJoinFilter:
+            *rows = columnar::JoinFilter(t).size();
+            break;
+        case kTopBalances:
+            *rows = columnar::TopBalances(t).size();
+            break;
+        case kPurchaseBand:
+            *rows = columnar::PurchaseBandSummary(t).size();
+            break;
+        case kPaymentSegment:
+            *rows = columnar::PaymentSegmentSummary(t).size();
+            break;
+        default:
+            *rows = columnar::AboveAverageCredit(t).size();
+            break;
+    }
+    return true;
+}
+
+template <typename Row, typename SqliteFn>
+bool RunSqliteRows(SqliteFn&& fn, std::size_t* rows, std::string* error) {
+    std::vector<Row> out;
+    const bool ok = fn(&out, error);
+    *rows = out.size();
+    return ok;
+}
+
+bool RunSqlite(Query q, sqlite3* db, std::size_t* rows, std::string* error) {
+    switch (q) {
+        case kFilterNoIndex:
+        case kFilterIndex:
+            return RunSqliteRows<columnar::BalanceFilterRow>(
+                [&](auto* out, std::string* e) {
+                    return columnar::SqliteBalanceFilter(db, q == kFilterIndex, out, e);
+                },
+                rows, error);
+        case kJoinFilter:
+            return RunSqliteRows<columnar::JoinFilterRow>(
+                [&](auto* out, std::string* e) { return columnar::SqliteJoinFilter(db, out, e); },
+                rows, error);
+        case kTopBalances:
+            return RunSqliteRows<columnar::TopBalanceRow>(
+                [&](auto* out, std::string* e) { return columnar::SqliteTopBalances(db, out, e); },
+                rows, error);
+        case kPurchaseBand:
+            return RunSqliteRows<columnar::PurchaseBandRow>(
+                [&](auto* out, std::string* e) {
+                    return columnar::SqlitePurchaseBandSummary(db, out, e);
+                },
+                rows, error);
+        case kPaymentSegment:
+            return RunSqliteRows<columnar::PaymentSegmentRow>(
+                [&](auto* out, std::string* e) {
+                    return columnar::SqlitePaymentSegmentSummary(db, out, e);
+                },
+                rows, error);
+        default:
+            return RunSqliteRows<columnar::AboveAverageCreditRow>(
+                [&](auto* out, std::string* e) {
+                    return columnar::SqliteAboveAverageCredit(db, out, e);
+                },
+                rows, error);
+    }
+}
+
+template <typename Row, typename SqliteFn>
+bool SameAsSqlite(const std::vector<Row>& native, SqliteFn&& sqlite, std::string* error) {
+    std::vector<Row> expected;
+    if (!sqlite(&expected, error)) {
+        return false;
+    }
+    if (!columnar::SameResult(native, expected)) {
+        *error = "native result differs from SQLite";
+        return false;
+    }
+    return true;
+}
+
+bool Verify(Query q, const columnar::FinaceTables& t, sqlite3* db, std::string* error) {
+    switch (q) {
+        case kFilterNoIndex:
+        case kFilterIndex:
+            return SameAsSqlite(
+                columnar::BalanceFilter(t, q == kFilterIndex),
+                [&](auto* out, std::string* e) {
+                    return columnar::SqliteBalanceFilter(db, q == kFilterIndex, out, e);
+                },
+                error);
+        case kJoinFilter:
+            return SameAsSqlite(
+                columnar::JoinFilter(t),
+                [&](auto* out, std::string* e) { return columnar::SqliteJoinFilter(db, out, e); },
+                error);
+        case kTopBalances:
+            return SameAsSqlite(
+                columnar::TopBalances(t),
+                [&](auto* out, std::string* e) { return columnar::SqliteTopBalances(db, out, e); },
+                error);
+        case kPurchaseBand:
+            return SameAsSqlite(
+                columnar::PurchaseBandSummary(t),
+                [&](auto* out, std::string* e) {
+                    return columnar::SqlitePurchaseBandSummary(db, out, e);
+                },
+                error);
+        case kPaymentSegment:
+            return SameAsSqlite(
+                columnar::PaymentSegmentSummary(t),
+                [&](auto* out, std::string* e) {
+                    return columnar::SqlitePaymentSegmentSummary(db, out, e);
+                },
+                error);
+        default:
+            return SameAsSqlite(
+                columnar::AboveAverageCredit(t),
+                [&](auto* out, std::string* e) {
+                    return columnar::SqliteAboveAverageCredit(db, out, e);
+                },
+                error);
+    }
+}
+
+void BM_Query(benchmark::State& state) {
+    const auto scale = static_cast<std::size_t>(state.range(0));
+    const auto query = static_cast<Query>(state.range(1));
+    const bool native = state.range(2) != 0;
+    const ScaledDataset& data = GetScaled(scale);
+    std::string error;
+    if (!data.ok) {
+        state.SkipWithError(data.error.c_str());
+        return;
+    }
+    if (scale == 1 && !Verify(query, data.tables, data.db.get(), &error)) {
+        state.SkipWithError((std::string(kQueries[query].name) + ": " + error).c_str());
+        return;
+    }
+
+    std::size_t rows = 0;
+    for (auto _ : state) {
+        const bool ok = native ? RunNative(query, data.tables, &rows)
+                               : RunSqlite(query, data.db.get(), &rows, &error);
+        if (!ok) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(rows);
+    }
+    const std::size_t input = InputRows(query, data.tables);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * input));
+    state.counters["input_rows"] = static_cast<double>(input);
+    state.counters["result_rows"] = static_cast<double>(rows);
+    state.SetLabel(std::string(kQueries[query].name) + (native ? " native: " : " sqlite: ") +
+                   (native ? std::string(kQueries[query].native_plan)
+                           : QueryPlan(data.db.get(), kQueries[query].sql)));
+}
+// 逐条 Args 注册并让 scale 在最外层循环：同一 scale 的全部查询连续运行，数据集只构建一次。
+// ArgsProduct 按第一维变化最快展开，会让每个实例都重建一次数据集。
+void QueryArgs(benchmark::internal::Benchmark* b) {
+    for (std::int64_t scale : {1, 10, 100, 1000}) {
+        for (std::int64_t query = 0; query < static_cast<std::int64_t>(kQueryCount); ++query) {
+            for (std::int64_t native : {0, 1}) {
+                b->Args({scale, query, native});
+            }
+        }
+    }
+    b->ArgNames({"scale", "query", "native"});
+}
+BENCHMARK(BM_Query)->Apply(QueryArgs)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();